@@ -23,6 +23,9 @@
 /* USER CODE BEGIN Includes */
 #include <stdio.h>
 #include "myEncoder/proximity_counter.h"
+#include "myEncoder/pulse_totalizer.h"
+#include "myEncoder/myEncoder.h"
+#include "timebase/timebase.h"
 #include "queue/queue.h"
 #include "modbus/modbus.h"
 #include <stdlib.h>
@@ -49,6 +52,7 @@ CommandHandler_t cmdh;
 // Chọn chế độ hoạt động
 // #define MODBUS_MASTER
 #define MODBUS_SLAVE
+// #define PROXIMITY_CH1_DMA   // CH1 captures through the DMA ring instead of one interrupt per edge
 uint32_t PPR = 1;
 float DIA = 0.25f;
 uint32_t TIME = 100;
@@ -57,7 +61,11 @@ int64_t pulse_t = 0;
 float current_speed=0;
 ////////////////////// Dùng cái này nếu stm32 là MODBUS SLAVE /////////////
 #define SLAVE_ID 0x01
-uint16_t holding_regs[10];
+uint16_t holding_regs[108];
+#define INPUT_REG_HISTORY 40U  // First register of the speed history tiers
+#define INPUT_REG_ENCODERS (INPUT_REG_HISTORY + RPM_HISTORY_WORDS)  // Quadrature encoder blocks, one per timer
+#define INPUT_REG_COUNT (INPUT_REG_ENCODERS + ENCODER_TIMER_COUNT * ENCODER_REG_BLOCK)
+uint16_t input_regs[INPUT_REG_COUNT];  // Statistics 0..29, history 30..879, encoders 880..911
 volatile uint32_t encoder_pulses = 0;
 volatile uint32_t distance_mm = 0;
 int32_t len_val;
@@ -87,12 +95,14 @@ uint32_t c_uart = 0;
 IWDG_HandleTypeDef hiwdg;
 
 TIM_HandleTypeDef htim2;
+TIM_HandleTypeDef htim3;
 TIM_HandleTypeDef htim4;
 
 UART_HandleTypeDef huart1;
 UART_HandleTypeDef huart3;
 DMA_HandleTypeDef hdma_usart3_rx;
 DMA_HandleTypeDef hdma_usart3_tx;
+DMA_HandleTypeDef hdma_tim2_ch1;
 
 /* USER CODE BEGIN PV */
 // ------------------- Printf --------------------------
@@ -135,6 +145,9 @@ static void MX_IWDG_Init(void);
 
 // Proximity counter instance
 ProximityCounter_t proximity_counter;
+#ifdef PROXIMITY_CH1_DMA
+static ProximityDmaRing_t proximity_dma_ring;  // CH1 DMA capture ring
+#endif
 
 // Command interface functions for proximity counter
 void SetProximitySpeedUnit(int unit) {
@@ -241,6 +254,751 @@ void LoadProximityHysteresis(void) {
 
 }
 
+// RPM filter chain shared by every proximity channel (console "filter" / Modbus 7..9)
+static RpmFilterChain_t proximity_filter_chain = RPM_FILTER_CHAIN_HYSTERESIS;
+static uint16_t proximity_filter_alpha = RPM_FILTER_DEFAULT_ALPHA_Q8;
+static uint32_t proximity_filter_slew = RPM_FILTER_DEFAULT_SLEW_RPM;
+static uint8_t proximity_tracker_on = 0;
+static uint16_t proximity_tracker_alpha = RPM_TRACKER_DEFAULT_ALPHA_Q8;
+static uint16_t proximity_tracker_beta = RPM_TRACKER_DEFAULT_BETA_Q8;
+// Capture settings of every proximity channel (console "filter method|gate|accel|irq" / Modbus 105..107, 13)
+static myCaptureConfig proximity_capture_config = { 0U, PROXIMITY_MT_DEFAULT_GATE_MS, 0U, 0U };
+
+static uint8_t proximity_direction_on = 0; // CH2 carries the CH1 direction sensor
+static myPulseConfig proximity_pulse_config;  // CH2 captures the CH1 falling edge
+
+// Extra proximity channels on TIM2 CH2..CH4, configured from Flash
+ProximityCounter_t proximity_channels[MYFLASH_AUX_CHANNELS];
+static myChannelTable proximity_channel_table;
+static const uint32_t proximity_channel_ids[MYFLASH_AUX_CHANNELS] = {
+    TIM_CHANNEL_2, TIM_CHANNEL_3, TIM_CHANNEL_4
+};
+
+static void ApplyProximityChannel(int index) {
+    ProximityCounter_t *pc = &proximity_channels[index];
+    const myChannelParams *p = &proximity_channel_table.channels[index];
+
+    if (!p->enabled) {
+        // Free the pin for the direction sensor / pulse width of CH1
+        ProximityCounter_DeInit(pc);
+        pc->rpm = 0.0f;
+        return;
+    }
+    if (pc->running) {
+        ProximityCounter_Stop(pc);
+    }
+    ProximityCounterConfig_t cfg = {
+        .ppr = p->pulsesPerRev,
+        .diameter = (float)p->diameter / 1000.0f,
+        .timeout_ms = p->timeout,
+        .averaging_samples = 3,
+        .capture_mode = PROXIMITY_CAPTURE_MODE_IT,
+        .method = (ProximityMethod_t)proximity_capture_config.method,
+        .gate_ms = proximity_capture_config.gateMs,
+        .channel = proximity_channel_ids[index],
+        .filter_chain = proximity_filter_chain,
+        .max_accel = proximity_capture_config.maxAccel,
+        .max_irq_hz = proximity_capture_config.maxIrqHz
+    };
+    ProximityCounter_Init(pc, &cfg, &htim2);
+    ProximityCounter_SetFilterParams(pc, proximity_filter_alpha, proximity_filter_slew);
+    ProximityCounter_SetTracker(pc, proximity_tracker_on, proximity_tracker_alpha, proximity_tracker_beta);
+    ProximityCounter_Start(pc);
+}
+
+void LoadProximityCapture(void) {
+    myFlash_LoadCaptureConfig(&proximity_capture_config);
+    ProximityCounter_SetMethod(&proximity_counter, (ProximityMethod_t)proximity_capture_config.method,
+                               proximity_capture_config.gateMs);
+    ProximityCounter_SetMaxAccel(&proximity_counter, proximity_capture_config.maxAccel);
+    ProximityCounter_SetIrqCeiling(&proximity_counter, proximity_capture_config.maxIrqHz);
+}
+
+void LoadProximityChannels(void) {
+    myFlash_LoadChannelTable(&proximity_channel_table);
+    for (int i = 0; i < (int)MYFLASH_AUX_CHANNELS; i++) {
+        ApplyProximityChannel(i);
+    }
+}
+
+void ShowProximityChannels(void) {
+    printf("=== PROXIMITY CHANNELS ===\r\n");
+    printf("CH | State | PPR  | DIA(mm) | Timeout | RPM\r\n");
+    printf("1  |  ON   | %4lu | %7lu | %7lu | %.1f\r\n", (unsigned long)PPR,
+           (unsigned long)(DIA * 1000), (unsigned long)TIMEOUT,
+           (double)ProximityCounter_GetRPM(&proximity_counter));
+    for (int i = 0; i < (int)MYFLASH_AUX_CHANNELS; i++) {
+        const myChannelParams *p = &proximity_channel_table.channels[i];
+        printf("%d  |  %s  | %4lu | %7lu | %7lu | %.1f\r\n", i + 2, p->enabled ? "ON " : "OFF",
+               (unsigned long)p->pulsesPerRev, (unsigned long)p->diameter,
+               (unsigned long)p->timeout, (double)ProximityCounter_GetRPM(&proximity_channels[i]));
+    }
+    printf("💡 Use: ch <2-4> on|off|ppr <n>|dia <mm>|timeout <ms>\r\n");
+}
+
+bool SetProximityChannel(int channel, const char *param, uint32_t value) {
+    if (channel < 2 || channel > 1 + (int)MYFLASH_AUX_CHANNELS) {
+        return false;
+    }
+    myChannelParams *p = &proximity_channel_table.channels[channel - 2];
+
+    if (strcmp(param, "on") == 0) {
+        if (channel == 2 && (proximity_direction_on || proximity_pulse_config.mode)) {
+            return false; // CH2 is the CH1 direction sensor or falling-edge capture
+        }
+        p->enabled = 1U;
+    } else if (strcmp(param, "off") == 0) {
+        p->enabled = 0U;
+    } else if (strcmp(param, "ppr") == 0 && value > 0U && value <= 10000U) {
+        p->pulsesPerRev = value;
+    } else if (strcmp(param, "dia") == 0 && value > 0U && value <= 100000U) {
+        p->diameter = value;
+    } else if (strcmp(param, "timeout") == 0 && value >= 1000U && value <= 60000U) {
+        p->timeout = value;
+    } else {
+        return false;
+    }
+    ApplyProximityChannel(channel - 2);
+    return myFlash_SaveChannelTable(&proximity_channel_table) == HAL_OK;
+}
+
+void ShowProximityFilter(void) {
+    printf("=== RPM FILTER ===\r\n");
+    for (int i = 0; i < (int)RPM_FILTER_CHAIN_COUNT; i++) {
+        printf("  %d %s %s\r\n", i, RpmFilter_ChainName((RpmFilterChain_t)i),
+               i == (int)proximity_filter_chain ? "<" : "");
+    }
+    printf("EMA alpha=%u/256 SLEW=%lu RPM/sample\r\n", proximity_filter_alpha,
+           (unsigned long)proximity_filter_slew);
+    printf("TRACKER %s alpha=%u/256 beta=%u/256 ACC=%.1f RPM/s VAR=%.1f\r\n",
+           proximity_tracker_on ? "ON" : "OFF", proximity_tracker_alpha, proximity_tracker_beta,
+           (double)ProximityCounter_GetAcceleration(&proximity_counter),
+           (double)ProximityCounter_GetSpeedVariance(&proximity_counter));
+    printf("💡 Use: filter <0-%d> | filter alpha <1-256> | filter slew <rpm>\r\n",
+           (int)RPM_FILTER_CHAIN_COUNT - 1);
+    printf("GLITCH max accel=%lu RPM/s, rejected %lu/%lu edges (%.2f%%)\r\n",
+           (unsigned long)proximity_capture_config.maxAccel, (unsigned long)proximity_counter.glitch_rejects,
+           (unsigned long)proximity_counter.glitch_edges,
+           (double)(ProximityCounter_GetRejectRatio(&proximity_counter) * 100.0f));
+    printf("💡 Use: filter tracker 0|1 | filter talpha <1-256> | filter tbeta <0-256>\r\n");
+    printf("💡 Use: filter accel <rpm/s> (0 = accept every edge, saved to Flash)\r\n");
+    printf("INPUT ceiling=%lu captures/s, CH1 ICPSC=/%lu ICF=%u rate=%.0f/s\r\n",
+           (unsigned long)proximity_capture_config.maxIrqHz,
+           (unsigned long)ProximityCounter_GetEdgeDivider(&proximity_counter),
+           proximity_counter.ic_filter, (double)ProximityCounter_GetCaptureRate(&proximity_counter));
+    printf("💡 Use: filter irq <hz> (0 = capture every edge, saved to Flash)\r\n");
+    printf("METHOD %s gate=%lu ms\r\n", proximity_capture_config.method ? "M/T" : "T",
+           (unsigned long)proximity_capture_config.gateMs);
+    printf("💡 Use: filter method 0|1 (0 = T per period, 1 = M/T gate) | filter gate <10-10000 ms>\r\n");
+}
+
+bool SetProximityFilterChain(int chain) {
+    if (chain < 0 || chain >= (int)RPM_FILTER_CHAIN_COUNT) {
+        return false;
+    }
+    proximity_filter_chain = (RpmFilterChain_t)chain;
+    ProximityCounter_SetFilterChain(&proximity_counter, proximity_filter_chain);
+    for (int i = 0; i < (int)MYFLASH_AUX_CHANNELS; i++) {
+        ProximityCounter_SetFilterChain(&proximity_channels[i], proximity_filter_chain);
+    }
+    return true;
+}
+
+bool SetProximityFilterParam(const char *param, uint32_t value) {
+    uint16_t alpha = proximity_filter_alpha;
+    uint32_t slew = proximity_filter_slew;
+    uint8_t tracker_on = proximity_tracker_on;
+    uint16_t tracker_alpha = proximity_tracker_alpha;
+    uint16_t tracker_beta = proximity_tracker_beta;
+
+    if (strcmp(param, "accel") == 0) {
+        proximity_capture_config.maxAccel = value;
+        ProximityCounter_SetMaxAccel(&proximity_counter, value);
+        for (int i = 0; i < (int)MYFLASH_AUX_CHANNELS; i++) {
+            ProximityCounter_SetMaxAccel(&proximity_channels[i], value);
+        }
+        return myFlash_SaveCaptureConfig(&proximity_capture_config) == HAL_OK;
+    }
+    if (strcmp(param, "irq") == 0) {
+        proximity_capture_config.maxIrqHz = value;
+        ProximityCounter_SetIrqCeiling(&proximity_counter, value);
+        for (int i = 0; i < (int)MYFLASH_AUX_CHANNELS; i++) {
+            ProximityCounter_SetIrqCeiling(&proximity_channels[i], value);
+        }
+        return myFlash_SaveCaptureConfig(&proximity_capture_config) == HAL_OK;
+    }
+    if (strcmp(param, "method") == 0 || strcmp(param, "gate") == 0) {
+        myCaptureConfig cfg = proximity_capture_config;
+        if (strcmp(param, "method") == 0 && value <= 1U) {
+            cfg.method = value;
+        } else if (strcmp(param, "gate") == 0 && value >= 10U && value <= 10000U) {
+            cfg.gateMs = value;
+        } else {
+            return false;
+        }
+        proximity_capture_config = cfg;
+        // A tooth table keeps CH1 on single periods until it is switched off
+        if (ProximityCounter_GetToothState(&proximity_counter) == PROXIMITY_TOOTH_OFF) {
+            ProximityCounter_SetMethod(&proximity_counter, (ProximityMethod_t)cfg.method, cfg.gateMs);
+        }
+        for (int i = 0; i < (int)MYFLASH_AUX_CHANNELS; i++) {
+            ProximityCounter_SetMethod(&proximity_channels[i], (ProximityMethod_t)cfg.method, cfg.gateMs);
+        }
+        return myFlash_SaveCaptureConfig(&proximity_capture_config) == HAL_OK;
+    }
+    if (strcmp(param, "alpha") == 0 && value <= 0xFFFFU) {
+        alpha = (uint16_t)value;
+    } else if (strcmp(param, "slew") == 0) {
+        slew = value;
+    } else if (strcmp(param, "tracker") == 0 && value <= 1U) {
+        tracker_on = (uint8_t)value;
+    } else if (strcmp(param, "talpha") == 0 && value >= 1U && value <= 256U) {
+        tracker_alpha = (uint16_t)value;
+    } else if (strcmp(param, "tbeta") == 0 && value <= 256U) {
+        tracker_beta = (uint16_t)value;
+    } else {
+        return false;
+    }
+    if (!ProximityCounter_SetFilterParams(&proximity_counter, alpha, slew)) {
+        return false;
+    }
+    proximity_filter_alpha = alpha;
+    proximity_filter_slew = slew;
+    proximity_tracker_on = tracker_on;
+    proximity_tracker_alpha = tracker_alpha;
+    proximity_tracker_beta = tracker_beta;
+    ProximityCounter_SetTracker(&proximity_counter, tracker_on, tracker_alpha, tracker_beta);
+    for (int i = 0; i < (int)MYFLASH_AUX_CHANNELS; i++) {
+        ProximityCounter_SetFilterParams(&proximity_channels[i], alpha, slew);
+        ProximityCounter_SetTracker(&proximity_channels[i], tracker_on, tracker_alpha, tracker_beta);
+    }
+    return true;
+}
+
+// Per-tooth spacing calibration of CH1 (console "tooth")
+static ProximityToothCal_t proximity_tooth_cal;
+static const char *const proximity_tooth_states[] = { "OFF", "LEARN", "ALIGN", "ACTIVE" };
+
+static void ApplyProximityToothMethod(bool per_edge) {
+    // Corrections apply per period, so CH1 runs the T-method on single periods while a table is in use
+    if (per_edge) {
+        ProximityCounter_SetAveraging(&proximity_counter, PROXIMITY_AVERAGING_BLOCK, 1, 0);
+        ProximityCounter_SetMethod(&proximity_counter, PROXIMITY_METHOD_PERIOD, 0);
+    } else {
+        ProximityCounter_SetAveraging(&proximity_counter, PROXIMITY_AVERAGING_BLOCK, 3, 0);
+        ProximityCounter_SetMethod(&proximity_counter, (ProximityMethod_t)proximity_capture_config.method,
+                                   proximity_capture_config.gateMs);
+    }
+}
+
+void LoadProximityTooth(void) {
+    myToothTable table;
+    ProximityCounter_SetToothCal(&proximity_counter, &proximity_tooth_cal);
+    myFlash_LoadToothTable(&table);
+    if (table.teeth == 0U) {
+        return;
+    }
+    if (table.teeth != PPR) {
+        printf("⚠️  Tooth table is for PPR=%lu, current PPR=%lu - not applied\r\n",
+               (unsigned long)table.teeth, (unsigned long)PPR);
+        return;
+    }
+    ApplyProximityToothMethod(true);
+    if (ProximityCounter_LoadToothTable(&proximity_counter, table.correction, table.teeth)) {
+        printf("✅ Loaded tooth table (%lu teeth) from Flash\r\n", (unsigned long)table.teeth);
+    }
+}
+
+void ShowProximityTooth(void) {
+    ProximityToothState_t state = ProximityCounter_GetToothState(&proximity_counter);
+    printf("=== TOOTH CALIBRATION (CH1) ===\r\n");
+    printf("State=%s PPR=%lu revs=%lu/%lu\r\n", proximity_tooth_states[state], (unsigned long)PPR,
+           (unsigned long)proximity_tooth_cal.revs, (unsigned long)proximity_tooth_cal.target_revs);
+    if (state == PROXIMITY_TOOTH_ACTIVE || state == PROXIMITY_TOOTH_ALIGN) {
+        for (uint32_t i = 0; i < proximity_tooth_cal.teeth; i++) {
+            printf("  T%02lu %.4f%s", (unsigned long)i,
+                   (double)proximity_tooth_cal.correction_q14[i] / (double)(1UL << PROXIMITY_TOOTH_Q_SHIFT),
+                   (i % 4U == 3U) ? "\r\n" : "");
+        }
+        printf("\r\n");
+    }
+    printf("💡 Use: tooth learn [revs] | tooth save | tooth load | tooth off\r\n");
+}
+
+bool SetProximityTooth(const char *action, uint32_t value) {
+    if (strcmp(action, "learn") == 0) {
+        if (PPR < 2U || PPR > PROXIMITY_TOOTH_MAX) {
+            return false;
+        }
+        ApplyProximityToothMethod(true);
+        return ProximityCounter_StartToothLearn(&proximity_counter, value);
+    }
+    if (strcmp(action, "save") == 0) {
+        myToothTable table = {0};
+        table.teeth = ProximityCounter_GetToothTable(&proximity_counter, table.correction, MYFLASH_TOOTH_MAX);
+        return table.teeth > 0U && myFlash_SaveToothTable(&table) == HAL_OK;
+    }
+    if (strcmp(action, "load") == 0) {
+        LoadProximityTooth();
+        return ProximityCounter_GetToothState(&proximity_counter) != PROXIMITY_TOOTH_OFF;
+    }
+    if (strcmp(action, "off") == 0) {
+        ProximityCounter_ClearToothTable(&proximity_counter);
+        ApplyProximityToothMethod(false);
+        return true;
+    }
+    return false;
+}
+
+// Missing-tooth reference gap of CH1 (console "sync" / Modbus 15..19)
+static const char *const proximity_sync_states[] = { "SEARCHING", "SYNCED", "LOST" };
+
+void LoadProximitySync(void) {
+    uint32_t missing = myFlash_LoadMissingTeeth();
+    if (missing > 0U && ProximityCounter_SetMissingTeeth(&proximity_counter, missing)) {
+        printf("✅ Missing-tooth gap: %lu teeth\r\n", (unsigned long)missing);
+    }
+}
+
+void ShowProximitySync(void) {
+    float angle = ProximityCounter_GetAngle(&proximity_counter);
+    printf("=== MISSING-TOOTH SYNC (CH1) ===\r\n");
+    printf("Gap=%lu teeth PPR=%lu State=%s\r\n", (unsigned long)proximity_counter.missing_teeth,
+           (unsigned long)PPR, proximity_sync_states[ProximityCounter_GetSyncState(&proximity_counter)]);
+    if (angle >= 0.0f) {
+        printf("Tooth=%lu Angle=%.1f deg\r\n", (unsigned long)proximity_counter.sync_tooth, (double)angle);
+    }
+    printf("Revs=%lu Losses=%lu\r\n", (unsigned long)proximity_counter.sync_revs,
+           (unsigned long)proximity_counter.sync_losses);
+    printf("💡 Use: sync gap <0-%u> (PPR counts the missing teeth too)\r\n", PROXIMITY_SYNC_MAX_MISSING);
+}
+
+bool SetProximityMissingTeeth(uint32_t missing) {
+    if (!ProximityCounter_SetMissingTeeth(&proximity_counter, missing)) {
+        return false;
+    }
+    return myFlash_SaveMissingTeeth(missing) == HAL_OK;
+}
+
+// Direction of CH1 from a second sensor on CH2 (console "dir" / Modbus 20..23)
+void LoadProximityDirection(void) {
+    if (myFlash_LoadDirectionSensor() && !proximity_channel_table.channels[0].enabled &&
+        ProximityCounter_SetDirectionSensor(&proximity_counter, true, TIM_CHANNEL_2)) {
+        proximity_direction_on = 1;
+        printf("✅ Direction sensor on CH2\r\n");
+    }
+}
+
+void ShowProximityDirection(void) {
+    int32_t dir = ProximityCounter_GetDirection(&proximity_counter);
+    printf("=== DIRECTION (CH1 + CH2) ===\r\n");
+    printf("Sensor=%s Direction=%s\r\n", proximity_direction_on ? "ON" : "OFF",
+           dir > 0 ? "FORWARD" : (dir < 0 ? "REVERSE" : "UNKNOWN"));
+    printf("Signed RPM=%.1f Position=%ld pulses\r\n", (double)ProximityCounter_GetSignedRPM(&proximity_counter),
+           (long)ProximityCounter_GetPosition(&proximity_counter));
+    printf("💡 Use: dir on|off (CH2 must be off as a channel)\r\n");
+}
+
+bool SetProximityDirection(bool enable) {
+    if (enable && (proximity_channel_table.channels[0].enabled || proximity_pulse_config.mode)) {
+        return false;
+    }
+    if (!ProximityCounter_SetDirectionSensor(&proximity_counter, enable, TIM_CHANNEL_2)) {
+        return false;
+    }
+    proximity_direction_on = enable ? 1U : 0U;
+    return myFlash_SaveDirectionSensor(proximity_direction_on) == HAL_OK;
+}
+
+// Pulse width and duty of CH1 (console "pw" / Modbus 24..27)
+void LoadProximityPulse(void) {
+    myFlash_LoadPulseConfig(&proximity_pulse_config);
+    if (proximity_pulse_config.mode == 0U) {
+        return;
+    }
+    if (proximity_direction_on || proximity_channel_table.channels[0].enabled ||
+        !ProximityCounter_SetPulseWidth(&proximity_counter, true, proximity_pulse_config.mode == 2U)) {
+        proximity_pulse_config.mode = 0U;
+        return;
+    }
+    ProximityCounter_SetDutyReference(&proximity_counter, (float)proximity_pulse_config.dutyRef / 10000.0f);
+    printf("✅ Pulse width on CH2%s\r\n", proximity_pulse_config.mode == 2U ? " (both edges)" : "");
+}
+
+void ShowProximityPulse(void) {
+    ProximityPulse_t pulse;
+    printf("=== PULSE WIDTH (CH1 via CH2) ===\r\n");
+    printf("Mode=%s Reference=%.2f%%\r\n",
+           proximity_pulse_config.mode == 2U ? "BOTH EDGES" : (proximity_pulse_config.mode ? "ON" : "OFF"),
+           (double)proximity_pulse_config.dutyRef / 100.0);
+    if (ProximityCounter_GetPulse(&proximity_counter, &pulse)) {
+        printf("High=%.1f us Period=%.1f us Duty=%.2f%% Avg=%.2f%% Drift=%+.2f%%\r\n",
+               (double)pulse.high_us, (double)pulse.period_us, (double)(pulse.duty * 100.0f),
+               (double)(pulse.duty_avg * 100.0f), (double)(pulse.drift * 100.0f));
+    }
+    printf("💡 Use: pw on|both|off | pw ref (store current average as healthy duty)\r\n");
+}
+
+bool SetProximityPulse(const char *action) {
+    myPulseConfig cfg = proximity_pulse_config;
+
+    if (strcmp(action, "ref") == 0) {
+        ProximityPulse_t pulse;
+        if (!ProximityCounter_GetPulse(&proximity_counter, &pulse)) {
+            return false;
+        }
+        ProximityCounter_SetDutyReference(&proximity_counter, pulse.duty_avg);
+        cfg.dutyRef = (uint16_t) (pulse.duty_avg * 10000.0f);
+    } else {
+        if (strcmp(action, "on") == 0) {
+            cfg.mode = 1U;
+        } else if (strcmp(action, "both") == 0) {
+            cfg.mode = 2U;
+        } else if (strcmp(action, "off") == 0) {
+            cfg.mode = 0U;
+        } else {
+            return false;
+        }
+        if (cfg.mode && (proximity_direction_on || proximity_channel_table.channels[0].enabled)) {
+            return false;
+        }
+        if (!ProximityCounter_SetPulseWidth(&proximity_counter, cfg.mode != 0U, cfg.mode == 2U)) {
+            return false;
+        }
+        ProximityCounter_SetDutyReference(&proximity_counter, (float)cfg.dutyRef / 10000.0f);
+    }
+    proximity_pulse_config = cfg;
+    return myFlash_SavePulseConfig(&cfg) == HAL_OK;
+}
+
+// Hardware pulse totalizer on TIM4, TI1 = PB6 wired in parallel with PA0 (console "total" / Modbus 30..35)
+static PulseTotalizer_t pulse_totalizer;
+
+void LoadProximityTotalizer(void) {
+    myTotalizerLevels levels;
+    myFlash_LoadTotalizerLevels(&levels);
+    PulseTotalizerConfig_t cfg = {
+        .source = TOTALIZER_SOURCE_TI1,
+        .falling = 0,
+        .filter = TOTALIZER_DEFAULT_FILTER,
+        .preset = levels.preset,
+        .target = levels.target
+    };
+    if (!PulseTotalizer_Init(&pulse_totalizer, &cfg, &htim4)) {
+        printf("❌ Pulse totalizer init failed\r\n");
+        return;
+    }
+    PulseTotalizer_Start(&pulse_totalizer);
+    printf("✅ Pulse totalizer on TIM4 (PB6)\r\n");
+}
+
+void ShowProximityTotal(void) {
+    printf("=== PULSE TOTALIZER (TIM4 TI1/PB6) ===\r\n");
+    printf("Total=%llu State=%s\r\n", (unsigned long long)PulseTotalizer_GetTotal(&pulse_totalizer),
+           pulse_totalizer.running ? "RUNNING" : "STOPPED");
+    for (uint32_t i = 0; i < TOTALIZER_LEVEL_COUNT; i++) {
+        uint64_t level = PulseTotalizer_GetLevel(&pulse_totalizer, (TotalizerLevel_t)i);
+        printf("%s=%llu%s\r\n", i == TOTALIZER_LEVEL_PRESET ? "Preset" : "Target", (unsigned long long)level,
+               level == 0U ? " (off)" : (PulseTotalizer_IsReached(&pulse_totalizer, (TotalizerLevel_t)i) ? " REACHED" : ""));
+    }
+    printf("💡 Use: total reset | total preset <n> | total target <n> (0=off)\r\n");
+}
+
+bool SetProximityTotal(const char *action, uint32_t value) {
+    if (strcmp(action, "reset") == 0) {
+        PulseTotalizer_Reset(&pulse_totalizer);
+        return true;
+    }
+
+    TotalizerLevel_t level;
+    if (strcmp(action, "preset") == 0) {
+        level = TOTALIZER_LEVEL_PRESET;
+    } else if (strcmp(action, "target") == 0) {
+        level = TOTALIZER_LEVEL_TARGET;
+    } else {
+        return false;
+    }
+    PulseTotalizer_SetLevel(&pulse_totalizer, level, value);
+
+    myTotalizerLevels levels = {
+        .preset = (uint32_t) PulseTotalizer_GetLevel(&pulse_totalizer, TOTALIZER_LEVEL_PRESET),
+        .target = (uint32_t) PulseTotalizer_GetLevel(&pulse_totalizer, TOTALIZER_LEVEL_TARGET)
+    };
+    return myFlash_SaveTotalizerLevels(&levels) == HAL_OK;
+}
+
+// Quadrature encoders by timer (console "qenc" / Modbus input registers 880..911, 8 per timer)
+static Encoder_t quad_encoders[ENCODER_TIMER_COUNT];
+static EncoderRegistry_t encoder_registry;
+static myQuadEncoderTable quad_encoder_table;
+// TIM1 CH2 is PA9 (USART1 TX) and TIM2 captures the proximity channels on this board
+static TIM_HandleTypeDef *const quad_encoder_timers[ENCODER_TIMER_COUNT] = { NULL, NULL, &htim3, &htim4 };
+static const char *const quad_encoder_pins[ENCODER_TIMER_COUNT] = {
+    "PA8/PA9, USART1", "proximity", "PA6/PA7", "PB6/PB7"
+};
+
+static bool QuadEncoder_Start(uint32_t index) {
+    TIM_HandleTypeDef *htim = quad_encoder_timers[index];
+    const myQuadEncoderParams *params = &quad_encoder_table.encoders[index];
+
+    if (!htim) {
+        return false;
+    }
+    if (htim == &htim4 && pulse_totalizer.htim) {
+        // TIM4 counts the totalizer otherwise; hand the timer over until reboot
+        PulseTotalizer_Stop(&pulse_totalizer);
+        pulse_totalizer.htim = NULL;
+        HAL_TIM_Base_DeInit(&htim4);
+        printf("⚠️  TIM4 taken by encoder, totalizer off\r\n");
+    }
+    htim->Instance = (htim == &htim3) ? TIM3 : TIM4;
+    if (Encoder_InitFull(&quad_encoders[index], htim, (uint16_t) params->pulsesPerRev,
+                         (float) params->diameter / 1000.0f, (uint16_t) params->sampleTimeMs) != HAL_OK) {
+        return false;
+    }
+    Encoder_SetLowSpeed(&quad_encoders[index], (uint16_t) params->lowSpeedCounts);
+    return EncoderRegistry_Add(&encoder_registry, &quad_encoders[index]);
+}
+
+static void QuadEncoder_Stop(uint32_t index) {
+    Encoder_t *enc = encoder_registry.by_timer[index];
+    if (!enc) {
+        return;
+    }
+    EncoderRegistry_Remove(&encoder_registry, enc);
+    Encoder_Stop(enc);
+    HAL_TIM_Encoder_DeInit(enc->htim);
+}
+
+void LoadQuadEncoders(void) {
+    EncoderRegistry_Init(&encoder_registry);
+    myFlash_LoadQuadEncoderTable(&quad_encoder_table);
+    for (uint32_t i = 0; i < ENCODER_TIMER_COUNT; i++) {
+        if (!quad_encoder_table.encoders[i].enabled) {
+            continue;
+        }
+        if (QuadEncoder_Start(i)) {
+            printf("✅ Quadrature encoder on TIM%lu (%s)\r\n", (unsigned long)(i + 1U), quad_encoder_pins[i]);
+        } else {
+            printf("❌ Quadrature encoder on TIM%lu failed\r\n", (unsigned long)(i + 1U));
+        }
+    }
+}
+
+void ShowQuadEncoders(void) {
+    printf("=== QUADRATURE ENCODERS ===\r\n");
+    for (uint32_t i = 0; i < ENCODER_TIMER_COUNT; i++) {
+        const myQuadEncoderParams *params = &quad_encoder_table.encoders[i];
+        Encoder_t *enc = encoder_registry.by_timer[i];
+        printf("TIM%lu (%s): ", (unsigned long)(i + 1U), quad_encoder_pins[i]);
+        if (!quad_encoder_timers[i]) {
+            printf("not available\r\n");
+        } else if (!enc) {
+            printf("OFF PPR=%lu DIA=%lumm LOWSPEED<%lu\r\n", (unsigned long)params->pulsesPerRev,
+                   (unsigned long)params->diameter, (unsigned long)params->lowSpeedCounts);
+        } else {
+            printf("ON PPR=%lu DIA=%lumm LOWSPEED<%lu%s FILTER=%s Pulses=%lld Length=%.3fm RPM=%.2f DirMismatch=%lu\r\n",
+                   (unsigned long)params->pulsesPerRev, (unsigned long)params->diameter,
+                   (unsigned long)params->lowSpeedCounts, enc->edge_irq ? " (1/T)" : "",
+                   RpmFilter_ChainName(enc->filter.chain),
+                   (long long)Encoder_GetPulse(enc), (double)Encoder_GetCurrentLength(enc),
+                   (double)Encoder_GetCurrentRPM(enc), (unsigned long)enc->dir_mismatches);
+        }
+    }
+    printf("💡 Use: qenc <3|4> on [ppr] [dia_mm] | qenc <3|4> off | qenc <3|4> reset | qenc <3|4> lowspeed <counts>\r\n");
+    printf("💡 Use: qenc <3|4> filter <0-%d> (1 = ema, default)\r\n", (int)RPM_FILTER_CHAIN_COUNT - 1);
+}
+
+bool SetQuadEncoder(uint32_t timer, const char *action, uint32_t ppr, uint32_t diameter) {
+    if (timer < 1U || timer > ENCODER_TIMER_COUNT || !quad_encoder_timers[timer - 1U]) {
+        return false;
+    }
+    uint32_t index = timer - 1U;
+    myQuadEncoderTable table = quad_encoder_table;
+    myQuadEncoderParams *params = &table.encoders[index];
+
+    if (strcmp(action, "reset") == 0) {
+        Encoder_Reset(encoder_registry.by_timer[index]);
+        return encoder_registry.by_timer[index] != NULL;
+    } else if (strcmp(action, "on") == 0) {
+        if (ppr > 0U) {
+            params->pulsesPerRev = ppr;
+        }
+        if (diameter > 0U) {
+            params->diameter = diameter;
+        }
+        params->enabled = 1U;
+    } else if (strcmp(action, "off") == 0) {
+        params->enabled = 0U;
+    } else if (strcmp(action, "filter") == 0) {
+        // Running encoder only, not saved: every start begins on RPM_FILTER_CHAIN_EMA
+        return Encoder_SetFilterChain(encoder_registry.by_timer[index], (RpmFilterChain_t) ppr);
+    } else if (strcmp(action, "lowspeed") == 0) {
+        if (ppr > 1000U) {
+            return false;
+        }
+        params->lowSpeedCounts = ppr;  // Counts per window, 0 = always count the window
+        Encoder_SetLowSpeed(encoder_registry.by_timer[index], (uint16_t) ppr);
+        quad_encoder_table = table;
+        return myFlash_SaveQuadEncoderTable(&table) == HAL_OK;
+    } else {
+        return false;
+    }
+
+    quad_encoder_table = table;
+    QuadEncoder_Stop(index);
+    if (params->enabled && !QuadEncoder_Start(index)) {
+        return false;
+    }
+    return myFlash_SaveQuadEncoderTable(&table) == HAL_OK;
+}
+
+// Windowed speed statistics of CH1 (console "stats" / Modbus input registers 0..29)
+void ShowProximityStats(void) {
+    printf("=== SPEED STATISTICS (CH1) ===\r\n");
+    for (uint32_t w = 0; w < RPM_STATS_WINDOWS; w++) {
+        RpmStatsResult_t stats;
+        ProximityCounter_GetStats(&proximity_counter, w, &stats);
+        printf("%5lus: n=%lu mean=%.2f sd=%.2f min=%.2f max=%.2f RPM (#%lu)\r\n",
+               (unsigned long)(proximity_counter.stats.window[w].window_ms / 1000U), (unsigned long)stats.count,
+               (double)stats.mean_q8 / RPM_FILTER_Q_ONE, (double)stats.stddev_q8 / RPM_FILTER_Q_ONE,
+               (double)stats.min_q8 / RPM_FILTER_Q_ONE, (double)stats.max_q8 / RPM_FILTER_Q_ONE,
+               (unsigned long)stats.sequence);
+    }
+}
+
+// Raw period trace of CH1 (console "trace" / Modbus 36..104)
+#define TRACE_MODBUS_WINDOW 32U   // Periods per Modbus read window, two registers each
+static ProximityTrace_t proximity_trace;
+static myTraceConfig proximity_trace_config;
+static uint16_t proximity_trace_offset;  // First period shown in the Modbus window
+
+static const char *const proximity_trace_causes[] = { "NONE", "MANUAL", "OVERSPEED", "GLITCH" };
+static const char *const proximity_trace_states[] = { "RECORDING", "TRIGGERED", "FROZEN" };
+
+void LoadProximityTrace(void) {
+    ProximityCounter_SetTrace(&proximity_counter, &proximity_trace);
+    myFlash_LoadTraceConfig(&proximity_trace_config);
+    if (!ProximityCounter_SetTraceTrigger(&proximity_counter, proximity_trace_config.pre, proximity_trace_config.post,
+                                          proximity_trace_config.overspeedRpm, proximity_trace_config.onGlitch)) {
+        proximity_trace_config.pre = PROXIMITY_TRACE_DEFAULT_PRE;
+        proximity_trace_config.post = PROXIMITY_TRACE_DEFAULT_POST;
+        ProximityCounter_SetTraceTrigger(&proximity_counter, proximity_trace_config.pre, proximity_trace_config.post,
+                                         proximity_trace_config.overspeedRpm, proximity_trace_config.onGlitch);
+    }
+}
+
+void ShowProximityTrace(void) {
+    uint32_t trigger_at;
+    uint32_t length = ProximityCounter_GetTraceLength(&proximity_counter, &trigger_at);
+    printf("=== RAW TRACE (CH1) ===\r\n");
+    printf("State=%s Cause=%s Pre=%u Post=%u\r\n",
+           proximity_trace_states[ProximityCounter_GetTraceState(&proximity_counter)],
+           proximity_trace_causes[proximity_trace.cause],
+           proximity_trace_config.pre, proximity_trace_config.post);
+    printf("Triggers: overspeed=%lu RPM%s glitch=%s\r\n", (unsigned long)proximity_trace_config.overspeedRpm,
+           proximity_trace_config.overspeedRpm ? "" : " (off)", proximity_trace_config.onGlitch ? "ON" : "OFF");
+    if (length > 0U) {
+        printf("Block=%lu periods, trigger after %lu, edges/capture=%lu\r\n", (unsigned long)length,
+               (unsigned long)trigger_at, (unsigned long)ProximityCounter_GetEdgeDivider(&proximity_counter));
+    }
+    printf("💡 Use: trace arm|trigger|dump | trace pre|post|over <n> | trace glitch on|off\r\n");
+}
+
+void DumpProximityTrace(void) {
+    uint32_t trigger_at;
+    uint32_t length = ProximityCounter_GetTraceLength(&proximity_counter, &trigger_at);
+    uint32_t periods[16];
+
+    if (length == 0U) {
+        printf("⚠️  No frozen block (use trace trigger)\r\n");
+        return;
+    }
+    printf("index,period_us\r\n");
+    for (uint32_t offset = 0; offset < length; offset += 16U) {
+        uint32_t n = ProximityCounter_ReadTrace(&proximity_counter, offset, periods, 16U);
+        for (uint32_t i = 0; i < n; i++) {
+            // Index relative to the trigger: negative = before
+            printf("%ld,%.2f\r\n", (long)(offset + i) - (long)trigger_at,
+                   (double)periods[i] * 1e6 / (double)PROXIMITY_TIMCLOCK);
+        }
+    }
+}
+
+bool SetProximityTrace(const char *param, uint32_t value) {
+    myTraceConfig cfg = proximity_trace_config;
+
+    if (strcmp(param, "arm") == 0) {
+        ProximityCounter_ArmTrace(&proximity_counter);
+        return true;
+    } else if (strcmp(param, "trigger") == 0) {
+        ProximityCounter_TriggerTrace(&proximity_counter, PROXIMITY_TRIGGER_MANUAL);
+        return true;
+    } else if (strcmp(param, "pre") == 0) {
+        cfg.pre = (uint16_t) value;
+    } else if (strcmp(param, "post") == 0) {
+        cfg.post = (uint16_t) value;
+    } else if (strcmp(param, "over") == 0) {
+        cfg.overspeedRpm = value;
+    } else if (strcmp(param, "glitch") == 0) {
+        cfg.onGlitch = value ? 1U : 0U;
+    } else {
+        return false;
+    }
+    if (value >= PROXIMITY_TRACE_SIZE && (strcmp(param, "pre") == 0 || strcmp(param, "post") == 0)) {
+        return false;
+    }
+    if (!ProximityCounter_SetTraceTrigger(&proximity_counter, cfg.pre, cfg.post, cfg.overspeedRpm, cfg.onGlitch)) {
+        return false;
+    }
+    proximity_trace_config = cfg;
+    return myFlash_SaveTraceConfig(&cfg) == HAL_OK;
+}
+
+// Speed history of CH1 (console "hist" / Modbus input registers 30..879)
+static RpmHistory_t proximity_history;
+static const char *const proximity_history_tiers[RPM_HISTORY_TIERS] = { "100 ms", "1 s", "1 min" };
+
+void LoadProximityHistory(void) {
+    // Tiers live in the input register table, a master reads them without a copy
+    RpmHistory_Init(&proximity_history, &input_regs[INPUT_REG_HISTORY], HAL_GetTick());
+    ProximityCounter_SetHistory(&proximity_counter, &proximity_history);
+}
+
+void ShowProximityHistory(void) {
+    printf("=== SPEED HISTORY (CH1) ===\r\n");
+    for (uint32_t t = 0; t < RPM_HISTORY_TIERS; t++) {
+        const RpmHistoryTier_t *tier = &proximity_history.tier[t];
+        uint16_t entry[RPM_HISTORY_ENTRY_WORDS];
+        printf("Tier %lu (%s): %u/%u entries", (unsigned long)t, proximity_history_tiers[t], tier->count, tier->size);
+        if (RpmHistory_Get(&proximity_history, t, 0, entry)) {
+            printf(", newest mean=%.1f min=%.1f max=%.1f RPM", (double)entry[0] / RPM_HISTORY_UNITS_PER_RPM,
+                   (double)entry[1] / RPM_HISTORY_UNITS_PER_RPM, (double)entry[2] / RPM_HISTORY_UNITS_PER_RPM);
+        }
+        printf("\r\n");
+    }
+    printf("💡 Use: hist 0|1|2 (dump a tier) | hist reset\r\n");
+}
+
+bool DumpProximityHistory(uint32_t tier) {
+    uint16_t entry[RPM_HISTORY_ENTRY_WORDS];
+
+    if (tier >= RPM_HISTORY_TIERS) {
+        return false;
+    }
+    printf("age,mean_rpm,min_rpm,max_rpm\r\n");
+    // Age in entries of this tier, 0 = newest
+    for (uint32_t age = 0; RpmHistory_Get(&proximity_history, tier, age, entry); age++) {
+        printf("%lu,%.1f,%.1f,%.1f\r\n", (unsigned long)age, (double)entry[0] / RPM_HISTORY_UNITS_PER_RPM,
+               (double)entry[1] / RPM_HISTORY_UNITS_PER_RPM, (double)entry[2] / RPM_HISTORY_UNITS_PER_RPM);
+    }
+    return true;
+}
+
+void ResetProximityHistory(void) {
+    RpmHistory_Reset(&proximity_history, HAL_GetTick());
+}
+
 // Public function for UART3 DMA restart
 void Restart_UART3_DMA(void);
 
@@ -345,6 +1103,110 @@ static void HoldingRegs_Refresh(void) {
 	holding_regs[1] = (uint16_t) (DIA * 1000); // diameter in mm
 	holding_regs[2] = TIME;					  // sample time in ms
 	holding_regs[3] = (uint16_t) floor(ProximityCounter_GetRPM(&proximity_counter)); // current RPM
+	for (int i = 0; i < (int)MYFLASH_AUX_CHANNELS; i++) {
+		holding_regs[4 + i] = (uint16_t) floor(ProximityCounter_GetRPM(&proximity_channels[i])); // RPM CH2..CH4
+	}
+	holding_regs[7] = (uint16_t) proximity_filter_chain;	  // RPM filter chain
+	holding_regs[8] = proximity_filter_alpha;			  // EMA alpha (1/256)
+	holding_regs[9] = (uint16_t) proximity_filter_slew;	  // slew limit (RPM/sample)
+	holding_regs[10] = proximity_tracker_on;			  // alpha-beta tracker on/off
+	float accel = ProximityCounter_GetAcceleration(&proximity_counter);
+	accel = (accel > 32767.0f) ? 32767.0f : (accel < -32767.0f) ? -32767.0f : accel;
+	holding_regs[11] = (uint16_t) (int16_t) accel;	  // acceleration (RPM/s, signed)
+	float variance = ProximityCounter_GetSpeedVariance(&proximity_counter);
+	holding_regs[12] = (variance > 65535.0f) ? 65535U : (uint16_t) variance; // RPM^2
+	holding_regs[13] = (proximity_capture_config.maxAccel > 0xFFFFU) ? 0xFFFFU : (uint16_t) proximity_capture_config.maxAccel; // RPM/s
+	holding_regs[14] = (uint16_t) (ProximityCounter_GetRejectRatio(&proximity_counter) * 10000.0f); // 0.01 %
+	float angle = ProximityCounter_GetAngle(&proximity_counter);
+	holding_regs[15] = (angle < 0.0f) ? 0xFFFFU : (uint16_t) (angle * 10.0f); // shaft angle (0.1 deg), 0xFFFF = not synced
+	holding_regs[16] = (uint16_t) proximity_counter.sync_revs;	  // revolutions counted at the gap (low 16 bits)
+	holding_regs[17] = (uint16_t) proximity_counter.sync_losses; // sync-loss events
+	holding_regs[18] = (uint16_t) ProximityCounter_GetSyncState(&proximity_counter); // 0 searching, 1 synced, 2 lost
+	holding_regs[19] = (uint16_t) proximity_counter.missing_teeth; // missing teeth at the gap
+	holding_regs[20] = (uint16_t) (int16_t) ProximityCounter_GetDirection(&proximity_counter); // +1 / -1 / 0 unknown
+	float signed_rpm = ProximityCounter_GetSignedRPM(&proximity_counter);
+	if (signed_rpm > 32767.0f) {
+		signed_rpm = 32767.0f;
+	} else if (signed_rpm < -32767.0f) {
+		signed_rpm = -32767.0f;
+	}
+	holding_regs[21] = (uint16_t) (int16_t) signed_rpm;	  // signed RPM
+	uint32_t position = (uint32_t) ProximityCounter_GetPosition(&proximity_counter);
+	holding_regs[22] = (uint16_t) (position & 0xFFFFU);	  // signed pulse total, low word
+	holding_regs[23] = (uint16_t) (position >> 16);		  // signed pulse total, high word
+	ProximityPulse_t pulse = { 0 };
+	ProximityCounter_GetPulse(&proximity_counter, &pulse);
+	holding_regs[24] = (pulse.high_us > 65535.0f) ? 65535U : (uint16_t) pulse.high_us; // pulse high time (us)
+	holding_regs[25] = (uint16_t) (pulse.duty * 10000.0f);	  // duty (0.01 %)
+	holding_regs[26] = (pulse.period_us > 6553500.0f) ? 65535U : (uint16_t) (pulse.period_us / 100.0f); // period (0.1 ms)
+	holding_regs[27] = (uint16_t) (int16_t) (pulse.drift * 10000.0f); // duty drift vs reference (0.01 %, signed)
+	holding_regs[28] = (uint16_t) ProximityCounter_GetEdgeDivider(&proximity_counter); // edges per capture (ICPSC)
+	float capture_rate = ProximityCounter_GetCaptureRate(&proximity_counter);
+	holding_regs[29] = (capture_rate > 65535.0f) ? 65535U : (uint16_t) capture_rate; // captures per second
+	uint64_t total = PulseTotalizer_GetTotal(&pulse_totalizer);
+	for (int i = 0; i < 4; i++) {
+		holding_regs[30 + i] = (uint16_t) (total >> (16 * i));	  // pulse total, low word first
+	}
+	holding_regs[34] = (uint16_t) (PulseTotalizer_IsReached(&pulse_totalizer, TOTALIZER_LEVEL_PRESET)
+			| (PulseTotalizer_IsReached(&pulse_totalizer, TOTALIZER_LEVEL_TARGET) << 1)
+			| (pulse_totalizer.running << 2)); // bit0 preset, bit1 target reached, bit2 running
+	uint32_t trigger_at;
+	uint32_t trace_length = ProximityCounter_GetTraceLength(&proximity_counter, &trigger_at);
+	holding_regs[36] = (uint16_t) ProximityCounter_GetTraceState(&proximity_counter); // 0 recording, 1 triggered, 2 frozen
+	holding_regs[37] = proximity_trace.cause;	  // 1 manual, 2 overspeed, 3 glitch
+	holding_regs[38] = (uint16_t) trace_length;	  // periods in the frozen block
+	holding_regs[39] = (uint16_t) trigger_at;	  // periods before the trigger
+	holding_regs[40] = proximity_trace_offset;	  // first period of the window below
+	uint32_t periods[TRACE_MODBUS_WINDOW];
+	uint32_t n = ProximityCounter_ReadTrace(&proximity_counter, proximity_trace_offset, periods, TRACE_MODBUS_WINDOW);
+	for (uint32_t i = 0; i < n; i++) {
+		holding_regs[41 + 2 * i] = (uint16_t) (periods[i] & 0xFFFFU); // period in 72 MHz clocks, low word
+		holding_regs[42 + 2 * i] = (uint16_t) (periods[i] >> 16);	  // high word
+	}
+	holding_regs[105] = (uint16_t) proximity_capture_config.method;  // 0 T-method, 1 M/T
+	holding_regs[106] = (uint16_t) proximity_capture_config.gateMs;  // M/T gate (ms)
+	holding_regs[107] = (proximity_capture_config.maxIrqHz > 0xFFFFU) ? 0xFFFFU : (uint16_t) proximity_capture_config.maxIrqHz; // captures/s, 0 = every edge
+}
+
+// Q8 RPM -> 0.01 RPM, as two registers (low word first)
+static void InputRegs_PutRpm(uint16_t index, int32_t rpm_q8) {
+	uint32_t value = (rpm_q8 > 0) ? (uint32_t) (((uint64_t) rpm_q8 * 100U) >> RPM_FILTER_Q_SHIFT) : 0U;
+	input_regs[index] = (uint16_t) (value & 0xFFFFU);
+	input_regs[index + 1] = (uint16_t) (value >> 16);
+}
+
+static void InputRegs_Refresh(void) {
+	for (uint32_t w = 0; w < RPM_STATS_WINDOWS; w++) {
+		RpmStatsResult_t stats;
+		uint16_t base = (uint16_t) (w * 10U);
+		ProximityCounter_GetStats(&proximity_counter, w, &stats);
+		InputRegs_PutRpm(base + 0, stats.mean_q8);		  // mean (0.01 RPM)
+		InputRegs_PutRpm(base + 2, (int32_t) stats.stddev_q8); // standard deviation (0.01 RPM)
+		InputRegs_PutRpm(base + 4, stats.min_q8);		  // min (0.01 RPM)
+		InputRegs_PutRpm(base + 6, stats.max_q8);		  // max (0.01 RPM)
+		input_regs[base + 8] = (stats.count > 0xFFFFU) ? 0xFFFFU : (uint16_t) stats.count; // samples
+		input_regs[base + 9] = (uint16_t) stats.sequence; // windows closed, changes when the values are new
+	}
+
+	// One block per encoder timer, zero while none is registered
+	for (uint32_t i = 0; i < ENCODER_TIMER_COUNT; i++) {
+		Encoder_t *enc = encoder_registry.by_timer[i];
+		uint16_t *block = &input_regs[INPUT_REG_ENCODERS + i * ENCODER_REG_BLOCK];
+		if (enc) {
+			enc->current_length = Encoder_GetLengthMeter(enc);
+			enc->current_rpm = Encoder_GetRPM(enc);
+			Encoder_PutRegisters(enc, block); // pulses int64, RPM x100, length mm (low word first)
+		} else {
+			memset(block, 0, ENCODER_REG_BLOCK * sizeof(uint16_t));
+		}
+	}
+
+	// History header; the tier entries are written in place by the history itself
+	input_regs[30] = RPM_HISTORY_UNITS_PER_RPM;			  // entry units per RPM
+	for (uint32_t t = 0; t < RPM_HISTORY_TIERS; t++) {
+		input_regs[31 + 2 * t] = proximity_history.tier[t].head;  // next entry written (oldest once full)
+		input_regs[32 + 2 * t] = proximity_history.tier[t].count; // valid entries
+	}
 }
 
 
@@ -431,6 +1293,65 @@ void on_write_single_register(uint16_t addr, uint16_t value) {
 		TIME = value;
 		ProximityCounter_SetTimeout(&proximity_counter, value * 10); // Convert to reasonable timeout
 		break; // thời gian lấy mẫu (ms)
+	case 7:
+		if (SetProximityFilterChain(value)) {
+			holding_regs[7] = value;
+		}
+		break; // chuỗi bộ lọc RPM
+	case 8:
+		if (SetProximityFilterParam("alpha", value)) {
+			holding_regs[8] = value;
+		}
+		break; // hệ số EMA (1/256)
+	case 9:
+		if (SetProximityFilterParam("slew", value)) {
+			holding_regs[9] = value;
+		}
+		break; // giới hạn tốc độ thay đổi (RPM/mẫu)
+	case 10:
+		if (SetProximityFilterParam("tracker", value)) {
+			holding_regs[10] = value;
+		}
+		break; // bật/tắt bộ ước lượng alpha-beta
+	case 13:
+		SetProximityFilterParam("accel", value);
+		holding_regs[13] = value;
+		break; // gia tốc tối đa (RPM/s), 0 = tắt lọc xung nhiễu
+	case 19:
+		if (SetProximityMissingTeeth(value)) {
+			holding_regs[19] = value;
+		}
+		break; // số răng thiếu ở khe tham chiếu, 0 = bánh răng đều
+	case 35:
+		if (value == 1U) {
+			SetProximityTotal("reset", 0);
+		}
+		break; // ghi 1 để xoá bộ đếm tổng xung
+	case 36:
+		if (value == 1U) {
+			SetProximityTrace("trigger", 0);
+		} else if (value == 2U) {
+			SetProximityTrace("arm", 0);
+		}
+		break; // ghi 1 để kích trace, 2 để ghi lại từ đầu
+	case 40:
+		proximity_trace_offset = value;
+		holding_regs[40] = value;
+		break; // vị trí period đầu tiên của cửa sổ đọc trace (41..104)
+	case 105:
+		if (SetProximityFilterParam("method", value)) {
+			holding_regs[105] = value;
+		}
+		break; // phương pháp đo: 0 = T (chu kỳ), 1 = M/T (đếm theo gate)
+	case 106:
+		if (SetProximityFilterParam("gate", value)) {
+			holding_regs[106] = value;
+		}
+		break; // thời gian gate M/T (ms)
+	case 107:
+		SetProximityFilterParam("irq", value);
+		holding_regs[107] = value;
+		break; // trần số capture/s mỗi kênh, 0 = capture mọi cạnh
 	default:
 		break;
 	}
@@ -442,8 +1363,8 @@ void on_write_multiple_registers(uint16_t addr, const uint16_t *values,
 void modbus_slave_setup(uint8_t slave_id) {
 	ModbusSlaveConfig slave_cfg = { .id = slave_id, .coils = NULL, .coil_count =
 			0, .discrete_inputs = NULL, .discrete_input_count = 0,
-			.holding_registers = holding_regs, .holding_register_count = 10,
-			.input_registers = NULL, .input_register_count = 0, .on_read_coils =
+			.holding_registers = holding_regs, .holding_register_count = 108,
+			.input_registers = input_regs, .input_register_count = INPUT_REG_COUNT, .on_read_coils =
 					NULL, .on_read_discrete_inputs = NULL,
 			.on_read_holding_registers = NULL, .on_read_input_registers = NULL,
 			.on_write_single_coil = NULL, .on_write_single_register =
@@ -507,14 +1428,26 @@ void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) {
 	}
 }
 void HAL_TIM_IC_CaptureCallback(TIM_HandleTypeDef *htim) {
-	// Delegate to proximity counter library
-	ProximityCounter_HandleCapture(&proximity_counter, htim);
+	// Delegate to the proximity counter bound to this channel
+	ProximityCounter_DispatchCapture(htim);
+	EncoderRegistry_HandleCapture(&encoder_registry, htim);
 }
 
-// Timer overflow callback - counts overflows between captures
+// DMA capture ring half full (DMA capture mode)
+void HAL_TIM_IC_CaptureHalfCpltCallback(TIM_HandleTypeDef *htim) {
+	ProximityCounter_DispatchCaptureHalf(htim);
+}
+
+// Timer overflow callback - extends the timebase of every channel on the timer
 void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim) {
-	// Delegate to proximity counter library
-	ProximityCounter_HandleOverflow(&proximity_counter, htim);
+	ProximityCounter_DispatchOverflow(htim);
+	PulseTotalizer_HandleOverflow(&pulse_totalizer, htim);
+	EncoderRegistry_HandleOverflow(&encoder_registry, htim);
+}
+
+// Totalizer preset/target compare on TIM4 CH2/CH3
+void HAL_TIM_OC_DelayElapsedCallback(TIM_HandleTypeDef *htim) {
+	PulseTotalizer_HandleCompare(&pulse_totalizer, htim);
 }
 /* USER CODE END 0 */
 
@@ -541,7 +1474,7 @@ int main(void) {
 	SystemClock_Config();
 
 	/* USER CODE BEGIN SysInit */
-
+	Timebase_Init();  // Cycle counter for encoder and proximity intervals
 	/* USER CODE END SysInit */
 
 	/* Initialize all configured peripherals */
@@ -560,7 +1493,19 @@ int main(void) {
 		.ppr = PPR,
 		.diameter = DIA,
 		.timeout_ms = TIMEOUT,
-		.averaging_samples = 3
+		.averaging_samples = 3,
+#ifdef PROXIMITY_CH1_DMA
+		.capture_mode = PROXIMITY_CAPTURE_MODE_DMA,
+		.dma_ring = &proximity_dma_ring,
+#else
+		.capture_mode = PROXIMITY_CAPTURE_MODE_IT,
+#endif
+		.auto_range = 1,
+		.method = PROXIMITY_METHOD_PERIOD,
+		.gate_ms = PROXIMITY_MT_DEFAULT_GATE_MS,
+		.filter_chain = RPM_FILTER_CHAIN_HYSTERESIS,
+		.max_accel = 0,  // glitch rejection off until LoadProximityCapture()
+		.max_irq_hz = 0   // every edge captured until LoadProximityCapture()
 	};
 	ProximityCounter_Init(&proximity_counter, &prox_config, &htim2);
 	ProximityCounter_Start(&proximity_counter);
@@ -587,6 +1532,36 @@ int main(void) {
 	
 	// Load Hysteresis table from Flash
 	LoadProximityHysteresis();
+
+	// Speed method, glitch limit and input stage of all channels (T-method, off unless chosen)
+	LoadProximityCapture();
+
+	// Start the extra TIM2 channels enabled in Flash
+	LoadProximityChannels();
+
+	// Per-tooth spacing corrections for CH1, aligned during the first revolution
+	LoadProximityTooth();
+
+	// Missing-tooth reference gap of CH1
+	LoadProximitySync();
+
+	// Direction sensor on CH2, unless CH2 runs as its own channel
+	LoadProximityDirection();
+
+	// Pulse width / duty on CH1 via CH2, unless CH2 is already taken
+	LoadProximityPulse();
+
+	// Hardware totalizer on TIM4, counts alongside the RPM measurement
+	LoadProximityTotalizer();
+
+	// Quadrature encoders on TIM3 / TIM4 (TIM4 replaces the totalizer)
+	LoadQuadEncoders();
+
+	// Raw capture trace of CH1, recording until a trigger freezes it
+	LoadProximityTrace();
+
+	// Speed history of CH1 in 100 ms / 1 s / 1 min tiers
+	LoadProximityHistory();
 	
 	// Initialize Command Handler
 	CommandHandler_Config_t cmd_config = {
@@ -731,6 +1706,12 @@ int main(void) {
 		// Process proximity counter
 		ProximityCounter_ProcessCapture(&proximity_counter);
 		ProximityCounter_CheckTimeout(&proximity_counter);
+		for (int i = 0; i < (int)MYFLASH_AUX_CHANNELS; i++) {
+			if (proximity_channels[i].running) {
+				ProximityCounter_ProcessCapture(&proximity_channels[i]);
+				ProximityCounter_CheckTimeout(&proximity_channels[i]);
+			}
+		}
 
 		// Display speed according to current unit setting
 		ProximitySpeedUnit_t current_unit = ProximityCounter_GetSpeedUnit(&proximity_counter);
@@ -747,6 +1728,7 @@ int main(void) {
       }
     }
 		HoldingRegs_Refresh();
+		InputRegs_Refresh();
 		Handle_Buttons();
 
 		queue_frame_t frame;
@@ -877,6 +1859,16 @@ static void MX_TIM2_Init(void) {
 		Error_Handler();
 	}
 	/* USER CODE BEGIN TIM2_Init 2 */
+	// CH2..CH4 capture the extra proximity channels (PA1..PA3)
+	if (HAL_TIM_IC_ConfigChannel(&htim2, &sConfigIC, TIM_CHANNEL_2) != HAL_OK) {
+		Error_Handler();
+	}
+	if (HAL_TIM_IC_ConfigChannel(&htim2, &sConfigIC, TIM_CHANNEL_3) != HAL_OK) {
+		Error_Handler();
+	}
+	if (HAL_TIM_IC_ConfigChannel(&htim2, &sConfigIC, TIM_CHANNEL_4) != HAL_OK) {
+		Error_Handler();
+	}
 
 	/* USER CODE END TIM2_Init 2 */
 
@@ -1001,6 +1993,9 @@ static void MX_DMA_Init(void) {
 	/* DMA1_Channel3_IRQn interrupt configuration */
 	HAL_NVIC_SetPriority(DMA1_Channel3_IRQn, 0, 0);
 	HAL_NVIC_EnableIRQ(DMA1_Channel3_IRQn);
+	/* DMA1_Channel5_IRQn interrupt configuration */
+	HAL_NVIC_SetPriority(DMA1_Channel5_IRQn, 0, 0);
+	HAL_NVIC_EnableIRQ(DMA1_Channel5_IRQn);
 
 }
 
@@ -22,6 +22,7 @@
 #include "stm32f1xx_it.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "timebase/timebase.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -55,7 +56,10 @@ void HAL_UART_IDLE_Callback(UART_HandleTypeDef *huart);
 /* USER CODE END 0 */
 
 /* External variables --------------------------------------------------------*/
+extern DMA_HandleTypeDef hdma_tim2_ch1;
 extern TIM_HandleTypeDef htim2;
+extern TIM_HandleTypeDef htim3;
+extern TIM_HandleTypeDef htim4;
 extern DMA_HandleTypeDef hdma_usart3_rx;
 extern DMA_HandleTypeDef hdma_usart3_tx;
 extern UART_HandleTypeDef huart1;
@@ -177,7 +181,7 @@ void SysTick_Handler(void) {
 	/* USER CODE END SysTick_IRQn 0 */
 	HAL_IncTick();
 	/* USER CODE BEGIN SysTick_IRQn 1 */
-
+	Timebase_Tick();
 	/* USER CODE END SysTick_IRQn 1 */
 }
 
@@ -214,6 +218,19 @@ void DMA1_Channel3_IRQHandler(void) {
 	/* USER CODE END DMA1_Channel3_IRQn 1 */
 }
 
+/**
+ * @brief This function handles DMA1 channel5 global interrupt.
+ */
+void DMA1_Channel5_IRQHandler(void) {
+	/* USER CODE BEGIN DMA1_Channel5_IRQn 0 */
+
+	/* USER CODE END DMA1_Channel5_IRQn 0 */
+	HAL_DMA_IRQHandler(&hdma_tim2_ch1);
+	/* USER CODE BEGIN DMA1_Channel5_IRQn 1 */
+
+	/* USER CODE END DMA1_Channel5_IRQn 1 */
+}
+
 /**
  * @brief This function handles TIM2 global interrupt.
  */
@@ -227,6 +244,32 @@ void TIM2_IRQHandler(void) {
 	/* USER CODE END TIM2_IRQn 1 */
 }
 
+/**
+ * @brief This function handles TIM3 global interrupt.
+ */
+void TIM3_IRQHandler(void) {
+	/* USER CODE BEGIN TIM3_IRQn 0 */
+
+	/* USER CODE END TIM3_IRQn 0 */
+	HAL_TIM_IRQHandler(&htim3);
+	/* USER CODE BEGIN TIM3_IRQn 1 */
+
+	/* USER CODE END TIM3_IRQn 1 */
+}
+
+/**
+ * @brief This function handles TIM4 global interrupt.
+ */
+void TIM4_IRQHandler(void) {
+	/* USER CODE BEGIN TIM4_IRQn 0 */
+
+	/* USER CODE END TIM4_IRQn 0 */
+	HAL_TIM_IRQHandler(&htim4);
+	/* USER CODE BEGIN TIM4_IRQn 1 */
+
+	/* USER CODE END TIM4_IRQn 1 */
+}
+
 /**
  * @brief This function handles USART1 global interrupt.
  */
@@ -38,6 +38,30 @@ extern void ShowProximityHysteresis(void);
 extern void ClearProximityHysteresis(void);
 extern void SaveProximityHysteresis(void);
 extern void LoadProximityHysteresis(void);
+extern void ShowProximityChannels(void);
+extern bool SetProximityChannel(int channel, const char *param, uint32_t value);
+extern void ShowProximityFilter(void);
+extern bool SetProximityFilterChain(int chain);
+extern bool SetProximityFilterParam(const char *param, uint32_t value);
+extern void ShowProximityTooth(void);
+extern bool SetProximityTooth(const char *action, uint32_t value);
+extern void ShowProximitySync(void);
+extern bool SetProximityMissingTeeth(uint32_t missing);
+extern void ShowProximityDirection(void);
+extern bool SetProximityDirection(bool enable);
+extern void ShowProximityPulse(void);
+extern bool SetProximityPulse(const char *action);
+extern void ShowProximityTotal(void);
+extern bool SetProximityTotal(const char *action, uint32_t value);
+extern void ShowProximityStats(void);
+extern void ShowProximityTrace(void);
+extern void DumpProximityTrace(void);
+extern bool SetProximityTrace(const char *param, uint32_t value);
+extern void ShowProximityHistory(void);
+extern bool DumpProximityHistory(uint32_t tier);
+extern void ResetProximityHistory(void);
+extern void ShowQuadEncoders(void);
+extern bool SetQuadEncoder(uint32_t timer, const char *action, uint32_t ppr, uint32_t diameter);
 
 void CommandHandler_Init(CommandHandler_t *handler, CommandHandler_Config_t *config) {
     if (!handler || !config) return;
@@ -109,6 +133,61 @@ void CommandHandler_Process(CommandHandler_t *handler) {
                         Process_ProximityCommands(handler, handler->cmd_buffer);
                         command_found = true;
                     }
+                    // Extra proximity channel commands
+                    else if (strncmp(handler->cmd_buffer, "ch ", 3) == 0 || strcmp(handler->cmd_buffer, "ch") == 0) {
+                        Process_ProximityCommands(handler, handler->cmd_buffer);
+                        command_found = true;
+                    }
+                    // RPM filter chain commands
+                    else if (strncmp(handler->cmd_buffer, "filter ", 7) == 0 || strcmp(handler->cmd_buffer, "filter") == 0) {
+                        Process_ProximityCommands(handler, handler->cmd_buffer);
+                        command_found = true;
+                    }
+                    // Per-tooth calibration commands
+                    else if (strncmp(handler->cmd_buffer, "tooth ", 6) == 0 || strcmp(handler->cmd_buffer, "tooth") == 0) {
+                        Process_ProximityCommands(handler, handler->cmd_buffer);
+                        command_found = true;
+                    }
+                    // Missing-tooth sync commands
+                    else if (strncmp(handler->cmd_buffer, "sync ", 5) == 0 || strcmp(handler->cmd_buffer, "sync") == 0) {
+                        Process_ProximityCommands(handler, handler->cmd_buffer);
+                        command_found = true;
+                    }
+                    // Direction sensor commands
+                    else if (strncmp(handler->cmd_buffer, "dir ", 4) == 0 || strcmp(handler->cmd_buffer, "dir") == 0) {
+                        Process_ProximityCommands(handler, handler->cmd_buffer);
+                        command_found = true;
+                    }
+                    // Pulse width commands
+                    else if (strncmp(handler->cmd_buffer, "pw ", 3) == 0 || strcmp(handler->cmd_buffer, "pw") == 0) {
+                        Process_ProximityCommands(handler, handler->cmd_buffer);
+                        command_found = true;
+                    }
+                    // Pulse totalizer commands
+                    else if (strncmp(handler->cmd_buffer, "total ", 6) == 0 || strcmp(handler->cmd_buffer, "total") == 0) {
+                        Process_ProximityCommands(handler, handler->cmd_buffer);
+                        command_found = true;
+                    }
+                    // Speed statistics
+                    else if (strcmp(handler->cmd_buffer, "stats") == 0) {
+                        Process_ProximityCommands(handler, handler->cmd_buffer);
+                        command_found = true;
+                    }
+                    // Raw trace commands
+                    else if (strncmp(handler->cmd_buffer, "trace ", 6) == 0 || strcmp(handler->cmd_buffer, "trace") == 0) {
+                        Process_ProximityCommands(handler, handler->cmd_buffer);
+                        command_found = true;
+                    }
+                    // Speed history commands
+                    else if (strncmp(handler->cmd_buffer, "hist ", 5) == 0 || strcmp(handler->cmd_buffer, "hist") == 0) {
+                        Process_ProximityCommands(handler, handler->cmd_buffer);
+                        command_found = true;
+                    }
+                    // Quadrature encoder commands
+                    else if (strncmp(handler->cmd_buffer, "qenc ", 5) == 0 || strcmp(handler->cmd_buffer, "qenc") == 0) {
+                        Process_ProximityCommands(handler, handler->cmd_buffer);
+                        command_found = true;
+                    }
                     // Proximity status command
                     else if (strcmp(handler->cmd_buffer, "proximity_setting") == 0) {
                         Process_ProximityCommands(handler, handler->cmd_buffer);
@@ -1093,6 +1172,62 @@ static void Show_Help(void) {
     printf("  hyst save/load   - Save/Load to Flash\r\n");
     printf("PROXIMITY STATUS:\r\n");
     printf("  proximity_setting - Show proximity counter configuration\r\n");
+    printf("PROXIMITY CHANNELS (TIM2 CH2-CH4):\r\n");
+    printf("  ch               - Show all channels\r\n");
+    printf("  ch <2-4> on|off  - Enable/disable a channel\r\n");
+    printf("  ch <2-4> ppr|dia|timeout <v> - Set PPR, diameter (mm), timeout (ms)\r\n");
+    printf("RPM FILTER:\r\n");
+    printf("  filter           - Show filter chains\r\n");
+    printf("  filter <n>       - Select chain (0=hyst ... 5=none)\r\n");
+    printf("  filter alpha <n> - EMA weight in 1/256 (1-256)\r\n");
+    printf("  filter slew <n>  - Max RPM change per sample (0=off)\r\n");
+    printf("  filter tracker 0|1 - Alpha-beta speed/acceleration tracker\r\n");
+    printf("  filter talpha|tbeta <n> - Tracker gains in 1/256\r\n");
+    printf("  filter accel <n> - Max RPM/s for glitch rejection (0=off)\r\n");
+    printf("  filter irq <hz>  - Capture rate ceiling, ICPSC/ICF adapt (0=every edge)\r\n");
+    printf("  filter method 0|1 - Speed method: 0=T per period, 1=M/T gate (saved)\r\n");
+    printf("  filter gate <ms> - M/T gate time, 10-10000 (saved)\r\n");
+    printf("TOOTH CALIBRATION (CH1):\r\n");
+    printf("  tooth            - Show state and correction table\r\n");
+    printf("  tooth learn [n]  - Learn tooth spacing over n revolutions (steady speed)\r\n");
+    printf("  tooth save/load  - Save/Load table to Flash\r\n");
+    printf("  tooth off        - Stop correcting, back to M/T\r\n");
+    printf("MISSING-TOOTH SYNC (CH1):\r\n");
+    printf("  sync             - Show sync state, angle, revolutions, losses\r\n");
+    printf("  sync gap <n>     - Teeth missing at the reference gap (0=off)\r\n");
+    printf("DIRECTION (CH1 + sensor on CH2):\r\n");
+    printf("  dir              - Show direction, signed RPM, position\r\n");
+    printf("  dir on|off       - Use CH2 as the phase-shifted direction sensor\r\n");
+    printf("PULSE WIDTH (CH1 falling edge on CH2):\r\n");
+    printf("  pw               - Show high time, period, duty and drift\r\n");
+    printf("  pw on|both|off   - Measure duty (both = 2 speed samples per pulse)\r\n");
+    printf("  pw ref           - Store current average duty as reference\r\n");
+    printf("PULSE TOTALIZER (TIM4, PB6 in parallel with PA0):\r\n");
+    printf("  total            - Show total, preset/target and reached flags\r\n");
+    printf("  total reset      - Clear total and flags\r\n");
+    printf("  total preset <n> - Early-warning level in pulses (0=off)\r\n");
+    printf("  total target <n> - Batch level in pulses (0=off)\r\n");
+    printf("SPEED STATISTICS (CH1):\r\n");
+    printf("  stats            - Mean/stddev/min/max of the last 1 s, 10 s, 60 s windows\r\n");
+    printf("SPEED HISTORY (CH1, 100 ms / 1 s / 1 min tiers):\r\n");
+    printf("  hist             - Show fill level and newest entry of each tier\r\n");
+    printf("  hist 0|1|2       - Print a tier, newest first (mean/min/max RPM)\r\n");
+    printf("  hist reset       - Clear all tiers\r\n");
+    printf("QUADRATURE ENCODERS (TIM3 PA6/PA7, TIM4 PB6/PB7):\r\n");
+    printf("  qenc             - Show every encoder timer\r\n");
+    printf("  qenc <3|4> on [ppr] [dia_mm] - Count an encoder on that timer (TIM4 stops the totalizer)\r\n");
+    printf("  qenc <3|4> off   - Release the timer\r\n");
+    printf("  qenc <3|4> reset - Zero pulses and length\r\n");
+    printf("  qenc <3|4> lowspeed <n> - Time edges (1/T) below n counts per window (0=off)\r\n");
+    printf("  qenc <3|4> filter <n> - RPM filter chain of that encoder (1=ema default, 5=none)\r\n");
+    printf("RAW TRACE (CH1 capture periods):\r\n");
+    printf("  trace            - Show recorder state, window and triggers\r\n");
+    printf("  trace trigger    - Freeze now (after the post periods)\r\n");
+    printf("  trace arm        - Drop the frozen block, record again\r\n");
+    printf("  trace dump       - Print the frozen block (us, index vs trigger)\r\n");
+    printf("  trace pre|post <n> - Periods before/after the trigger (sum < 256)\r\n");
+    printf("  trace over <rpm> - Overspeed trigger (0=off)\r\n");
+    printf("  trace glitch on|off - Trigger on a rejected glitch edge\r\n");
 }
 
 /**
@@ -1111,6 +1246,175 @@ static void Process_ProximityCommands(CommandHandler_t *handler, const char* cmd
                (unsigned long)*handler->config.timeout);
       
         
+    } else if (strcmp(cmd, "ch") == 0) {
+        ShowProximityChannels();
+        
+    } else if (strncmp(cmd, "ch ", 3) == 0) {
+        // Parse: ch <channel> on|off  or  ch <channel> ppr|dia|timeout <value>
+        int channel;
+        char param[8] = {0};
+        unsigned long value = 0;
+        int fields = sscanf(cmd + 3, "%d %7s %lu", &channel, param, &value);
+        
+        if (fields >= 2 && SetProximityChannel(channel, param, (uint32_t)value)) {
+            printf("✅ CH%d %s %lu applied and saved\r\n", channel, param, value);
+        } else {
+            printf("❌ Invalid channel/value or save failed. Use: ch <2-4> on|off|ppr <n>|dia <mm>|timeout <ms>\r\n");
+        }
+        
+    } else if (strcmp(cmd, "filter") == 0) {
+        ShowProximityFilter();
+        
+    } else if (strncmp(cmd, "filter ", 7) == 0) {
+        // Parse: filter <chain>  or  filter alpha|slew <value>
+        char param[8] = {0};
+        unsigned long value = 0;
+        bool ok = false;
+        
+        if (sscanf(cmd + 7, "%7s %lu", param, &value) == 2) {
+            ok = SetProximityFilterParam(param, (uint32_t)value);
+        } else if (sscanf(cmd + 7, "%lu", &value) == 1) {
+            ok = value <= 0xFFFFUL && SetProximityFilterChain((int)value);
+        }
+        
+        if (ok) {
+            printf("✅ Filter updated\r\n");
+            ShowProximityFilter();
+        } else {
+            printf("❌ Invalid value. Use: filter <chain> | filter alpha|slew|tracker|talpha|tbeta|accel|irq|method|gate <n>\r\n");
+        }
+        
+    } else if (strcmp(cmd, "tooth") == 0) {
+        ShowProximityTooth();
+        
+    } else if (strncmp(cmd, "tooth ", 6) == 0) {
+        // Parse: tooth learn [revs]  or  tooth save|load|off
+        char action[8] = {0};
+        unsigned long value = 0;
+        
+        if (sscanf(cmd + 6, "%7s %lu", action, &value) >= 1 && SetProximityTooth(action, (uint32_t)value)) {
+            printf("✅ Tooth %s done\r\n", action);
+            ShowProximityTooth();
+        } else {
+            printf("❌ Failed. Use: tooth learn [revs] | tooth save | tooth load | tooth off (PPR 2-64)\r\n");
+        }
+        
+    } else if (strcmp(cmd, "sync") == 0) {
+        ShowProximitySync();
+        
+    } else if (strncmp(cmd, "sync ", 5) == 0) {
+        // Parse: sync gap <teeth>
+        unsigned long value = 0;
+        
+        if (sscanf(cmd + 5, "gap %lu", &value) == 1 && SetProximityMissingTeeth((uint32_t)value)) {
+            printf("✅ Gap set to %lu teeth and saved\r\n", value);
+            ShowProximitySync();
+        } else {
+            printf("❌ Invalid value or save failed. Use: sync gap <0-3> (PPR >= gap + 3)\r\n");
+        }
+        
+    } else if (strcmp(cmd, "dir") == 0) {
+        ShowProximityDirection();
+        
+    } else if (strcmp(cmd, "dir on") == 0 || strcmp(cmd, "dir off") == 0) {
+        if (SetProximityDirection(strcmp(cmd, "dir on") == 0)) {
+            printf("✅ Direction sensor updated and saved\r\n");
+            ShowProximityDirection();
+        } else {
+            printf("❌ Failed. Turn CH2 off first (ch 2 off)\r\n");
+        }
+        
+    } else if (strcmp(cmd, "pw") == 0) {
+        ShowProximityPulse();
+        
+    } else if (strncmp(cmd, "pw ", 3) == 0) {
+        if (SetProximityPulse(cmd + 3)) {
+            printf("✅ Pulse width updated and saved\r\n");
+            ShowProximityPulse();
+        } else {
+            printf("❌ Failed. Use: pw on|both|off|ref (CH2 off and dir off first)\r\n");
+        }
+        
+    } else if (strcmp(cmd, "total") == 0) {
+        ShowProximityTotal();
+        
+    } else if (strncmp(cmd, "total ", 6) == 0) {
+        // Parse: total reset  or  total preset|target <pulses>
+        char action[8] = {0};
+        unsigned long value = 0;
+        int fields = sscanf(cmd + 6, "%7s %lu", action, &value);
+        
+        if ((fields == 2 || (fields == 1 && strcmp(action, "reset") == 0)) &&
+            SetProximityTotal(action, (uint32_t)value)) {
+            printf("✅ Total %s done\r\n", action);
+            ShowProximityTotal();
+        } else {
+            printf("❌ Failed. Use: total reset | total preset <n> | total target <n>\r\n");
+        }
+        
+    } else if (strcmp(cmd, "stats") == 0) {
+        ShowProximityStats();
+        
+    } else if (strcmp(cmd, "hist") == 0) {
+        ShowProximityHistory();
+        
+    } else if (strcmp(cmd, "hist reset") == 0) {
+        ResetProximityHistory();
+        printf("✅ History cleared\r\n");
+        
+    } else if (strncmp(cmd, "hist ", 5) == 0) {
+        unsigned long tier;
+        if (sscanf(cmd + 5, "%lu", &tier) != 1 || !DumpProximityHistory((uint32_t)tier)) {
+            printf("❌ Failed. Use: hist | hist 0|1|2 | hist reset\r\n");
+        }
+        
+    } else if (strcmp(cmd, "qenc") == 0) {
+        ShowQuadEncoders();
+        
+    } else if (strncmp(cmd, "qenc ", 5) == 0) {
+        // Parse: qenc <timer> on [ppr] [dia_mm]  or  qenc <timer> off|reset  or  qenc <timer> lowspeed|filter <n>
+        unsigned long timer = 0, ppr = 0, dia = 0;
+        char action[12] = {0};
+        int fields = sscanf(cmd + 5, "%lu %11s %lu %lu", &timer, action, &ppr, &dia);
+        
+        bool needs_value = (strcmp(action, "lowspeed") == 0 || strcmp(action, "filter") == 0);
+        if (fields >= 2 && (!needs_value || fields >= 3) &&
+            SetQuadEncoder((uint32_t)timer, action, (uint32_t)ppr, (uint32_t)dia)) {
+            printf("✅ Encoder TIM%lu %s done\r\n", timer, action);
+            ShowQuadEncoders();
+        } else {
+            printf("❌ Failed. Use: qenc <3|4> on [ppr] [dia_mm] | qenc <3|4> off|reset | qenc <3|4> lowspeed <0..1000> | qenc <3|4> filter <0-5>\r\n");
+        }
+        
+    } else if (strcmp(cmd, "trace") == 0) {
+        ShowProximityTrace();
+        
+    } else if (strcmp(cmd, "trace dump") == 0) {
+        DumpProximityTrace();
+        
+    } else if (strncmp(cmd, "trace ", 6) == 0) {
+        // Parse: trace arm|trigger  or  trace pre|post|over <n>  or  trace glitch on|off
+        char param[8] = {0};
+        char arg[8] = {0};
+        unsigned long value = 0;
+        int fields = sscanf(cmd + 6, "%7s %7s", param, arg);
+        
+        if (fields == 2 && strcmp(param, "glitch") == 0) {
+            value = (strcmp(arg, "on") == 0) ? 1UL : 0UL;
+            fields = (strcmp(arg, "on") == 0 || strcmp(arg, "off") == 0) ? 2 : 0;
+        } else if (fields == 2) {
+            fields = (sscanf(arg, "%lu", &value) == 1) ? 2 : 0;
+        } else if (fields == 1 && strcmp(param, "arm") != 0 && strcmp(param, "trigger") != 0) {
+            fields = 0;
+        }
+        
+        if (fields > 0 && SetProximityTrace(param, (uint32_t)value)) {
+            printf("✅ Trace %s done\r\n", param);
+            ShowProximityTrace();
+        } else {
+            printf("❌ Failed. Use: trace arm|trigger | trace pre|post|over <n> | trace glitch on|off\r\n");
+        }
+        
     } else if (strncmp(cmd, "hyst set ", 9) == 0) {
         // Parse: hyst set <index> <rpm_threshold> <hysteresis>
         const char* params = cmd + 9;
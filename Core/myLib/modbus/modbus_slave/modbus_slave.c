@@ -148,6 +148,9 @@ void modbus_slave_handle_frame(const uint8_t *frame, uint16_t len) {
 				if (count == 0 || (uint32_t)addr + count > slave_cfg.input_register_count) {
 					resp_pdu_len = build_exception_pdu(resp_pdu, fn, 0x02); break;
 				}
+				if ((uint32_t)2 + count * 2U > sizeof(resp_pdu)) {
+					resp_pdu_len = build_exception_pdu(resp_pdu, fn, 0x03); break;
+				}
 				if (slave_cfg.on_read_input_registers) slave_cfg.on_read_input_registers(addr, count);
 				resp_pdu[0] = fn;
 				resp_pdu[1] = (uint8_t)(count * 2);
@@ -258,7 +261,7 @@ void modbus_slave_handle_frame(const uint8_t *frame, uint16_t len) {
 			return;
 		
 		// Validate buffer size to prevent overflow
-		if (5 + count * 2 > sizeof(modbus_tx_buffer))
+		if (5U + count * 2U > sizeof(modbus_tx_buffer))
 			return;
 		
 		if (slave_cfg.on_read_holding_registers) {
@@ -290,6 +293,10 @@ void modbus_slave_handle_frame(const uint8_t *frame, uint16_t len) {
 		if ((addr + quantity) > slave_cfg.input_register_count)
 			return;
 
+		// Validate buffer size to prevent overflow
+		if (5U + quantity * 2U > sizeof(response))
+			return;
+
 		byte_count = quantity * 2;
 		response[0] = slave_cfg.id;
 		response[1] = func;
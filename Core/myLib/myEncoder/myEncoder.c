@@ -1,29 +1,273 @@
 #include "myEncoder.h"
 
-// Global encoder instance that can be accessed by interrupt handlers
-static Encoder_t* g_encoder_instance = NULL;
-
-// Register encoder instance for interrupt handling
-void Encoder_RegisterInstance(Encoder_t* enc) {
-    g_encoder_instance = enc;
-}
-
-// Timer overflow interrupt handler - call this from stm32f1xx_it.c
-void Encoder_HandleTimerOverflow(void) {
-    if (g_encoder_instance && g_encoder_instance->htim) {
-        if (__HAL_TIM_GET_FLAG(g_encoder_instance->htim, TIM_FLAG_UPDATE)) {
-            __HAL_TIM_CLEAR_IT(g_encoder_instance->htim, TIM_IT_UPDATE);
-            
-            // Handle overflow based on direction
-            uint16_t counter = __HAL_TIM_GET_COUNTER(g_encoder_instance->htim);
-            if (counter < 32768) {
-                // Forward overflow
-                g_encoder_instance->total_pulse += 65536;
-            } else {
-                // Reverse overflow
-                g_encoder_instance->total_pulse -= 65536;
-            }
-        }
+// Stop counting and drop the update and edge interrupts
+void Encoder_Stop(Encoder_t* enc) {
+    if (!enc || !enc->htim) return;
+
+    __HAL_TIM_DISABLE_IT(enc->htim, TIM_IT_UPDATE | TIM_IT_CC1);
+    enc->edge_irq = 0;
+    HAL_TIM_Encoder_Stop(enc->htim, TIM_CHANNEL_ALL);
+}
+
+// Direction of the wrap behind an update event, true = forward (ARR -> 0).
+// DIR is not latched at the update: a reversal before it is read already shows
+// the new direction. CNT stays on the side of the wrap it crossed to, so the
+// two are compared and, when they disagree, a CNT read taken since the last
+// wrap breaks the tie.
+static bool Encoder_WrapForward(const Encoder_t* enc, bool down, uint16_t counter, bool* mismatch) {
+    bool dir_forward = !down;
+    bool side_forward = (counter < 32768);
+
+    *mismatch = (dir_forward != side_forward);
+    if (!*mismatch) return dir_forward;
+
+    // Below the last seen value means the count went up through ARR
+    if (enc->seen_seq == enc->seq && counter != enc->seen_counter) {
+        return counter < enc->seen_counter;
+    }
+    return side_forward;
+}
+
+// Raw position: overflow total plus CNT, consistent without disabling interrupts
+static int64_t Encoder_ReadRaw(Encoder_t* enc) {
+    uint32_t seq;
+    int64_t total;
+    uint16_t counter;
+    bool pending;
+    bool down;
+    bool mismatch;
+
+    // Seqlock: retry if the overflow ISR ran while sampling, or the counter
+    // wrapped between the UIF read and the CNT read
+    do {
+        seq = enc->seq;
+        total = enc->total_pulse;
+        pending = __HAL_TIM_GET_FLAG(enc->htim, TIM_FLAG_UPDATE);
+        down = __HAL_TIM_IS_TIM_COUNTING_DOWN(enc->htim);
+        counter = (uint16_t)__HAL_TIM_GET_COUNTER(enc->htim);
+    } while ((seq & 1U) || seq != enc->seq ||
+             pending != (bool)__HAL_TIM_GET_FLAG(enc->htim, TIM_FLAG_UPDATE));
+
+    if (pending) {
+        // A wrap still pending is not in total yet; same direction rule as the ISR
+        total += Encoder_WrapForward(enc, down, counter, &mismatch) ? 65536 : -65536;
+    } else {
+        // Counter history for the ISR; seq last, so an ISR in between voids it
+        enc->seen_counter = counter;
+        enc->seen_seq = seq;
+    }
+    return total + (int64_t)counter;
+}
+
+// Lấy tổng xung encoder hiện tại
+int64_t Encoder_GetPulse(Encoder_t* enc) {
+    if (!enc || !enc->htim) return 0;
+    return Encoder_ReadRaw(enc) - enc->origin;
+}
+
+// Zero the pulse count, length and RPM
+void Encoder_Reset(Encoder_t* enc) {
+    if (!enc || !enc->htim) return;
+
+    // Move the origin instead of writing CNT/total under the ISR
+    enc->origin = Encoder_ReadRaw(enc);
+    enc->last_total_pulse = 0;
+    enc->last_time_us = Timebase_GetMicros();
+    enc->current_length = 0.0f;
+    enc->current_rpm = 0.0f;
+    RpmFilter_Reset(&enc->filter);
+    RpmFilter_Process(&enc->filter, 0, NULL, 0);
+}
+
+// Timer overflow of one encoder - HAL_TIM_IRQHandler has already cleared UIF
+void Encoder_HandleOverflow(Encoder_t* enc) {
+    if (!enc || !enc->htim) return;
+
+    // DIR first, as close to the update event as the ISR gets
+    bool down = __HAL_TIM_IS_TIM_COUNTING_DOWN(enc->htim);
+    uint16_t counter = __HAL_TIM_GET_COUNTER(enc->htim);
+    bool mismatch;
+    int64_t step = Encoder_WrapForward(enc, down, counter, &mismatch) ? 65536 : -65536;
+    if (mismatch) {
+        enc->dir_mismatches++;
+    }
+
+    // Readers retry while seq is odd or has moved
+    enc->seq++;
+    enc->total_pulse += step;
+    enc->seq++;
+    enc->seen_counter = counter;
+    enc->seen_seq = enc->seq;
+}
+
+// Edge interrupt on, pair restarted
+static void Encoder_EdgeStart(Encoder_t* enc) {
+    enc->edge_cycles = 0;
+    enc->edge_period = 0;
+    enc->edge_irq = 1;
+    __HAL_TIM_CLEAR_FLAG(enc->htim, TIM_FLAG_CC1 | TIM_FLAG_CC1OF);
+    __HAL_TIM_ENABLE_IT(enc->htim, TIM_IT_CC1);
+}
+
+static void Encoder_EdgeStop(Encoder_t* enc) {
+    __HAL_TIM_DISABLE_IT(enc->htim, TIM_IT_CC1);
+    enc->edge_irq = 0;
+}
+
+// Window counts below which edges are timed, 0 = always count the window
+void Encoder_SetLowSpeed(Encoder_t* enc, uint16_t counts) {
+    if (!enc || !enc->htim) return;
+
+    Encoder_EdgeStop(enc);
+    enc->lowspeed_counts = counts;
+    // At the threshold an A edge comes every 4 counts; 4x faster is the window's job
+    enc->edge_min_period = counts ? (uint64_t)(SystemCoreClock / 1000U) * enc->update_ms / counts : 0;
+}
+
+// Speed filter chain, the state starts over with the next window
+bool Encoder_SetFilterChain(Encoder_t* enc, RpmFilterChain_t chain) {
+    if (!enc || !enc->htim) return false;
+    return RpmFilter_SetChain(&enc->filter, chain);
+}
+
+// Rising edge of channel A - call from HAL_TIM_IC_CaptureCallback
+void Encoder_HandleCapture(Encoder_t* enc) {
+    if (!enc || !enc->htim || !enc->edge_irq) return;
+
+    // CCR1 holds the count at the edge; the time is ISR latency late, the same on every edge
+    uint64_t now = Timebase_GetCycles();
+    uint16_t pos = (uint16_t)HAL_TIM_ReadCapturedValue(enc->htim, TIM_CHANNEL_1);
+    bool paired = (enc->edge_cycles != 0U);
+    uint64_t period = now - enc->edge_cycles;
+
+    enc->edge_seq++;
+    if (paired) {
+        enc->edge_counts = (int16_t)(uint16_t)(pos - enc->edge_pos);  // Signed, across CNT wraps
+        enc->edge_period = period;
+    }
+    enc->edge_pos = pos;
+    enc->edge_cycles = now;
+    enc->edge_seq++;
+
+    // Too fast to need timing: stop interrupting until the window is short of counts again
+    if (paired && period < enc->edge_min_period) {
+        Encoder_EdgeStop(enc);
+    }
+}
+
+// 1/T speed from the last two channel A edges when the window is short of counts
+bool Encoder_LowSpeedRPM(Encoder_t* enc, int64_t window_counts, float* rpm) {
+    if (!enc || !enc->htim || !rpm || enc->lowspeed_counts == 0U) return false;
+
+    if (window_counts >= enc->lowspeed_counts || window_counts <= -(int64_t)enc->lowspeed_counts) {
+        if (enc->edge_irq) Encoder_EdgeStop(enc);
+        return false;
+    }
+    if (!enc->edge_irq) {
+        // This window still uses its count; edges are timed from now on
+        Encoder_EdgeStart(enc);
+        return false;
+    }
+
+    uint32_t seq;
+    int32_t counts;
+    uint64_t period;
+    uint64_t last;
+    do {
+        seq = enc->edge_seq;
+        counts = enc->edge_counts;
+        period = enc->edge_period;
+        last = enc->edge_cycles;
+    } while ((seq & 1U) || seq != enc->edge_seq);
+    if (period == 0U) return false;
+
+    uint64_t since = Timebase_GetCycles() - last;
+    if (since > (uint64_t)(SystemCoreClock / 1000U) * ENCODER_EDGE_STOP_MS) {
+        *rpm = 0.0f;
+        return true;
+    }
+    // Next edge overdue: the shaft is at most this fast now
+    if (since > period) period = since;
+
+    *rpm = (float)counts * 60.0f * (float)SystemCoreClock / ((float)period * (float)enc->ppr);
+    return true;
+}
+
+// Modbus block: pulses (int64), RPM x100 (int32), length mm (int32), low word first
+void Encoder_PutRegisters(Encoder_t* enc, uint16_t* block) {
+    if (!enc || !block) return;
+
+    uint64_t pulses = (uint64_t)Encoder_GetPulse(enc);
+    int32_t rpm = (int32_t)(enc->current_rpm * 100.0f);
+    int32_t length_mm = (int32_t)(enc->current_length * 1000.0f);
+
+    for (uint32_t i = 0; i < 4U; i++) {
+        block[i] = (uint16_t)(pulses >> (16U * i));
+    }
+    block[4] = (uint16_t)((uint32_t)rpm & 0xFFFFU);
+    block[5] = (uint16_t)((uint32_t)rpm >> 16);
+    block[6] = (uint16_t)((uint32_t)length_mm & 0xFFFFU);
+    block[7] = (uint16_t)((uint32_t)length_mm >> 16);
+}
+
+// Registry slot of a timer (TIM1..TIM4 -> 0..3), -1 if it has none
+int32_t Encoder_TimerIndex(const TIM_TypeDef* instance) {
+    if (instance == TIM1) return 0;
+    if (instance == TIM2) return 1;
+    if (instance == TIM3) return 2;
+    if (instance == TIM4) return 3;
+    return -1;
+}
+
+// Empty the instance table
+void EncoderRegistry_Init(EncoderRegistry_t* registry) {
+    if (!registry) return;
+    memset(registry, 0, sizeof(EncoderRegistry_t));
+}
+
+// Add an initialized encoder; fails if its timer has no slot or is taken
+bool EncoderRegistry_Add(EncoderRegistry_t* registry, Encoder_t* enc) {
+    if (!registry || !enc || !enc->htim) return false;
+
+    int32_t index = Encoder_TimerIndex(enc->htim->Instance);
+    if (index < 0 || (registry->by_timer[index] && registry->by_timer[index] != enc)) {
+        return false;
+    }
+    registry->by_timer[index] = enc;  // Single word store, safe against the update IRQ
+    return true;
+}
+
+// Drop an encoder from its slot
+void EncoderRegistry_Remove(EncoderRegistry_t* registry, Encoder_t* enc) {
+    if (!registry || !enc || !enc->htim) return;
+
+    int32_t index = Encoder_TimerIndex(enc->htim->Instance);
+    if (index >= 0 && registry->by_timer[index] == enc) {
+        registry->by_timer[index] = NULL;
+    }
+}
+
+// Encoder counting on a timer, NULL if none
+Encoder_t* EncoderRegistry_Find(const EncoderRegistry_t* registry, const TIM_HandleTypeDef* htim) {
+    if (!registry || !htim) return NULL;
+
+    int32_t index = Encoder_TimerIndex(htim->Instance);
+    return (index >= 0) ? registry->by_timer[index] : NULL;
+}
+
+// Timer overflow interrupt - call this from HAL_TIM_PeriodElapsedCallback
+void EncoderRegistry_HandleOverflow(EncoderRegistry_t* registry, TIM_HandleTypeDef* htim) {
+    Encoder_t* enc = EncoderRegistry_Find(registry, htim);
+    if (enc && enc->htim == htim) {
+        Encoder_HandleOverflow(enc);
+    }
+}
+
+// Channel A edge interrupt - call this from HAL_TIM_IC_CaptureCallback
+void EncoderRegistry_HandleCapture(EncoderRegistry_t* registry, TIM_HandleTypeDef* htim) {
+    Encoder_t* enc = EncoderRegistry_Find(registry, htim);
+    if (enc && enc->htim == htim && htim->Channel == HAL_TIM_ACTIVE_CHANNEL_1) {
+        Encoder_HandleCapture(enc);
     }
 }
 
@@ -3,27 +3,55 @@
 
 #include "stm32f1xx_hal.h"
 #include "measurement_mode.h"
+#include "timebase/timebase.h"
+#include "rpm_filter.h"
 #include <stdint.h>
+#include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #define M_PI 3.14159265f
+#define ENCODER_TIMER_COUNT 4U      // TIM1..TIM4 on the F103, registry slot = timer number - 1
+#define ENCODER_REG_BLOCK   8U      // Modbus registers per encoder (see Encoder_PutRegisters)
+#define ENCODER_LOWSPEED_DEFAULT 16U  // Window counts below which speed comes from edge timing (1/T)
+#define ENCODER_EDGE_STOP_MS 1000U    // No channel A edge for this long reads as standstill
 
 typedef struct {
     TIM_HandleTypeDef* htim;
     int16_t ppr;                 // Pulse per revolution (đã nhân 4 nếu dùng encoder x4)
     float wheel_diameter_m;     // Đường kính bánh xe (m)
     uint16_t update_ms;         // Chu kỳ lấy mẫu tính RPM (ms)
-    int64_t total_pulse;        // Tổng số xung encoder (gồm cả phần tràn)
-    uint32_t last_time_ms;      // Lần đo trước đó
+    volatile int64_t total_pulse; // Tổng số xung encoder (gồm cả phần tràn), chỉ ISR ghi
+    volatile uint32_t seq;      // Odd while the overflow ISR updates total_pulse
+    int64_t origin;             // Raw position at the last reset
+    volatile uint16_t seen_counter;   // CNT at the last read with no wrap pending
+    volatile uint32_t seen_seq;       // seq when seen_counter was taken
+    volatile uint32_t dir_mismatches; // Overflows where DIR disagreed with seen_counter
+
+    // Low speed (1/T): CC1 latches CNT at each rising edge of A, the capture ISR stamps the time
+    uint16_t lowspeed_counts;         // Window counts below which 1/T is used, 0 = off
+    uint64_t edge_min_period;         // Edges closer than this (cycles) turn the interrupt off
+    volatile uint8_t edge_irq;        // CC1 interrupt on
+    volatile uint32_t edge_seq;       // Odd while the capture ISR updates the edge pair
+    volatile uint16_t edge_pos;       // CCR1 at the last edge
+    volatile int32_t edge_counts;     // Counts between the last two edges
+    volatile uint64_t edge_cycles;    // Timebase_GetCycles() at the last edge, 0 = none yet
+    volatile uint64_t edge_period;    // Cycles between the last two edges, 0 = no pair yet
+    uint64_t last_time_us;      // Lần đo trước đó (Timebase_GetMicros)
     int64_t last_total_pulse;   // Tổng xung lần đo trước
     
     // Cached values for performance
     float current_length;       // Current length in meters
     float current_rpm;          // Current RPM value
+    RpmFilter_t filter;         // Speed smoothing, RPM_FILTER_CHAIN_EMA unless changed
     // uint32_t last_rpm_update;   // No longer needed - timing handled in GetRPM
 } Encoder_t;
 
+// Encoders keyed by timer; the owner keeps it and passes it to the timer callback
+typedef struct {
+    Encoder_t* by_timer[ENCODER_TIMER_COUNT];
+} EncoderRegistry_t;
+
 // Timer initialization function - call this before Encoder_Init
 HAL_StatusTypeDef Encoder_InitTimer(TIM_HandleTypeDef* htim);
 
@@ -36,11 +64,25 @@ static inline void Encoder_Init(Encoder_t* enc, TIM_HandleTypeDef* htim, uint16_
     enc->wheel_diameter_m = diameter_m;
     enc->update_ms = update_ms;
     enc->total_pulse = 0;
+    enc->seq = 0;
+    enc->origin = 0;
+    enc->seen_counter = 0;
+    enc->seen_seq = 0;
+    enc->dir_mismatches = 0;
+    enc->lowspeed_counts = 0;
+    enc->edge_min_period = 0;
+    enc->edge_irq = 0;
+    enc->edge_seq = 0;
+    enc->edge_cycles = 0;
+    enc->edge_period = 0;
     enc->last_total_pulse = 0;
-    enc->last_time_ms = HAL_GetTick();
+    Timebase_Init();
+    enc->last_time_us = Timebase_GetMicros();
     enc->current_length = 0.0f;
     enc->current_rpm = 0.0f;
     // enc->last_rpm_update = 0; // No longer needed
+    RpmFilter_Init(&enc->filter, RPM_FILTER_CHAIN_EMA);
+    RpmFilter_Process(&enc->filter, 0, NULL, 0);  // Start from rest, like the old EMA
 
     HAL_TIM_Encoder_Start(htim, TIM_CHANNEL_ALL);
     __HAL_TIM_SET_COUNTER(htim, 0);
@@ -48,46 +90,54 @@ static inline void Encoder_Init(Encoder_t* enc, TIM_HandleTypeDef* htim, uint16_
     // Kích hoạt ngắt tràn timer
     __HAL_TIM_CLEAR_IT(htim, TIM_IT_UPDATE);
     __HAL_TIM_ENABLE_IT(htim, TIM_IT_UPDATE);
-
-    if (htim->Instance == TIM2) {
-        HAL_NVIC_SetPriority(TIM2_IRQn, 1, 0);
-        HAL_NVIC_EnableIRQ(TIM2_IRQn);
-    } else if (htim->Instance == TIM3) {
-        HAL_NVIC_SetPriority(TIM3_IRQn, 1, 0);
-        HAL_NVIC_EnableIRQ(TIM3_IRQn);
-    }
+    // The update IRQ is enabled by HAL_TIM_Encoder_MspInit of that timer
 }
 
+// Lấy tổng xung encoder hiện tại - consistent 64-bit snapshot, never masks interrupts.
+// Call from the main loop or an interrupt below the timer update priority,
+// from one context only: the read also leaves the counter history for the ISR.
+int64_t Encoder_GetPulse(Encoder_t* enc);
+
 // Full encoder initialization with timer configuration
 HAL_StatusTypeDef Encoder_InitFull(Encoder_t* enc, TIM_HandleTypeDef* htim, uint16_t ppr, float diameter_m, uint16_t update_ms);
 
+// 1/T speed from the last two channel A edges when the window holds fewer than
+// lowspeed_counts counts; false leaves the window estimate in place.
+bool Encoder_LowSpeedRPM(Encoder_t* enc, int64_t window_counts, float* rpm);
+
 // Gọi hàm này định kỳ để lấy RPM - FIXED VERSION
 static inline float Encoder_GetRPM(Encoder_t* enc) {
     if (!enc || !enc->htim) return 0.0f;
     
-    uint32_t now = HAL_GetTick();
-    uint32_t dt = now - enc->last_time_ms;
+    // dt in microseconds: the window no longer carries a 1 ms tick error
+    uint64_t now = Timebase_GetMicros();
+    uint64_t dt = now - enc->last_time_us;
     
     // Chỉ tính RPM khi đủ thời gian để có độ chính xác
-    if (dt < enc->update_ms) {
+    if (dt < (uint64_t)enc->update_ms * 1000U) {
         return enc->current_rpm; // Trả về giá trị đã cache
     }
 
-    int64_t pulse_now = enc->total_pulse + (int64_t)__HAL_TIM_GET_COUNTER(enc->htim);
+    int64_t pulse_now = Encoder_GetPulse(enc);
     int64_t delta = pulse_now - enc->last_total_pulse;
 
     enc->last_total_pulse = pulse_now;
-    enc->last_time_ms = now;
+    enc->last_time_us = now;
 
     // Tính RPM với thời gian thực tế đã đo
     float rev = (float)delta / (float)enc->ppr;
-    float minutes = (float)dt / 60000.0f;
+    float minutes = (float)dt / 60000000.0f;
     
     if (minutes > 0) {
         float new_rpm = rev / minutes;
+        // Crawl speed: 0 or 1 count per window, time the edges instead
+        Encoder_LowSpeedRPM(enc, delta, &new_rpm);
         
-        // Simple moving average filter để làm mượt giá trị
-        enc->current_rpm = (enc->current_rpm * 0.7f) + (new_rpm * 0.3f);
+        // Làm mượt bằng chuỗi lọc fixed-point (mặc định EMA alpha 77/256 ~ 0.3)
+        float rpm_q8 = new_rpm * (float)RPM_FILTER_Q_ONE;
+        rpm_q8 = (rpm_q8 > 2.0e9f) ? 2.0e9f : (rpm_q8 < -2.0e9f) ? -2.0e9f : rpm_q8;
+        int32_t filtered = RpmFilter_Process(&enc->filter, (int32_t)rpm_q8, NULL, 0);
+        enc->current_rpm = (float)filtered / (float)RPM_FILTER_Q_ONE;
         return enc->current_rpm;
     }
     
@@ -98,18 +148,12 @@ static inline float Encoder_GetRPM(Encoder_t* enc) {
 // Tính quãng đường đã đi (mét)
 static inline float Encoder_GetLengthMeter(Encoder_t* enc) {
     if (!enc || !enc->htim) return 0.0f;
-    int64_t pulse_now = enc->total_pulse + (int64_t)__HAL_TIM_GET_COUNTER(enc->htim);
+    int64_t pulse_now = Encoder_GetPulse(enc);
     float rev = (float)pulse_now / (float)enc->ppr;
     float circumference = enc->wheel_diameter_m * M_PI;
     return rev * circumference;
 }
 
-// Lấy tổng xung encoder hiện tại
-static inline int64_t Encoder_GetPulse(Encoder_t* enc) {
-    if (!enc || !enc->htim) return 0;
-    return enc->total_pulse + (int64_t)__HAL_TIM_GET_COUNTER(enc->htim);
-}
-
 // Convert RPM to linear speed (m/min)
 static inline float Encoder_ConvertRPMToMetersPerMin(Encoder_t* enc, float rpm) {
     if (!enc) return 0.0f;
@@ -189,7 +233,26 @@ static inline float Encoder_GetCurrentRPM(Encoder_t* enc) {
 }
 
 // Function declarations for encoder.c
-void Encoder_RegisterInstance(Encoder_t* enc);
-void Encoder_HandleTimerOverflow(void);
+void Encoder_Stop(Encoder_t* enc);
+void Encoder_Reset(Encoder_t* enc);
+void Encoder_HandleOverflow(Encoder_t* enc);
+void Encoder_HandleCapture(Encoder_t* enc);
+void Encoder_SetLowSpeed(Encoder_t* enc, uint16_t counts);
+// Speed filter chain (rpm_filter.h); the filter restarts from the next window
+bool Encoder_SetFilterChain(Encoder_t* enc, RpmFilterChain_t chain);
+void Encoder_PutRegisters(Encoder_t* enc, uint16_t* block);
+
+// Registry slot of a timer (TIM1..TIM4 -> 0..3), -1 if it has none
+int32_t Encoder_TimerIndex(const TIM_TypeDef* instance);
+
+// Instance table keyed by timer, O(1) lookup from the update interrupt
+void EncoderRegistry_Init(EncoderRegistry_t* registry);
+bool EncoderRegistry_Add(EncoderRegistry_t* registry, Encoder_t* enc);
+void EncoderRegistry_Remove(EncoderRegistry_t* registry, Encoder_t* enc);
+Encoder_t* EncoderRegistry_Find(const EncoderRegistry_t* registry, const TIM_HandleTypeDef* htim);
+// Call from HAL_TIM_PeriodElapsedCallback
+void EncoderRegistry_HandleOverflow(EncoderRegistry_t* registry, TIM_HandleTypeDef* htim);
+// Call from HAL_TIM_IC_CaptureCallback
+void EncoderRegistry_HandleCapture(EncoderRegistry_t* registry, TIM_HandleTypeDef* htim);
 
 #endif // ENCODER_INTERRUPT_H
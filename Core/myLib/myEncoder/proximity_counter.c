@@ -14,337 +14,2175 @@
 /* Private typedef -----------------------------------------------------------*/
 
 /* Private define ------------------------------------------------------------*/
+#define PROXIMITY_DMA_INDEX_MASK  (PROXIMITY_DMA_BUFFER_SIZE - 1U)
+#define PROXIMITY_DMA_MARK_MASK   (PROXIMITY_DMA_MARK_COUNT - 1U)
+#define PROXIMITY_TIMER_PERIOD    65536ULL   // Counter ticks per update (ARR = 0xFFFF)
+#define PROXIMITY_TRACE_MASK      (PROXIMITY_TRACE_SIZE - 1U)
 
 /* Private macro -------------------------------------------------------------*/
 
 /* Private variables ---------------------------------------------------------*/
+// Channel -> instance table per timer, filled by ProximityCounter_Init
+static ProximityCounter_t *proximity_dispatch[PROXIMITY_DISPATCH_TIMERS][PROXIMITY_MAX_CHANNELS];
+
+// HAL_TIM_ActiveChannel (one bit per channel) -> channel index
+static const int8_t proximity_active_index[16] = {
+    -1, 0, 1, -1, 2, -1, -1, -1, 3, -1, -1, -1, -1, -1, -1, -1
+};
 
 /* Private function prototypes -----------------------------------------------*/
 
 /* Private functions ---------------------------------------------------------*/
 
 /**
- * @brief Apply adaptive hysteresis filter to RPM value using configurable table
- * @param prox_counter: Pointer to ProximityCounter_t structure
- * @param new_rpm: New RPM value to filter
- * @param prev_rpm: Previous RPM value  
- * @param stability_counter: Pointer to stability counter
- * @retval Filtered RPM value
+ * @brief Dispatch table row of a timer, -1 if it cannot carry a proximity channel
  */
-int ProximityCounter_ApplyHysteresisFilter(ProximityCounter_t *prox_counter, 
-                                         int new_rpm, 
-                                         int prev_rpm, 
-                                         volatile uint8_t *stability_counter) {
-    if (!prox_counter) {
-        return new_rpm;
+static int32_t ProximityCounter_TimerSlot(const TIM_HandleTypeDef *htim) {
+    if (htim->Instance == TIM2) {
+        return 0;
     }
-    
-    int threshold = 50; // Default threshold
-    
-    // Find appropriate threshold from table
-    if (prox_counter->hysteresis_table_size > 0) {
-        for (int i = (int)prox_counter->hysteresis_table_size - 1; i >= 0; i--) {
-            if (new_rpm >= prox_counter->hysteresis_table[i].rpm_threshold) {
-                threshold = prox_counter->hysteresis_table[i].hysteresis;
-                break;
+    if (htim->Instance == TIM3) {
+        return 1;
+    }
+    if (htim->Instance == TIM4) {
+        return 2;
+    }
+    return -1;
+}
+
+/**
+ * @brief Drop every slot bound to an instance
+ */
+static void ProximityCounter_Unregister(const ProximityCounter_t *prox_counter) {
+    for (uint32_t t = 0; t < PROXIMITY_DISPATCH_TIMERS; t++) {
+        for (uint32_t c = 0; c < PROXIMITY_MAX_CHANNELS; c++) {
+            if (proximity_dispatch[t][c] == prox_counter) {
+                proximity_dispatch[t][c] = NULL;
             }
         }
     }
+}
 
-    // Calculate difference
-    int diff = new_rpm - prev_rpm;
-    int abs_diff = (diff < 0) ? -diff : diff;
+/**
+ * @brief Bind an instance to its timer/channel slot
+ * @note The prescaler is shared by every channel of a timer, so auto-ranging
+ *       is switched off for all instances once a second one joins.
+ */
+static void ProximityCounter_Register(ProximityCounter_t *prox_counter) {
+    int32_t slot = ProximityCounter_TimerSlot(prox_counter->htim);
+    bool shared = false;
     
-    if (abs_diff <= threshold) {
-        (*stability_counter)++;
-        if (*stability_counter >= 10) {
-            int step = abs_diff / 4;
-            if (step < 1) {
-                step = 1;
-            }
-            if (diff > 0) {
-                return prev_rpm + step;
-            }
-            if (diff < 0) {
-                return prev_rpm - step;
+    // Drop a previous binding of the same instance
+    ProximityCounter_Unregister(prox_counter);
+    if (slot < 0) {
+        return;
+    }
+    
+    proximity_dispatch[slot][prox_counter->channel / 4U] = prox_counter;
+    for (uint32_t c = 0; c < PROXIMITY_MAX_CHANNELS; c++) {
+        ProximityCounter_t *other = proximity_dispatch[slot][c];
+        if (other && other != prox_counter) {
+            shared = true;
+            other->auto_range = 0;
+            if (other->active_psc != 0) {
+                other->requested_psc = other->htim->Init.Prescaler + 1U;
             }
-            return prev_rpm;
         }
-        return prev_rpm;
-    } else {
-        *stability_counter = 0;
-        return new_rpm;
+    }
+    if (shared) {
+        prox_counter->auto_range = 0;
     }
 }
 
-/* Exported functions --------------------------------------------------------*/
-
 /**
- * @brief Initialize proximity counter
+ * @brief Another running instance on the same timer, if any
  */
-void ProximityCounter_Init(ProximityCounter_t *prox_counter, 
-                          const ProximityCounterConfig_t *config,
-                          TIM_HandleTypeDef *htim) {
-    if (!prox_counter || !config || !htim) {
-        return;
+static ProximityCounter_t *ProximityCounter_RunningSibling(const ProximityCounter_t *prox_counter) {
+    int32_t slot = ProximityCounter_TimerSlot(prox_counter->htim);
+    if (slot < 0) {
+        return NULL;
     }
+    for (uint32_t c = 0; c < PROXIMITY_MAX_CHANNELS; c++) {
+        ProximityCounter_t *other = proximity_dispatch[slot][c];
+        if (other && other != prox_counter && other->running) {
+            return other;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Push one period into the sliding window and publish the running mean
+ * @note Each period is added and evicted once, so the cost per edge is O(1)
+ *       amortised and bounded by PROXIMITY_WINDOW_SIZE.
+ */
+static void ProximityCounter_SlidePeriod(ProximityCounter_t *prox_counter, uint32_t difference, uint64_t timestamp) {
+    uint8_t limit = (prox_counter->window_clocks > 0U) ? PROXIMITY_WINDOW_SIZE
+                                                       : (uint8_t)prox_counter->averaging_samples;
     
-    // Clear the structure
-    memset(prox_counter, 0, sizeof(ProximityCounter_t));
-    
-    // Set configuration parameters
-    prox_counter->ppr = config->ppr > 0 ? config->ppr : 1;
-    prox_counter->diameter = config->diameter > 0.0f ? config->diameter : 0.25f;
-    prox_counter->timeout_ms = config->timeout_ms > 0 ? config->timeout_ms : PROXIMITY_NO_PULSE_TIMEOUT_MS;
-    prox_counter->averaging_samples = config->averaging_samples > 0 ? config->averaging_samples : 3;
-    prox_counter->speed_unit = PROXIMITY_SPEED_UNIT_RPM; // Default to RPM
+    // Count bound: drop the oldest period to make room
+    if (prox_counter->period_count >= limit) {
+        prox_counter->period_sum -= prox_counter->window[prox_counter->window_head];
+        prox_counter->window_head = (prox_counter->window_head + 1U) & (PROXIMITY_WINDOW_SIZE - 1U);
+        prox_counter->period_count--;
+    }
     
-    // Set timer handle
-    prox_counter->htim = htim;
+    uint8_t tail = (prox_counter->window_head + prox_counter->period_count) & (PROXIMITY_WINDOW_SIZE - 1U);
+    prox_counter->window[tail] = difference;
+    prox_counter->period_sum += difference;
+    prox_counter->period_count++;
     
-    // Initialize default hysteresis table
-    ProximityCounter_InitDefaultHysteresis(prox_counter);
+    // Time bound: periods are back to back, so their sum is the time they cover
+    while (prox_counter->window_clocks > 0U && prox_counter->period_sum > prox_counter->window_clocks &&
+           prox_counter->period_count > 1U) {
+        prox_counter->period_sum -= prox_counter->window[prox_counter->window_head];
+        prox_counter->window_head = (prox_counter->window_head + 1U) & (PROXIMITY_WINDOW_SIZE - 1U);
+        prox_counter->period_count--;
+    }
     
-    // Initialize state variables
-    prox_counter->first_measurement = 1;
-    prox_counter->last_capture_time = HAL_GetTick();
+    prox_counter->difference = (uint32_t)(prox_counter->period_sum / prox_counter->period_count);
+    prox_counter->sample_ts = timestamp;
+    prox_counter->new_capture_ready = 1;
 }
 
 /**
- * @brief Start proximity counter measurement
+ * @brief Store averaging mode and window bounds
  */
-void ProximityCounter_Start(ProximityCounter_t *prox_counter) {
-    if (!prox_counter || !prox_counter->htim) {
-        return;
+static void ProximityCounter_ConfigAveraging(ProximityCounter_t *prox_counter, ProximityAveraging_t averaging,
+                                             uint32_t samples, uint32_t window_ms) {
+    if (samples == 0U) {
+        samples = 1U;
     }
+    if (averaging == PROXIMITY_AVERAGING_SLIDING && samples > PROXIMITY_WINDOW_SIZE) {
+        samples = PROXIMITY_WINDOW_SIZE;
+    }
+    prox_counter->averaging = averaging;
+    prox_counter->averaging_samples = samples;
+    prox_counter->window_clocks = (averaging == PROXIMITY_AVERAGING_SLIDING)
+                                ? (uint64_t)window_ms * (PROXIMITY_TIMCLOCK / 1000UL) : 0U;
+}
+
+/**
+ * @brief Feed one measured period, ending at timestamp, into the block or sliding averaging
+ */
+static void ProximityCounter_AddPeriod(ProximityCounter_t *prox_counter, uint32_t difference, uint64_t timestamp) {
+    prox_counter->difference = difference;
     
-    // Reset all measurement states
-    ProximityCounter_Reset(prox_counter);
-    
-    // Start input capture interrupt
-    HAL_TIM_IC_Start_IT(prox_counter->htim, TIM_CHANNEL_1);
-    HAL_TIM_Base_Start_IT(prox_counter->htim);  // Enable overflow interrupt
+    if (prox_counter->averaging == PROXIMITY_AVERAGING_SLIDING) {
+        ProximityCounter_SlidePeriod(prox_counter, difference, timestamp);
+    } else if (prox_counter->first_measurement) {
+        // First measurement: use single period
+        prox_counter->sample_ts = timestamp;
+        prox_counter->new_capture_ready = 1;
+        prox_counter->first_measurement = 0;
+    } else {
+        // Subsequent measurements: collect periods for averaging
+        prox_counter->period_sum += difference;
+        prox_counter->period_count++;
+        
+        if (prox_counter->period_count >= prox_counter->averaging_samples) {
+            // Calculate average period
+            prox_counter->difference = prox_counter->period_sum / prox_counter->period_count;
+            prox_counter->sample_ts = timestamp;
+            prox_counter->new_capture_ready = 1;
+            
+            // Reset for next averaging cycle
+            prox_counter->period_sum = 0;
+            prox_counter->period_count = 0;
+        }
+    }
 }
 
 /**
- * @brief Stop proximity counter measurement
+ * @brief Record a raw capture
+ * @note Capture path: the stop compare is what freezes the block, the rest
+ *       is one store and one increment.
  */
-void ProximityCounter_Stop(ProximityCounter_t *prox_counter) {
-    if (!prox_counter || !prox_counter->htim) {
+static inline void ProximityCounter_TraceStore(ProximityTrace_t *trace, uint64_t timestamp) {
+    uint32_t head = trace->head;
+    if (head != trace->stop) {
+        trace->samples[head & PROXIMITY_TRACE_MASK] = (uint32_t)timestamp;
+        trace->head = head + 1U;
+    }
+}
+
+/**
+ * @brief Start the post-trigger countdown
+ * @note Call with the capture interrupt masked or from the capture path.
+ */
+static void ProximityCounter_TraceFire(ProximityTrace_t *trace, ProximityTrigger_t cause) {
+    if (trace->state != PROXIMITY_TRACE_RECORDING) {
         return;
     }
+    trace->trigger = trace->head;
+    trace->stop = trace->trigger + trace->post;
+    trace->cause = (uint8_t)cause;
+    trace->state = PROXIMITY_TRACE_TRIGGERED;
+}
+
+/**
+ * @brief Keep the stop index out of reach while armed, notice a full block
+ */
+static void ProximityCounter_TraceService(ProximityTrace_t *trace) {
+    if (trace->state == PROXIMITY_TRACE_RECORDING) {
+        // Trails head by a full lap of the 32-bit index
+        __disable_irq();
+        if (trace->state == PROXIMITY_TRACE_RECORDING) {
+            trace->stop = trace->head - 1U;
+        }
+        __enable_irq();
+    } else if (trace->state == PROXIMITY_TRACE_TRIGGERED && trace->head == trace->stop) {
+        trace->state = PROXIMITY_TRACE_FROZEN;
+    }
+}
+
+/**
+ * @brief First stored capture of the block, the start of its first period
+ */
+static uint32_t ProximityCounter_TraceFirst(const ProximityTrace_t *trace) {
+    return (trace->trigger > trace->pre) ? trace->trigger - trace->pre - 1U : 0U;
+}
+
+/**
+ * @brief Check an edge against the shortest plausible period
+ * @retval true if the edge is dropped
+ * @note Runs per edge; a run of rejects means the bound is stale (a real
+ *       jump), so the bound is released and the edge accepted.
+ */
+static bool ProximityCounter_RejectGlitch(ProximityCounter_t *prox_counter, uint64_t elapsed) {
+    prox_counter->glitch_edges++;
+    if (elapsed >= prox_counter->glitch_min_period) {
+        prox_counter->glitch_run = 0;
+        return false;
+    }
+    if (++prox_counter->glitch_run > PROXIMITY_GLITCH_MAX_RUN) {
+        prox_counter->glitch_run = 0;
+        prox_counter->glitch_min_period = 0;
+        return false;
+    }
+    prox_counter->glitch_rejects++;
+    if (prox_counter->trace && prox_counter->trace->on_glitch) {
+        ProximityCounter_TraceFire(prox_counter->trace, PROXIMITY_TRIGGER_GLITCH);
+    }
+    return true;
+}
+
+/**
+ * @brief Shortest period the shaft can follow the expected one with
+ * @note Over one period e the speed v = 60 f / (ppr e) rises at most by
+ *       max_accel * e / f, so e' >= e / (1 + max_accel ppr e^2 / (60 f^2)).
+ */
+static void ProximityCounter_UpdateGlitchBound(ProximityCounter_t *prox_counter, uint32_t expected) {
+    const float f = (float)PROXIMITY_TIMCLOCK;
+    float e = (float)expected;
+    float gain = (float)prox_counter->max_accel * (float)prox_counter->ppr * e * e / (60.0f * f * f);
+    prox_counter->glitch_min_period = (uint32_t)(e * (1.0f - PROXIMITY_GLITCH_JITTER) / (1.0f + gain));
+}
+
+/**
+ * @brief Move to the next tooth and learn or correct the period that ended on it
+ * @param period: Measured period, 0 for the first edge after a restart
+ * @retval Period to average, corrected when the table is active
+ * @note Runs per edge. Accumulation starts at a revolution boundary and stops
+ *       after target_revs, so every tooth holds the same number of periods.
+ */
+static uint32_t ProximityCounter_ToothPeriod(ProximityCounter_t *prox_counter, uint32_t period) {
+    ProximityToothCal_t *cal = prox_counter->tooth_cal;
+    if (!cal || cal->state == PROXIMITY_TOOTH_OFF || cal->teeth != prox_counter->ppr) {
+        return period;
+    }
+    
+    uint8_t tooth = prox_counter->tooth_index;
+    if (++prox_counter->tooth_index >= cal->teeth) {
+        prox_counter->tooth_index = 0;
+    }
     
-    // Stop input capture interrupt
-    HAL_TIM_IC_Stop_IT(prox_counter->htim, TIM_CHANNEL_1);
-    HAL_TIM_Base_Stop_IT(prox_counter->htim);
+    if (cal->state == PROXIMITY_TOOTH_ACTIVE) {
+        if (period > 0U) {
+            uint64_t corrected = ((uint64_t)period * cal->correction_q14[tooth]) >> PROXIMITY_TOOTH_Q_SHIFT;
+            period = (corrected > UINT32_MAX) ? UINT32_MAX : (uint32_t)corrected;
+        }
+    } else if (cal->revs > 0U && cal->revs <= cal->target_revs) {
+        cal->period_sum[tooth] += period;
+    }
+    if (prox_counter->tooth_index == 0U) {
+        cal->revs++;
+    }
+    return period;
 }
 
 /**
- * @brief Process new capture data and calculate RPM
+ * @brief Restart learn / align after the period chain was broken
+ * @param lost_edges: Edges may have been skipped, so the tooth phase is unknown
  */
-void ProximityCounter_ProcessCapture(ProximityCounter_t *prox_counter) {
-    if (!prox_counter || !prox_counter->new_capture_ready) {
+static void ProximityCounter_ToothRestart(ProximityCounter_t *prox_counter, bool lost_edges) {
+    ProximityToothCal_t *cal = prox_counter->tooth_cal;
+    if (!cal) {
         return;
     }
+    if (cal->state == PROXIMITY_TOOTH_ACTIVE && lost_edges) {
+        cal->state = PROXIMITY_TOOTH_ALIGN;
+        cal->target_revs = 1U;
+    }
+    if (cal->state == PROXIMITY_TOOTH_LEARN || cal->state == PROXIMITY_TOOTH_ALIGN) {
+        // A gap without a period would leave one tooth short
+        memset(cal->period_sum, 0, sizeof(cal->period_sum));
+        cal->revs = 0;
+    }
+}
+
+/**
+ * @brief Turn the learned period sums into corrections
+ * @note correction = mean tooth period / tooth period, so corrected periods
+ *       all equal the mean one at constant speed.
+ */
+static void ProximityCounter_ToothBuild(ProximityToothCal_t *cal) {
+    uint64_t total = 0;
     
-    prox_counter->new_capture_ready = 0;  // Clear flag
+    for (uint32_t i = 0; i < cal->teeth; i++) {
+        if (cal->period_sum[i] == 0U) {
+            cal->state = PROXIMITY_TOOTH_OFF;
+            return;
+        }
+        total += cal->period_sum[i];
+    }
+    for (uint32_t i = 0; i < cal->teeth; i++) {
+        uint64_t correction = (total << PROXIMITY_TOOTH_Q_SHIFT) / ((uint64_t)cal->teeth * cal->period_sum[i]);
+        cal->correction_q14[i] = (correction > UINT16_MAX) ? UINT16_MAX : (uint16_t)correction;
+    }
+    cal->state = PROXIMITY_TOOTH_ACTIVE;
+}
+
+/**
+ * @brief Rotate the table onto the recorded revolution
+ * @note Tries every shift and keeps the one with the least absolute deviation
+ *       of the corrected periods, O(teeth^2) once per alignment.
+ */
+static void ProximityCounter_ToothAlign(ProximityCounter_t *prox_counter, ProximityToothCal_t *cal) {
+    uint32_t teeth = cal->teeth;
+    uint32_t best_shift = 0;
+    uint64_t best_cost = UINT64_MAX;
     
-    // Calculate RPM from captured difference
-    if (prox_counter->difference > 0) {
-        float frequency = (float)PROXIMITY_COUNTER_HZ / (float)prox_counter->difference;
-        int rpm_raw = (int)(frequency * 60.0f / prox_counter->ppr);  // Account for PPR
-        
-        // Apply adaptive hysteresis filter
-        prox_counter->rpm = (float)ProximityCounter_ApplyHysteresisFilter(
-            prox_counter,
-            rpm_raw, 
-            prox_counter->rpm_previous, 
-            &prox_counter->stability_counter
-        );
-        prox_counter->rpm_previous = (int)prox_counter->rpm;
+    for (uint32_t shift = 0; shift < teeth; shift++) {
+        uint64_t sum = 0;
+        uint64_t cost = 0;
+        for (uint32_t i = 0; i < teeth; i++) {
+            sum += (cal->period_sum[i] * cal->correction_q14[(i + shift) % teeth]) >> PROXIMITY_TOOTH_Q_SHIFT;
+        }
+        uint64_t mean = sum / teeth;
+        for (uint32_t i = 0; i < teeth; i++) {
+            uint64_t c = (cal->period_sum[i] * cal->correction_q14[(i + shift) % teeth]) >> PROXIMITY_TOOTH_Q_SHIFT;
+            cost += (c > mean) ? (c - mean) : (mean - c);
+        }
+        if (cost < best_cost) {
+            best_cost = cost;
+            best_shift = shift;
+        }
     }
+    
+    // Renumber the teeth so the tooth recorded as i uses entry i + shift
+    __disable_irq();
+    prox_counter->tooth_index = (uint8_t)((prox_counter->tooth_index + best_shift) % teeth);
+    cal->state = PROXIMITY_TOOTH_ACTIVE;
+    __enable_irq();
 }
 
 /**
- * @brief Check for timeout and reset if no pulses detected
+ * @brief Finish a learn or align run once the capture path has its revolutions
  */
-void ProximityCounter_CheckTimeout(ProximityCounter_t *prox_counter) {
-    if (!prox_counter) {
+static void ProximityCounter_ToothService(ProximityCounter_t *prox_counter) {
+    ProximityToothCal_t *cal = prox_counter->tooth_cal;
+    
+    if (cal->state == PROXIMITY_TOOTH_OFF || cal->state == PROXIMITY_TOOTH_ACTIVE) {
+        return;
+    }
+    if (cal->teeth != prox_counter->ppr) {
+        cal->state = PROXIMITY_TOOTH_OFF;
+        return;
+    }
+    if (cal->revs <= cal->target_revs) {
         return;
     }
+    if (cal->state == PROXIMITY_TOOTH_LEARN) {
+        ProximityCounter_ToothBuild(cal);
+    } else {
+        ProximityCounter_ToothAlign(prox_counter, cal);
+    }
+}
+
+/**
+ * @brief Advance the missing-tooth state machine by one period
+ * @param elapsed: Time since the previous edge in clocks
+ * @retval Tooth pitches the period spans (missing_teeth + 1 at the gap)
+ * @note Runs per edge: one compare against the previous pitch period and an
+ *       index step, nothing extra once per revolution.
+ */
+static uint32_t ProximityCounter_SyncEdge(ProximityCounter_t *prox_counter, uint64_t elapsed) {
+    uint32_t missing = prox_counter->missing_teeth;
+    uint64_t previous = prox_counter->sync_period;
+    bool gap = previous > 0U && elapsed * 2U > previous * (2U * missing + 1U);
+    uint32_t pitches = gap ? missing + 1U : 1U;
+    uint64_t pitch_period = elapsed / pitches;
     
-    uint32_t now = HAL_GetTick();
-    if ((now - prox_counter->last_capture_time) > prox_counter->timeout_ms) {
-        prox_counter->rpm = 0;
-        
-        // Reset averaging state
-        prox_counter->first_measurement = 1;
-        prox_counter->period_sum = 0;
-        prox_counter->period_count = 0;
-        prox_counter->is_first_captured = 0;
-        
-        // Reset hysteresis state
-        prox_counter->rpm_previous = 0;
-        prox_counter->stability_counter = 0;
+    prox_counter->sync_period = (pitch_period > UINT32_MAX) ? UINT32_MAX : (uint32_t)pitch_period;
+    if (gap) {
+        if (prox_counter->sync_state != PROXIMITY_SYNC_SYNCED) {
+            prox_counter->sync_state = PROXIMITY_SYNC_SYNCED;
+        } else if (prox_counter->sync_tooth + pitches == prox_counter->ppr) {
+            prox_counter->sync_revs++;
+        } else {
+            // Gap too early: an edge was missed or the gap was a slowdown
+            prox_counter->sync_state = PROXIMITY_SYNC_LOST;
+            prox_counter->sync_losses++;
+        }
+        prox_counter->sync_tooth = 0;
+    } else if (prox_counter->sync_state == PROXIMITY_SYNC_SYNCED &&
+               ++prox_counter->sync_tooth + missing >= prox_counter->ppr) {
+        // The gap should have ended this period
+        prox_counter->sync_state = PROXIMITY_SYNC_LOST;
+        prox_counter->sync_losses++;
     }
+    return pitches;
 }
 
 /**
- * @brief Get current RPM value
+ * @brief Forget the reference gap after the period chain was broken
  */
-float ProximityCounter_GetRPM(const ProximityCounter_t *prox_counter) {
-    if (!prox_counter) {
-        return 0.0f;
+static void ProximityCounter_SyncRestart(ProximityCounter_t *prox_counter) {
+    if (prox_counter->sync_state == PROXIMITY_SYNC_SYNCED) {
+        prox_counter->sync_state = PROXIMITY_SYNC_SEARCHING;
     }
-    return prox_counter->rpm;
+    prox_counter->sync_period = 0;
 }
 
 /**
- * @brief Get current frequency in Hz
+ * @brief Decide the direction of one A edge from the latest B edge
+ * @note Forward, B lags A by d < P/2, so the last B edge is P - d old;
+ *       reverse, it is d old. No B edge since the previous A edge keeps
+ *       the last direction.
  */
-float ProximityCounter_GetFrequency(const ProximityCounter_t *prox_counter) {
-    if (!prox_counter) {
-        return 0.0f;
+static void ProximityCounter_DirectionEdge(ProximityCounter_t *prox_counter, uint64_t timestamp) {
+    int8_t dir = prox_counter->direction;
+    uint64_t b_ts = prox_counter->dir_b_ts;
+    
+    if (prox_counter->is_first_captured && b_ts > prox_counter->last_timestamp && b_ts <= timestamp) {
+        uint64_t period = timestamp - prox_counter->last_timestamp;
+        dir = ((timestamp - b_ts) * 2U > period) ? 1 : -1;
+        if (dir == prox_counter->dir_candidate) {
+            prox_counter->direction = dir;
+        }
+        prox_counter->dir_candidate = dir;
     }
-    return prox_counter->rpm / 60.0f * prox_counter->ppr;
+    prox_counter->position += dir;
 }
 
 /**
- * @brief Set PPR (Pulses Per Revolution)
+ * @brief Close the high time of the pulse that started at the previous rising edge
  */
-void ProximityCounter_SetPPR(ProximityCounter_t *prox_counter, uint32_t ppr) {
-    if (!prox_counter || ppr == 0) {
-        return;
+static void ProximityCounter_PulseRise(ProximityCounter_t *prox_counter, uint64_t timestamp) {
+    uint64_t fall = prox_counter->pw_fall_ts;
+    
+    if (prox_counter->is_first_captured && fall > prox_counter->last_timestamp && fall < timestamp) {
+        uint64_t high = fall - prox_counter->last_timestamp;
+        uint64_t period = timestamp - prox_counter->last_timestamp;
+        prox_counter->pw_high = (high > UINT32_MAX) ? UINT32_MAX : (uint32_t)high;
+        prox_counter->pw_period = (period > UINT32_MAX) ? UINT32_MAX : (uint32_t)period;
     }
-    prox_counter->ppr = ppr;
 }
 
 /**
- * @brief Set diameter
+ * @brief Latch a falling edge, and with both_edges feed the falling-to-falling period
+ * @note Uneven targets would mix two different periods, so the extra samples
+ *       are only taken on plain T-method counting.
  */
-void ProximityCounter_SetDiameter(ProximityCounter_t *prox_counter, float diameter) {
-    if (!prox_counter || diameter <= 0.0f) {
+static void ProximityCounter_PulseFall(ProximityCounter_t *prox_counter, uint64_t timestamp) {
+    uint64_t previous = prox_counter->pw_fall_ts;
+    
+    if (previous > 0U && (timestamp - previous) < prox_counter->glitch_min_period) {
         return;
     }
-    prox_counter->diameter = diameter;
+    prox_counter->pw_fall_ts = timestamp;
+    
+    if (prox_counter->both_edges && previous > 0U && prox_counter->is_first_captured &&
+        prox_counter->method == PROXIMITY_METHOD_PERIOD && prox_counter->missing_teeth == 0U &&
+        (!prox_counter->tooth_cal || prox_counter->tooth_cal->state == PROXIMITY_TOOTH_OFF)) {
+        uint64_t elapsed = timestamp - previous;
+        ProximityCounter_AddPeriod(prox_counter, (elapsed > UINT32_MAX) ? UINT32_MAX : (uint32_t)elapsed, timestamp);
+        prox_counter->last_capture_cycles = Timebase_GetCycles();
+    }
 }
 
 /**
- * @brief Set timeout value
+ * @brief Fold the latest duty into the slow average
  */
-void ProximityCounter_SetTimeout(ProximityCounter_t *prox_counter, uint32_t timeout_ms) {
-    if (!prox_counter || timeout_ms == 0) {
+static void ProximityCounter_UpdateDuty(ProximityCounter_t *prox_counter) {
+    // The capture ISR writes the pair
+    __disable_irq();
+    uint32_t high = prox_counter->pw_high;
+    uint32_t period = prox_counter->pw_period;
+    __enable_irq();
+    
+    if (period == 0U) {
         return;
     }
-    prox_counter->timeout_ms = timeout_ms;
+    float duty = (float)high / (float)period;
+    if (prox_counter->duty_avg <= 0.0f) {
+        prox_counter->duty_avg = duty;
+    } else {
+        prox_counter->duty_avg += (duty - prox_counter->duty_avg) / (float)(1UL << PROXIMITY_DUTY_AVG_SHIFT);
+    }
 }
 
 /**
- * @brief Reset all measurement states
+ * @brief Input filter currently set on the instance's capture channel
  */
-void ProximityCounter_Reset(ProximityCounter_t *prox_counter) {
-    if (!prox_counter) {
+static uint32_t ProximityCounter_ChannelFilter(const ProximityCounter_t *prox_counter) {
+    uint32_t index = prox_counter->channel / 4U;
+    uint32_t ccmr = (index < 2U) ? prox_counter->htim->Instance->CCMR1 : prox_counter->htim->Instance->CCMR2;
+    return (ccmr >> (((index & 1U) ? 8U : 0U) + 4U)) & 0xFU;
+}
+
+/**
+ * @brief Count one edge into the M/T gate
+ */
+static void ProximityCounter_GateEdge(ProximityCounter_t *prox_counter, uint64_t timestamp, uint32_t pitches) {
+    if (prox_counter->is_first_captured == 0) {
+        prox_counter->is_first_captured = 1;
+        prox_counter->gate_first_ts = timestamp;
+        prox_counter->gate_edges = 0;
+    } else {
+        prox_counter->gate_edges += pitches;
+    }
+    prox_counter->gate_last_ts = timestamp;
+}
+
+/**
+ * @brief Close the M/T gate once gate_ms has passed
+ * @note The last edge of a gate opens the next one, so no time is lost
+ *       between gates. A gate without a closed period is left open.
+ */
+static void ProximityCounter_CloseGate(ProximityCounter_t *prox_counter) {
+    uint64_t now = Timebase_GetMicros();
+    if ((now - prox_counter->gate_start_us) < (uint64_t)prox_counter->gate_ms * 1000U) {
         return;
     }
+    prox_counter->gate_start_us = now;
     
-    // Reset measurement variables
-    prox_counter->rpm = 0.0f;
-    prox_counter->ic_val1 = 0;
-    prox_counter->ic_val2 = 0;
-    prox_counter->difference = 0;
-    prox_counter->is_first_captured = 0;
-    prox_counter->overflow_count = 0;
-    prox_counter->new_capture_ready = 0;
-    
-    // Reset averaging variables
-    prox_counter->period_sum = 0;
-    prox_counter->period_count = 0;
-    prox_counter->first_measurement = 1;
+    // The capture ISR writes the gate in interrupt mode
+    __disable_irq();
+    uint32_t edges = prox_counter->gate_edges;
+    uint64_t first = prox_counter->gate_first_ts;
+    uint64_t last = prox_counter->gate_last_ts;
+    if (edges > 0) {
+        prox_counter->gate_first_ts = last;
+        prox_counter->gate_edges = 0;
+    }
+    __enable_irq();
     
-    // Reset hysteresis variables
-    prox_counter->rpm_previous = 0;
-    prox_counter->stability_counter = 0;
+    if (edges == 0) {
+        return;
+    }
     
-    // Update timestamp
-    prox_counter->last_capture_time = HAL_GetTick();
+    // Mean period over the gate, in timer clock cycles
+    uint64_t period = (last - first) / edges;
+    prox_counter->difference = (period > UINT32_MAX) ? UINT32_MAX : (uint32_t)period;
+    prox_counter->sample_ts = last;
+    prox_counter->new_capture_ready = 1;
 }
 
 /**
- * @brief Update proximity counter configuration
+ * @brief Extend a 16-bit CCR1 value to the 64-bit timebase (timer clock cycles)
+ * @note Called from the capture ISR. HAL_TIM_IRQHandler services CC1 before
+ *       UPDATE, so a wrap just ahead of the edge can still be pending. A value
+ *       in the lower half of the range with UIF still set was captured after
+ *       that wrap, in the segment counting with pending_psc.
  */
-void ProximityCounter_UpdateConfig(ProximityCounter_t *prox_counter, uint32_t ppr, float diameter) {
-    if (!prox_counter) {
-        return;
+static uint64_t ProximityCounter_ExtendCapture(const ProximityCounter_t *prox_counter, uint16_t capture) {
+    if (__HAL_TIM_GET_FLAG(prox_counter->htim, TIM_FLAG_UPDATE) && capture < 0x8000U) {
+        return prox_counter->segment_base + PROXIMITY_TIMER_PERIOD * prox_counter->active_psc +
+               (uint64_t)capture * prox_counter->pending_psc;
     }
-    
-    prox_counter->ppr = ppr > 0 ? ppr : 1;
-    prox_counter->diameter = diameter > 0.0f ? diameter : 0.25f;
-    
-    // Reset measurement to apply new config
-    ProximityCounter_Reset(prox_counter);
+    return prox_counter->segment_base + (uint64_t)capture * prox_counter->active_psc;
 }
 
 /**
- * @brief Handle input capture callback - call this from HAL_TIM_IC_CaptureCallback
+ * @brief Pick the prescaler for the next segments from a measured period
+ * @note Power-of-two steps landing in [MIN, 2*MIN) ticks inside a [MIN, MAX)
+ *       band, so small speed changes never toggle the range.
  */
-void ProximityCounter_HandleCapture(ProximityCounter_t *prox_counter, TIM_HandleTypeDef *htim) {
-    if (!prox_counter || !htim || htim != prox_counter->htim) {
+static void ProximityCounter_UpdateRange(ProximityCounter_t *prox_counter, uint32_t period) {
+    uint32_t ticks = period / prox_counter->requested_psc;
+    
+    if (ticks >= PROXIMITY_RANGE_MIN_TICKS && ticks < PROXIMITY_RANGE_MAX_TICKS) {
         return;
     }
     
-    if (htim->Channel == HAL_TIM_ACTIVE_CHANNEL_1) {
-        if (prox_counter->is_first_captured == 0) {
-            // First rising edge - store initial value
-            prox_counter->ic_val1 = HAL_TIM_ReadCapturedValue(htim, TIM_CHANNEL_1);
-            prox_counter->is_first_captured = 1;
-            prox_counter->overflow_count = 0;
-            prox_counter->last_capture_time = HAL_GetTick();
-        } else {
-            // Second rising edge - calculate period
-            prox_counter->ic_val2 = HAL_TIM_ReadCapturedValue(htim, TIM_CHANNEL_1);
-            
-            // Calculate difference accounting for overflows
-            prox_counter->difference = (prox_counter->overflow_count * 65536UL) + 
-                                      prox_counter->ic_val2 - prox_counter->ic_val1;
-            
-            if (prox_counter->first_measurement) {
-                // First measurement: use single period
-                prox_counter->new_capture_ready = 1;
-                prox_counter->first_measurement = 0;
-            } else {
-                // Subsequent measurements: collect periods for averaging
-                prox_counter->period_sum += prox_counter->difference;
-                prox_counter->period_count++;
-                
-                if (prox_counter->period_count >= prox_counter->averaging_samples) {
-                    // Calculate average period
-                    prox_counter->difference = prox_counter->period_sum / prox_counter->period_count;
-                    prox_counter->new_capture_ready = 1;
-                    
-                    // Reset for next averaging cycle
-                    prox_counter->period_sum = 0;
-                    prox_counter->period_count = 0;
-                }
-            }
-            
-            prox_counter->last_capture_time = HAL_GetTick();
-            prox_counter->ic_val1 = prox_counter->ic_val2;
-            prox_counter->overflow_count = 0;
-        }
+    uint32_t psc = 1;
+    while (psc < PROXIMITY_RANGE_MAX_PRESCALER && period / (psc * 2U) >= PROXIMITY_RANGE_MIN_TICKS) {
+        psc *= 2U;
     }
+    prox_counter->requested_psc = psc;
 }
 
 /**
- * @brief Handle timer overflow callback - call this from HAL_TIM_PeriodElapsedCallback
+ * @brief Total number of captures the DMA has written since start
+ * @note CNDTR only gives the position inside the ring; the HT/TC count gives
+ *       the lap. A half event that is flagged but not yet serviced is covered
+ *       by resolving the position inside a full ring after the known base.
  */
-void ProximityCounter_HandleOverflow(ProximityCounter_t *prox_counter, TIM_HandleTypeDef *htim) {
-    if (!prox_counter || !htim || htim != prox_counter->htim) {
-        return;
+static uint32_t ProximityCounter_DmaWriteCount(const ProximityCounter_t *prox_counter) {
+    DMA_HandleTypeDef *hdma = prox_counter->htim->hdma[TIM_DMA_ID_CC1 + prox_counter->channel / 4U];
+    uint32_t events;
+    uint32_t position;
+    
+    if (!hdma) {
+        return 0;
     }
     
-    if (htim->Instance == prox_counter->htim->Instance && prox_counter->is_first_captured == 1) {
-        prox_counter->overflow_count++;
+    do {
+        events = prox_counter->dma->half_events;
+        position = PROXIMITY_DMA_BUFFER_SIZE - __HAL_DMA_GET_COUNTER(hdma);
+    } while (events != prox_counter->dma->half_events);
+    
+    uint32_t base = events * (PROXIMITY_DMA_BUFFER_SIZE / 2U);
+    return base + ((position - base) & PROXIMITY_DMA_INDEX_MASK);
+}
+
+/**
+ * @brief Close the wrap runs that come before capture index limit
+ * @note The update ISR may still add wraps to the newest run, so the count is
+ *       taken and the run retired with interrupts off.
+ */
+static void ProximityCounter_DmaFoldMarks(ProximityCounter_t *prox_counter, uint32_t limit) {
+    while (prox_counter->dma->mark_tail != prox_counter->dma->mark_head) {
+        uint32_t slot = prox_counter->dma->mark_tail & PROXIMITY_DMA_MARK_MASK;
+        if ((int32_t)(prox_counter->dma->marks[slot] - limit) > 0) {
+            break;
+        }
+        
+        __disable_irq();
+        uint32_t wraps = prox_counter->dma->mark_wraps[slot];
+        prox_counter->dma->mark_tail++;
+        __enable_irq();
+        
+        // The first wrap closes the segment being read, the rest close the run's own
+        uint32_t psc = prox_counter->dma->mark_psc[slot];
+        prox_counter->dma->segment_base += PROXIMITY_TIMER_PERIOD *
+                                          ((uint64_t)prox_counter->dma->psc + (uint64_t)(wraps - 1U) * psc);
+        prox_counter->dma->psc = psc;
+    }
+}
+
+/**
+ * @brief Drop everything queued in the DMA ring and restart the period chain
+ */
+static void ProximityCounter_DmaResync(ProximityCounter_t *prox_counter) {
+    prox_counter->dma->read_count = ProximityCounter_DmaWriteCount(prox_counter);
+    uint32_t head = prox_counter->dma->mark_head;
+    if (head != prox_counter->dma->mark_tail) {
+        // Skipped wraps only matter for the division of the current segment
+        prox_counter->dma->psc = prox_counter->dma->mark_psc[(head - 1U) & PROXIMITY_DMA_MARK_MASK];
+    }
+    prox_counter->dma->mark_tail = head;
+    prox_counter->is_first_captured = 0;
+    RpmTracker_Reset(&prox_counter->tracker);
+    ProximityCounter_ToothRestart(prox_counter, true);
+    ProximityCounter_SyncRestart(prox_counter);
+}
+
+/**
+ * @brief Turn the captures written since the last call into periods
+ */
+static void ProximityCounter_DmaConsume(ProximityCounter_t *prox_counter) {
+    uint32_t start = prox_counter->dma->read_count;
+    uint32_t write = ProximityCounter_DmaWriteCount(prox_counter);
+    
+    // Wrap runs only pile up with captures between them, so a full mark ring
+    // means the capture batch is already lost as well
+    if ((write - start) > PROXIMITY_DMA_BUFFER_SIZE ||
+        (prox_counter->dma->mark_head - prox_counter->dma->mark_tail) > PROXIMITY_DMA_MARK_COUNT) {
+        prox_counter->dma_overruns++;
+        ProximityCounter_DmaResync(prox_counter);
+        return;
+    }
+    if (write == start) {
+        // No edge (slow shaft or standstill): the wraps still move the timebase on
+        ProximityCounter_DmaFoldMarks(prox_counter, write);
+        return;
+    }
+    
+    for (uint32_t k = start; k != write; k++) {
+        // Wraps recorded before capture k close the segments it follows
+        ProximityCounter_DmaFoldMarks(prox_counter, k);
+        
+        uint16_t capture = prox_counter->dma->buffer[k & PROXIMITY_DMA_INDEX_MASK];
+        uint64_t timestamp = prox_counter->dma->segment_base + (uint64_t)capture * prox_counter->dma->psc;
+        uint32_t pitches = prox_counter->ic_div;
+        if (prox_counter->trace) {
+            ProximityCounter_TraceStore(prox_counter->trace, timestamp);
+        }
+        if (prox_counter->is_first_captured &&
+            ProximityCounter_RejectGlitch(prox_counter, (timestamp - prox_counter->last_timestamp) / pitches)) {
+            continue;
+        }
+        if (prox_counter->missing_teeth > 0U && prox_counter->is_first_captured) {
+            pitches = ProximityCounter_SyncEdge(prox_counter, timestamp - prox_counter->last_timestamp);
+        }
+        if (prox_counter->method == PROXIMITY_METHOD_MT) {
+            ProximityCounter_GateEdge(prox_counter, timestamp, pitches);
+        } else if (prox_counter->is_first_captured == 0) {
+            prox_counter->is_first_captured = 1;
+            ProximityCounter_ToothPeriod(prox_counter, 0);
+        } else {
+            uint64_t elapsed = timestamp - prox_counter->last_timestamp;
+            uint32_t period = (elapsed > UINT32_MAX) ? UINT32_MAX : (uint32_t)elapsed;
+            period /= pitches;
+            ProximityCounter_AddPeriod(prox_counter, ProximityCounter_ToothPeriod(prox_counter, period), timestamp);
+        }
+        prox_counter->ic_val1 = capture;
+        prox_counter->last_timestamp = timestamp;
+    }
+    
+    // The DMA may have lapped us while we were reading the oldest entries
+    if ((ProximityCounter_DmaWriteCount(prox_counter) - start) > PROXIMITY_DMA_BUFFER_SIZE) {
+        prox_counter->dma_overruns++;
+        prox_counter->new_capture_ready = 0;
+        ProximityCounter_DmaResync(prox_counter);
+        return;
+    }
+    
+    prox_counter->dma->read_count = write;
+    ProximityCounter_DmaFoldMarks(prox_counter, write);
+    prox_counter->last_capture_cycles = Timebase_GetCycles();
+}
+
+// Settle time of each ICxF setting in fDTS cycles (sampling divider x N samples)
+static const uint16_t proximity_filter_clocks[16] = {
+    0, 2, 4, 8, 12, 16, 24, 32, 48, 64, 80, 96, 128, 160, 192, 256
+};
+
+/**
+ * @brief Whether a feature needs every edge, which rules out the ICPSC divider
+ */
+static bool ProximityCounter_NeedsEveryEdge(const ProximityCounter_t *prox_counter) {
+    return prox_counter->missing_teeth > 0U || prox_counter->direction_sensing || prox_counter->pulse_width ||
+           (prox_counter->tooth_cal && prox_counter->tooth_cal->state != PROXIMITY_TOOTH_OFF);
+}
+
+/**
+ * @brief Strongest ICxF that still passes the shortest pulse a divider serves
+ * @note A divider is used up to max_irq_hz * div edges per second; the filter
+ *       has to settle within 1/PROXIMITY_IC_FILTER_BUDGET of that period so
+ *       narrow targets are not swallowed.
+ */
+static uint8_t ProximityCounter_PickFilter(const ProximityCounter_t *prox_counter, uint32_t div) {
+    // CKD: fDTS is the timer clock divided by 1, 2 or 4
+    uint32_t dts = 1UL << ((prox_counter->htim->Init.ClockDivision >> 8U) & 0x3U);
+    uint32_t budget = PROXIMITY_TIMCLOCK / (prox_counter->max_irq_hz * div) / PROXIMITY_IC_FILTER_BUDGET / dts;
+    uint8_t filter = 15U;
+    
+    while (filter > 0U && proximity_filter_clocks[filter] > budget) {
+        filter--;
+    }
+    return filter;
+}
+
+/**
+ * @brief Load ICPSC and ICxF for an edge divider and restart the period chain
+ * @note Captures taken with the old divider span a different number of edges
+ *       and the filter delay shifts, so the next capture only opens a period.
+ */
+static void ProximityCounter_SetInputStage(ProximityCounter_t *prox_counter, uint32_t div) {
+    uint32_t index = prox_counter->channel / 4U;
+    uint32_t shift = (index & 1U) ? 8U : 0U;
+    volatile uint32_t *ccmr = (index < 2U) ? &prox_counter->htim->Instance->CCMR1
+                                           : &prox_counter->htim->Instance->CCMR2;
+    uint32_t psc = (div >= 8U) ? 3U : (div >= 4U) ? 2U : (div >= 2U) ? 1U : 0U;
+    uint8_t filter = (prox_counter->max_irq_hz > 0U) ? ProximityCounter_PickFilter(prox_counter, 1UL << psc)
+                                                     : prox_counter->ic_base_filter;
+    
+    // ICxPSC and ICxF may change while the channel is enabled
+    __disable_irq();
+    *ccmr = (*ccmr & ~((TIM_CCMR1_IC1PSC | TIM_CCMR1_IC1F) << shift)) |
+            (((psc << 2U) | ((uint32_t)filter << 4U)) << shift);
+    prox_counter->ic_div = (uint8_t)(1U << psc);
+    prox_counter->ic_filter = filter;
+    prox_counter->is_first_captured = 0;
+    __enable_irq();
+    
+    if (prox_counter->capture_mode == PROXIMITY_CAPTURE_MODE_DMA) {
+        ProximityCounter_DmaResync(prox_counter);
+    } else {
+        ProximityCounter_ToothRestart(prox_counter, true);
+        ProximityCounter_SyncRestart(prox_counter);
+    }
+}
+
+/**
+ * @brief Pick the edge divider that keeps captures under max_irq_hz
+ * @note Steps up as soon as the rate is over the ceiling and down only once
+ *       the smaller divider stays a quarter under it, so the stage does not
+ *       toggle around a threshold.
+ */
+static void ProximityCounter_UpdateInputStage(ProximityCounter_t *prox_counter) {
+    uint32_t period = prox_counter->difference;
+    uint32_t div = 1U;
+    
+    if (period > 0U && !ProximityCounter_NeedsEveryEdge(prox_counter)) {
+        uint64_t edge_hz = PROXIMITY_TIMCLOCK / period;
+        uint64_t ceiling = prox_counter->max_irq_hz;
+        div = prox_counter->ic_div;
+        while (div < PROXIMITY_IC_MAX_DIV && edge_hz > ceiling * div) {
+            div *= 2U;
+        }
+        while (div > 1U && edge_hz * 4U <= ceiling * (div / 2U) * 3U) {
+            div /= 2U;
+        }
+    }
+    if (div != prox_counter->ic_div) {
+        ProximityCounter_SetInputStage(prox_counter, div);
+    }
+}
+
+/**
+ * @brief Correct the tracker with the pending output
+ */
+static int32_t ProximityCounter_Track(ProximityCounter_t *prox_counter, int32_t rpm_q8) {
+    // The capture ISR writes sample_ts in interrupt mode
+    __disable_irq();
+    uint64_t sample_ts = prox_counter->sample_ts;
+    __enable_irq();
+    
+    uint64_t dt_us = 0;
+    if (prox_counter->tracker.valid && sample_ts > prox_counter->tracker_ts) {
+        dt_us = (sample_ts - prox_counter->tracker_ts) / (PROXIMITY_TIMCLOCK / 1000000UL);
+    }
+    prox_counter->tracker_ts = sample_ts;
+    prox_counter->tracker_us = Timebase_GetMicros();
+    return RpmTracker_Update(&prox_counter->tracker, rpm_q8,
+                             (dt_us > UINT32_MAX) ? UINT32_MAX : (uint32_t)dt_us);
+}
+
+/**
+ * @brief Report zero speed and restart measurement from the next edge
+ */
+static void ProximityCounter_DeclareStop(ProximityCounter_t *prox_counter) {
+    if (!prox_counter->stopped) {
+        RpmStats_Add(&prox_counter->stats, 0);  // The drop to zero counts once
+        RpmHistory_Add(prox_counter->history, 0);
+    }
+    prox_counter->rpm = 0;
+    prox_counter->stopped = 1;
+    prox_counter->difference = 0;
+    prox_counter->glitch_min_period = 0;
+    prox_counter->new_capture_ready = 0;
+    
+    // Reset averaging state
+    prox_counter->first_measurement = 1;
+    prox_counter->period_sum = 0;
+    prox_counter->period_count = 0;
+    prox_counter->window_head = 0;
+    prox_counter->is_first_captured = 0;
+    prox_counter->pw_fall_ts = 0;
+    
+    // Reset filter state
+    RpmFilter_Reset(&prox_counter->filter);
+    RpmTracker_Reset(&prox_counter->tracker);
+    
+    // Every edge is still counted, so the tooth phase survives a stop; the
+    // gap cannot be told from the first period after one
+    ProximityCounter_ToothRestart(prox_counter, false);
+    ProximityCounter_SyncRestart(prox_counter);
+}
+
+/**
+ * @brief Apply adaptive hysteresis filter to RPM value using configurable table
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @param new_rpm: New RPM value to filter
+ * @param prev_rpm: Previous RPM value  
+ * @param stability_counter: Pointer to stability counter
+ * @retval Filtered RPM value
+ */
+int ProximityCounter_ApplyHysteresisFilter(ProximityCounter_t *prox_counter, 
+                                         int new_rpm, 
+                                         int prev_rpm, 
+                                         volatile uint8_t *stability_counter) {
+    if (!prox_counter || !stability_counter) {
+        return new_rpm;
+    }
+    
+    uint8_t stable = *stability_counter;
+    int32_t rpm_q8 = RpmFilter_Hysteresis(prox_counter->hysteresis_table,
+                                          prox_counter->hysteresis_table_size,
+                                          (int32_t)new_rpm << RPM_FILTER_Q_SHIFT,
+                                          (int32_t)prev_rpm << RPM_FILTER_Q_SHIFT,
+                                          &stable);
+    *stability_counter = stable;
+    return (int)(rpm_q8 >> RPM_FILTER_Q_SHIFT);
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief Initialize proximity counter
+ */
+void ProximityCounter_Init(ProximityCounter_t *prox_counter, 
+                          const ProximityCounterConfig_t *config,
+                          TIM_HandleTypeDef *htim) {
+    if (!prox_counter || !config || !htim) {
+        return;
+    }
+    
+    // Clear the structure
+    memset(prox_counter, 0, sizeof(ProximityCounter_t));
+    
+    // Set configuration parameters
+    prox_counter->ppr = config->ppr > 0 ? config->ppr : 1;
+    prox_counter->diameter = config->diameter > 0.0f ? config->diameter : 0.25f;
+    prox_counter->timeout_ms = config->timeout_ms > 0 ? config->timeout_ms : PROXIMITY_NO_PULSE_TIMEOUT_MS;
+    prox_counter->averaging_samples = config->averaging_samples > 0 ? config->averaging_samples : 3;
+    prox_counter->speed_unit = PROXIMITY_SPEED_UNIT_RPM; // Default to RPM
+    prox_counter->dma = config->dma_ring;
+    prox_counter->capture_mode = prox_counter->dma ? config->capture_mode : PROXIMITY_CAPTURE_MODE_IT;
+    prox_counter->auto_range = config->auto_range;
+    prox_counter->method = config->method;
+    prox_counter->gate_ms = config->gate_ms > 0 ? config->gate_ms : PROXIMITY_MT_DEFAULT_GATE_MS;
+    prox_counter->stop_periods = config->stop_periods > 0 ? config->stop_periods : PROXIMITY_STOP_PERIODS;
+    prox_counter->max_accel = config->max_accel;
+    prox_counter->missing_teeth = (config->missing_teeth <= PROXIMITY_SYNC_MAX_MISSING) ? config->missing_teeth : 0U;
+    prox_counter->max_irq_hz = config->max_irq_hz;
+    prox_counter->ic_div = 1;
+    ProximityCounter_ConfigAveraging(prox_counter, config->averaging, prox_counter->averaging_samples,
+                                     config->window_ms);
+    RpmFilter_Init(&prox_counter->filter, config->filter_chain);
+    prox_counter->tracking = config->tracker;
+    RpmTracker_Init(&prox_counter->tracker, RPM_TRACKER_DEFAULT_ALPHA_Q8, RPM_TRACKER_DEFAULT_BETA_Q8);
+    RpmStats_Init(&prox_counter->stats, NULL, HAL_GetTick());
+    Timebase_Init();
+    
+    // Set timer handle and channel
+    prox_counter->htim = htim;
+    prox_counter->channel = config->channel & TIM_CHANNEL_4;
+    prox_counter->active_channel = (HAL_TIM_ActiveChannel)(HAL_TIM_ACTIVE_CHANNEL_1 << (prox_counter->channel / 4U));
+    prox_counter->ic_base_filter = (uint8_t)ProximityCounter_ChannelFilter(prox_counter);
+    prox_counter->ic_filter = prox_counter->ic_base_filter;
+    ProximityCounter_Register(prox_counter);
+    
+    // Initialize default hysteresis table
+    ProximityCounter_InitDefaultHysteresis(prox_counter);
+    
+    // Initialize state variables
+    prox_counter->first_measurement = 1;
+    prox_counter->last_capture_cycles = Timebase_GetCycles();
+}
+
+/**
+ * @brief Start proximity counter measurement
+ */
+void ProximityCounter_Start(ProximityCounter_t *prox_counter) {
+    if (!prox_counter || !prox_counter->htim) {
+        return;
+    }
+    
+    // Reset all measurement states
+    ProximityCounter_Reset(prox_counter);
+    
+    // Timebase starts on the prescaler MX_TIM2_Init loaded, or follows the
+    // channel already running on this timer
+    ProximityCounter_t *sibling = ProximityCounter_RunningSibling(prox_counter);
+    if (sibling) {
+        prox_counter->active_psc = sibling->active_psc;
+        prox_counter->pending_psc = sibling->pending_psc;
+        prox_counter->requested_psc = sibling->requested_psc;
+    } else if (prox_counter->active_psc == 0) {
+        prox_counter->active_psc = prox_counter->htim->Init.Prescaler + 1U;
+        prox_counter->pending_psc = prox_counter->active_psc;
+        prox_counter->requested_psc = prox_counter->active_psc;
+    }
+    
+    if (prox_counter->capture_mode == PROXIMITY_CAPTURE_MODE_DMA) {
+        // Start DMA capture into the ring; fall back to interrupts if no DMA is linked
+        prox_counter->dma->half_events = 0;
+        prox_counter->dma->read_count = 0;
+        prox_counter->dma->mark_head = 0;
+        prox_counter->dma->mark_tail = 0;
+        prox_counter->dma->mark_last_raw = 0;
+        prox_counter->dma->segment_base = 0;
+        prox_counter->dma->psc = prox_counter->active_psc;
+        if (!prox_counter->htim->hdma[TIM_DMA_ID_CC1 + prox_counter->channel / 4U] ||
+            HAL_TIM_IC_Start_DMA(prox_counter->htim, prox_counter->channel,
+                                 (uint32_t *)prox_counter->dma->buffer,
+                                 PROXIMITY_DMA_BUFFER_SIZE) != HAL_OK) {
+            prox_counter->capture_mode = PROXIMITY_CAPTURE_MODE_IT;
+        }
+    }
+    if (prox_counter->capture_mode == PROXIMITY_CAPTURE_MODE_IT) {
+        // Start input capture interrupt
+        HAL_TIM_IC_Start_IT(prox_counter->htim, prox_counter->channel);
+    }
+    if (prox_counter->direction_sensing) {
+        HAL_TIM_IC_Start_IT(prox_counter->htim, prox_counter->dir_channel);
+    }
+    if (prox_counter->pulse_width) {
+        HAL_TIM_IC_Start_IT(prox_counter->htim, prox_counter->pw_channel);
+    }
+    HAL_TIM_Base_Start_IT(prox_counter->htim);  // Enable overflow interrupt
+    prox_counter->running = 1;
+}
+
+/**
+ * @brief Stop proximity counter measurement
+ */
+void ProximityCounter_Stop(ProximityCounter_t *prox_counter) {
+    if (!prox_counter || !prox_counter->htim) {
+        return;
+    }
+    
+    // Stop input capture interrupt / DMA
+    if (prox_counter->capture_mode == PROXIMITY_CAPTURE_MODE_DMA) {
+        HAL_TIM_IC_Stop_DMA(prox_counter->htim, prox_counter->channel);
+    } else {
+        HAL_TIM_IC_Stop_IT(prox_counter->htim, prox_counter->channel);
+    }
+    if (prox_counter->direction_sensing) {
+        HAL_TIM_IC_Stop_IT(prox_counter->htim, prox_counter->dir_channel);
+    }
+    if (prox_counter->pulse_width) {
+        HAL_TIM_IC_Stop_IT(prox_counter->htim, prox_counter->pw_channel);
+    }
+    prox_counter->running = 0;
+    
+    // The update interrupt keeps the other channels' timebase going
+    if (!ProximityCounter_RunningSibling(prox_counter)) {
+        HAL_TIM_Base_Stop_IT(prox_counter->htim);
+    }
+}
+
+/**
+ * @brief Stop an instance and hand its timer channels back
+ */
+void ProximityCounter_DeInit(ProximityCounter_t *prox_counter) {
+    if (!prox_counter || !prox_counter->htim) {
+        return;
+    }
+    
+    ProximityCounter_Stop(prox_counter);
+    if (prox_counter->direction_sensing) {
+        ProximityCounter_SetDirectionSensor(prox_counter, false, 0U);
+    }
+    if (prox_counter->pulse_width) {
+        ProximityCounter_SetPulseWidth(prox_counter, false, false);
+    }
+    ProximityCounter_Unregister(prox_counter);
+}
+
+/**
+ * @brief Process new capture data and calculate RPM
+ */
+void ProximityCounter_ProcessCapture(ProximityCounter_t *prox_counter) {
+    if (!prox_counter) {
+        return;
+    }
+    
+    if (prox_counter->capture_mode == PROXIMITY_CAPTURE_MODE_DMA) {
+        ProximityCounter_DmaConsume(prox_counter);
+    }
+    if (prox_counter->method == PROXIMITY_METHOD_MT) {
+        ProximityCounter_CloseGate(prox_counter);
+    }
+    if (prox_counter->tooth_cal) {
+        ProximityCounter_ToothService(prox_counter);
+    }
+    if (prox_counter->max_irq_hz > 0U) {
+        ProximityCounter_UpdateInputStage(prox_counter);
+    }
+    if (prox_counter->trace) {
+        ProximityCounter_TraceService(prox_counter->trace);
+    }
+    RpmStats_Tick(&prox_counter->stats, HAL_GetTick());
+    if (prox_counter->history) {
+        RpmHistory_Tick(prox_counter->history, HAL_GetTick(),
+                        (int32_t)(prox_counter->rpm * (float)RPM_FILTER_Q_ONE));
+    }
+    
+    if (!prox_counter->new_capture_ready) {
+        return;
+    }
+    
+    prox_counter->new_capture_ready = 0;  // Clear flag
+    
+    if (prox_counter->pulse_width) {
+        ProximityCounter_UpdateDuty(prox_counter);
+    }
+    
+    // Calculate RPM from captured difference
+    if (prox_counter->difference > 0) {
+        // Q8 RPM = TIMCLOCK * 60 * 256 / (clocks per period * PPR)
+        uint64_t divisor = (uint64_t)prox_counter->difference * prox_counter->ppr;
+        uint64_t rpm_raw = ((uint64_t)PROXIMITY_TIMCLOCK * 60U << RPM_FILTER_Q_SHIFT) / divisor;
+        if (rpm_raw > INT32_MAX) {
+            rpm_raw = INT32_MAX;
+        }
+        
+        int32_t rpm_q8;
+        if (prox_counter->tracking) {
+            rpm_q8 = ProximityCounter_Track(prox_counter, (int32_t)rpm_raw);
+        } else {
+            rpm_q8 = RpmFilter_Process(&prox_counter->filter, (int32_t)rpm_raw,
+                                       prox_counter->hysteresis_table,
+                                       prox_counter->hysteresis_table_size);
+        }
+        prox_counter->rpm = (float)rpm_q8 / (float)RPM_FILTER_Q_ONE;
+        prox_counter->stopped = 0;
+        RpmStats_Add(&prox_counter->stats, rpm_q8);
+        RpmHistory_Add(prox_counter->history, rpm_q8);
+        
+        if (prox_counter->trace && prox_counter->trace->overspeed_rpm > 0U &&
+            prox_counter->rpm > (float)prox_counter->trace->overspeed_rpm) {
+            ProximityCounter_TriggerTrace(prox_counter, PROXIMITY_TRIGGER_OVERSPEED);
+        }
+        
+        if (prox_counter->max_accel > 0U) {
+            ProximityCounter_UpdateGlitchBound(prox_counter, prox_counter->difference);
+        }
+        if (prox_counter->auto_range) {
+            ProximityCounter_UpdateRange(prox_counter, prox_counter->difference);
+        }
+    }
+}
+
+/**
+ * @brief Check for timeout and reset if no pulses detected
+ */
+void ProximityCounter_CheckTimeout(ProximityCounter_t *prox_counter) {
+    if (!prox_counter) {
+        return;
+    }
+    
+    // The capture ISR stamps the edge; read it before taking now
+    __disable_irq();
+    uint64_t last_edge = prox_counter->last_capture_cycles;
+    uint8_t sync_state = prox_counter->sync_state;
+    uint32_t tooth = prox_counter->sync_tooth;
+    __enable_irq();
+    uint64_t idle_us = Timebase_CyclesToMicros(Timebase_GetCycles() - last_edge);
+    uint32_t period = prox_counter->difference;
+    // The interval in progress may be the reference gap (missing_teeth + 1 pitches)
+    // unless sync says the next edge is a normal tooth
+    uint32_t span = prox_counter->missing_teeth + 1U;
+    if (sync_state == PROXIMITY_SYNC_SYNCED && tooth + span < prox_counter->ppr) {
+        span = 1U;
+    }
+    // ICPSC leaves ic_div pitches between captures
+    uint32_t pitches = span * prox_counter->ic_div;
+    uint64_t expected = (uint64_t)period * pitches;
+    if (idle_us > (uint64_t)prox_counter->timeout_ms * 1000U) {
+        ProximityCounter_DeclareStop(prox_counter);
+        return;
+    }
+    if (prox_counter->stopped || period == 0U) {
+        return;
+    }
+    if (prox_counter->tracking && prox_counter->tracker.valid) {
+        // Extrapolate along the tracked acceleration until the next output
+        uint64_t since_us = Timebase_GetMicros() - prox_counter->tracker_us;
+        int32_t rpm_q8 = RpmTracker_Predict(&prox_counter->tracker,
+                                            (since_us > UINT32_MAX) ? UINT32_MAX : (uint32_t)since_us);
+        prox_counter->rpm = (float)rpm_q8 / (float)RPM_FILTER_Q_ONE;
+    }
+    uint64_t idle_clocks = idle_us * (PROXIMITY_TIMCLOCK / 1000000UL);
+    if (idle_clocks > expected * prox_counter->stop_periods) {
+        ProximityCounter_DeclareStop(prox_counter);
+    } else if (idle_clocks > expected) {
+        // The capture interval in progress is already longer than idle_clocks
+        float bound = (float)PROXIMITY_TIMCLOCK * 60.0f * (float)pitches /
+                      ((float)idle_clocks * (float)prox_counter->ppr);
+        if (bound < prox_counter->rpm) {
+            prox_counter->rpm = bound;
+        }
+    }
+}
+
+/**
+ * @brief Get current RPM value
+ */
+float ProximityCounter_GetRPM(const ProximityCounter_t *prox_counter) {
+    if (!prox_counter) {
+        return 0.0f;
+    }
+    return prox_counter->rpm;
+}
+
+/**
+ * @brief Get current frequency in Hz
+ */
+float ProximityCounter_GetFrequency(const ProximityCounter_t *prox_counter) {
+    if (!prox_counter) {
+        return 0.0f;
+    }
+    return prox_counter->rpm / 60.0f * prox_counter->ppr;
+}
+
+/**
+ * @brief Set PPR (Pulses Per Revolution)
+ */
+void ProximityCounter_SetPPR(ProximityCounter_t *prox_counter, uint32_t ppr) {
+    if (!prox_counter || ppr == 0) {
+        return;
+    }
+    prox_counter->ppr = ppr;
+}
+
+/**
+ * @brief Set diameter
+ */
+void ProximityCounter_SetDiameter(ProximityCounter_t *prox_counter, float diameter) {
+    if (!prox_counter || diameter <= 0.0f) {
+        return;
+    }
+    prox_counter->diameter = diameter;
+}
+
+/**
+ * @brief Set timeout value
+ */
+void ProximityCounter_SetTimeout(ProximityCounter_t *prox_counter, uint32_t timeout_ms) {
+    if (!prox_counter || timeout_ms == 0) {
+        return;
+    }
+    prox_counter->timeout_ms = timeout_ms;
+}
+
+/**
+ * @brief Reset all measurement states
+ */
+void ProximityCounter_Reset(ProximityCounter_t *prox_counter) {
+    if (!prox_counter) {
+        return;
+    }
+    
+    // Reset measurement variables
+    prox_counter->rpm = 0.0f;
+    prox_counter->stopped = 1;
+    prox_counter->glitch_min_period = 0;
+    prox_counter->glitch_run = 0;
+    prox_counter->ic_val1 = 0;
+    prox_counter->ic_val2 = 0;
+    prox_counter->difference = 0;
+    prox_counter->is_first_captured = 0;
+    prox_counter->new_capture_ready = 0;
+    prox_counter->pw_fall_ts = 0;
+    
+    // Reset averaging variables
+    prox_counter->period_sum = 0;
+    prox_counter->period_count = 0;
+    prox_counter->window_head = 0;
+    prox_counter->first_measurement = 1;
+    prox_counter->gate_edges = 0;
+    prox_counter->gate_start_us = Timebase_GetMicros();
+    
+    // Reset filter state
+    RpmFilter_Reset(&prox_counter->filter);
+    RpmTracker_Reset(&prox_counter->tracker);
+    ProximityCounter_ToothRestart(prox_counter, true);
+    ProximityCounter_SyncRestart(prox_counter);
+    
+    // Measure from every edge again; ProcessCapture divides once the rate is known
+    if (prox_counter->max_irq_hz > 0U && prox_counter->htim) {
+        ProximityCounter_SetInputStage(prox_counter, 1U);
+    }
+    
+    // Skip captures already queued in the DMA ring
+    if (prox_counter->capture_mode == PROXIMITY_CAPTURE_MODE_DMA) {
+        ProximityCounter_DmaResync(prox_counter);
+    }
+    
+    // Update timestamp
+    prox_counter->last_capture_cycles = Timebase_GetCycles();
+}
+
+/**
+ * @brief Update proximity counter configuration
+ */
+void ProximityCounter_UpdateConfig(ProximityCounter_t *prox_counter, uint32_t ppr, float diameter) {
+    if (!prox_counter) {
+        return;
+    }
+    
+    prox_counter->ppr = ppr > 0 ? ppr : 1;
+    prox_counter->diameter = diameter > 0.0f ? diameter : 0.25f;
+    
+    // Reset measurement to apply new config
+    ProximityCounter_Reset(prox_counter);
+}
+
+/**
+ * @brief Handle input capture callback - call this from HAL_TIM_IC_CaptureCallback
+ */
+void ProximityCounter_HandleCapture(ProximityCounter_t *prox_counter, TIM_HandleTypeDef *htim) {
+    if (!prox_counter || !htim || htim != prox_counter->htim) {
+        return;
+    }
+    
+    if (htim->Channel == prox_counter->active_channel) {
+        if (prox_counter->capture_mode == PROXIMITY_CAPTURE_MODE_DMA) {
+            // Transfer complete: second half of the ring is full
+            prox_counter->dma->half_events++;
+            return;
+        }
+        
+        uint16_t capture = HAL_TIM_ReadCapturedValue(htim, prox_counter->channel);
+        uint64_t timestamp = ProximityCounter_ExtendCapture(prox_counter, capture);
+        uint32_t pitches = prox_counter->ic_div;  // ICPSC: edges this capture closes
+        if (prox_counter->trace) {
+            ProximityCounter_TraceStore(prox_counter->trace, timestamp);
+        }
+        
+        // Drop impossible edges; the period runs on to the next real edge
+        if (prox_counter->is_first_captured &&
+            ProximityCounter_RejectGlitch(prox_counter, (timestamp - prox_counter->last_timestamp) / pitches)) {
+            return;
+        }
+        
+        if (prox_counter->direction_sensing) {
+            ProximityCounter_DirectionEdge(prox_counter, timestamp);
+        }
+        if (prox_counter->pulse_width) {
+            ProximityCounter_PulseRise(prox_counter, timestamp);
+        }
+        
+        // Missing-tooth wheels: locate the gap, which spans several pitches
+        if (prox_counter->missing_teeth > 0U && prox_counter->is_first_captured) {
+            pitches = ProximityCounter_SyncEdge(prox_counter, timestamp - prox_counter->last_timestamp);
+        }
+        
+        if (prox_counter->method == PROXIMITY_METHOD_MT) {
+            // M/T: only count the edge, ProcessCapture closes the gate
+            ProximityCounter_GateEdge(prox_counter, timestamp, pitches);
+        } else if (prox_counter->is_first_captured == 0) {
+            // First rising edge - store initial value
+            prox_counter->ic_val1 = capture;
+            prox_counter->is_first_captured = 1;
+            ProximityCounter_ToothPeriod(prox_counter, 0);
+        } else {
+            // Second rising edge - period from extended timestamps
+            uint64_t elapsed = timestamp - prox_counter->last_timestamp;
+            uint32_t period = ((elapsed > UINT32_MAX) ? UINT32_MAX : (uint32_t)elapsed) / pitches;
+            prox_counter->ic_val2 = capture;
+            ProximityCounter_AddPeriod(prox_counter, ProximityCounter_ToothPeriod(prox_counter, period), timestamp);
+            prox_counter->ic_val1 = prox_counter->ic_val2;
+        }
+        
+        prox_counter->last_timestamp = timestamp;
+        prox_counter->last_capture_cycles = Timebase_GetCycles();
+    } else if (prox_counter->direction_sensing && htim->Channel == prox_counter->dir_active_channel) {
+        // B sensor: only its time is kept, the A edge does the rest
+        uint16_t capture = HAL_TIM_ReadCapturedValue(htim, prox_counter->dir_channel);
+        prox_counter->dir_b_ts = ProximityCounter_ExtendCapture(prox_counter, capture);
+    } else if (prox_counter->pulse_width && htim->Channel == prox_counter->pw_active_channel) {
+        // Falling edge of the same input on the paired channel
+        uint16_t capture = HAL_TIM_ReadCapturedValue(htim, prox_counter->pw_channel);
+        ProximityCounter_PulseFall(prox_counter, ProximityCounter_ExtendCapture(prox_counter, capture));
+    }
+}
+
+/**
+ * @brief Handle DMA half-transfer callback - call this from HAL_TIM_IC_CaptureHalfCpltCallback
+ */
+void ProximityCounter_HandleCaptureHalf(ProximityCounter_t *prox_counter, TIM_HandleTypeDef *htim) {
+    if (!prox_counter || !htim || htim != prox_counter->htim) {
+        return;
+    }
+    
+    if (htim->Channel == prox_counter->active_channel &&
+        prox_counter->capture_mode == PROXIMITY_CAPTURE_MODE_DMA) {
+        prox_counter->dma->half_events++;
+    }
+}
+
+/**
+ * @brief Handle timer overflow callback - call this from HAL_TIM_PeriodElapsedCallback
+ */
+void ProximityCounter_HandleOverflow(ProximityCounter_t *prox_counter, TIM_HandleTypeDef *htim) {
+    if (!prox_counter || !htim || htim != prox_counter->htim) {
+        return;
+    }
+    
+    // The hardware loaded pending_psc at this update
+    prox_counter->timer_wraps++;
+    prox_counter->segment_base += PROXIMITY_TIMER_PERIOD * prox_counter->active_psc;
+    prox_counter->active_psc = prox_counter->pending_psc;
+    
+    if (prox_counter->capture_mode == PROXIMITY_CAPTURE_MODE_DMA) {
+        // Record which capture follows this wrap. A capture written before we
+        // got here but with a value not above CNT was taken after the wrap.
+        uint16_t counter = __HAL_TIM_GET_COUNTER(htim);
+        uint32_t raw = ProximityCounter_DmaWriteCount(prox_counter);
+        uint32_t mark = raw;
+        if (raw != prox_counter->dma->mark_last_raw &&
+            prox_counter->dma->buffer[(raw - 1U) & PROXIMITY_DMA_INDEX_MASK] <= counter) {
+            mark = raw - 1U;
+        }
+        prox_counter->dma->mark_last_raw = raw;
+        
+        // No capture since the last wrap at the same division: extend its run
+        uint32_t head = prox_counter->dma->mark_head;
+        uint32_t last = (head - 1U) & PROXIMITY_DMA_MARK_MASK;
+        if (head != prox_counter->dma->mark_tail && prox_counter->dma->marks[last] == mark &&
+            prox_counter->dma->mark_psc[last] == prox_counter->active_psc) {
+            prox_counter->dma->mark_wraps[last]++;
+        } else {
+            prox_counter->dma->marks[head & PROXIMITY_DMA_MARK_MASK] = mark;
+            prox_counter->dma->mark_wraps[head & PROXIMITY_DMA_MARK_MASK] = 1U;
+            prox_counter->dma->mark_psc[head & PROXIMITY_DMA_MARK_MASK] = prox_counter->active_psc;
+            prox_counter->dma->mark_head = head + 1U;
+        }
+    }
+    
+    // Range change: PSC is preloaded, so it starts counting at the next update,
+    // a full timer period away from here
+    if (prox_counter->requested_psc != prox_counter->pending_psc) {
+        __HAL_TIM_SET_PRESCALER(htim, prox_counter->requested_psc - 1U);
+        prox_counter->pending_psc = prox_counter->requested_psc;
+    }
+}
+
+/**
+ * @brief Route a capture event to the instance bound to htim/htim->Channel
+ */
+void ProximityCounter_DispatchCapture(TIM_HandleTypeDef *htim) {
+    int32_t slot = ProximityCounter_TimerSlot(htim);
+    int8_t index = proximity_active_index[htim->Channel & 0x0FU];
+    
+    if (slot >= 0 && index >= 0 && proximity_dispatch[slot][index]) {
+        ProximityCounter_HandleCapture(proximity_dispatch[slot][index], htim);
+    }
+}
+
+/**
+ * @brief Route a DMA half-transfer event to the instance bound to htim/htim->Channel
+ */
+void ProximityCounter_DispatchCaptureHalf(TIM_HandleTypeDef *htim) {
+    int32_t slot = ProximityCounter_TimerSlot(htim);
+    int8_t index = proximity_active_index[htim->Channel & 0x0FU];
+    
+    if (slot >= 0 && index >= 0 && proximity_dispatch[slot][index]) {
+        ProximityCounter_HandleCaptureHalf(proximity_dispatch[slot][index], htim);
+    }
+}
+
+/**
+ * @brief Route a timer update to every running instance on htim
+ */
+void ProximityCounter_DispatchOverflow(TIM_HandleTypeDef *htim) {
+    int32_t slot = ProximityCounter_TimerSlot(htim);
+    if (slot < 0) {
+        return;
+    }
+    
+    for (uint32_t c = 0; c < PROXIMITY_MAX_CHANNELS; c++) {
+        ProximityCounter_t *prox_counter = proximity_dispatch[slot][c];
+        // A direction sensor slot points at its A instance; count the wrap once
+        if (prox_counter && prox_counter->running && prox_counter->channel / 4U == c) {
+            ProximityCounter_HandleOverflow(prox_counter, htim);
+        }
+    }
+}
+
+/**
+ * @brief Get the current extended timer value
+ */
+uint64_t ProximityCounter_GetTimestamp(const ProximityCounter_t *prox_counter) {
+    if (!prox_counter || !prox_counter->htim) {
+        return 0;
+    }
+    
+    uint32_t wraps;
+    uint64_t base;
+    uint32_t active;
+    uint32_t next;
+    uint16_t counter;
+    bool pending;
+    
+    // Retry if the update ISR ran while sampling
+    do {
+        wraps = prox_counter->timer_wraps;
+        base = prox_counter->segment_base;
+        active = prox_counter->active_psc;
+        next = prox_counter->pending_psc;
+        counter = __HAL_TIM_GET_COUNTER(prox_counter->htim);
+        pending = __HAL_TIM_GET_FLAG(prox_counter->htim, TIM_FLAG_UPDATE);
+    } while (wraps != prox_counter->timer_wraps);
+    
+    if (pending && counter < 0x8000U) {
+        return base + PROXIMITY_TIMER_PERIOD * active + (uint64_t)counter * next;
+    }
+    return base + (uint64_t)counter * active;
+}
+
+/**
+ * @brief Enable or disable automatic prescaler ranging
+ */
+void ProximityCounter_SetAutoRange(ProximityCounter_t *prox_counter, bool enable) {
+    if (!prox_counter || !prox_counter->htim) {
+        return;
+    }
+    
+    prox_counter->auto_range = enable ? 1 : 0;
+    if (!enable) {
+        prox_counter->requested_psc = prox_counter->htim->Init.Prescaler + 1U;
+    }
+}
+
+/**
+ * @brief Select T-method or M/T speed measurement
+ */
+void ProximityCounter_SetMethod(ProximityCounter_t *prox_counter, ProximityMethod_t method, uint32_t gate_ms) {
+    if (!prox_counter) {
+        return;
+    }
+    
+    prox_counter->method = method;
+    prox_counter->gate_ms = gate_ms > 0 ? gate_ms : PROXIMITY_MT_DEFAULT_GATE_MS;
+    
+    // Restart the measurement chain in the new method
+    ProximityCounter_Reset(prox_counter);
+}
+
+/**
+ * @brief Enable the alpha-beta speed tracker in place of the filter chain
+ */
+void ProximityCounter_SetTracker(ProximityCounter_t *prox_counter, bool enable, uint16_t alpha_q8, uint16_t beta_q8) {
+    if (!prox_counter) {
+        return;
+    }
+    
+    RpmTracker_Init(&prox_counter->tracker, alpha_q8, beta_q8);
+    RpmFilter_Reset(&prox_counter->filter);
+    prox_counter->tracking = enable ? 1U : 0U;
+}
+
+/**
+ * @brief Set the acceleration limit used to reject glitch edges
+ */
+void ProximityCounter_SetMaxAccel(ProximityCounter_t *prox_counter, uint32_t max_accel) {
+    if (!prox_counter) {
+        return;
+    }
+    
+    prox_counter->max_accel = max_accel;
+    if (max_accel == 0U) {
+        prox_counter->glitch_min_period = 0;
+    }
+}
+
+/**
+ * @brief Get the share of edges rejected as glitches
+ */
+float ProximityCounter_GetRejectRatio(const ProximityCounter_t *prox_counter) {
+    if (!prox_counter || prox_counter->glitch_edges == 0U) {
+        return 0.0f;
+    }
+    return (float)prox_counter->glitch_rejects / (float)prox_counter->glitch_edges;
+}
+
+/**
+ * @brief Set the capture rate ceiling of the adaptive input stage
+ */
+void ProximityCounter_SetIrqCeiling(ProximityCounter_t *prox_counter, uint32_t max_irq_hz) {
+    if (!prox_counter || !prox_counter->htim) {
+        return;
+    }
+    
+    prox_counter->max_irq_hz = max_irq_hz;
+    // Back to every edge (and the original filter without a ceiling)
+    ProximityCounter_SetInputStage(prox_counter, 1U);
+}
+
+/**
+ * @brief Get the edges per capture of the input stage
+ */
+uint32_t ProximityCounter_GetEdgeDivider(const ProximityCounter_t *prox_counter) {
+    if (!prox_counter) {
+        return 1;
+    }
+    return prox_counter->ic_div;
+}
+
+/**
+ * @brief Get the capture rate the measured speed produces
+ */
+float ProximityCounter_GetCaptureRate(const ProximityCounter_t *prox_counter) {
+    if (!prox_counter || prox_counter->stopped || prox_counter->difference == 0U) {
+        return 0.0f;
+    }
+    return (float)PROXIMITY_TIMCLOCK / ((float)prox_counter->difference * (float)prox_counter->ic_div);
+}
+
+/**
+ * @brief Attach a tooth calibration object
+ */
+void ProximityCounter_SetToothCal(ProximityCounter_t *prox_counter, ProximityToothCal_t *cal) {
+    if (!prox_counter) {
+        return;
+    }
+    
+    if (cal) {
+        cal->state = PROXIMITY_TOOTH_OFF;
+    }
+    __disable_irq();
+    prox_counter->tooth_cal = cal;
+    prox_counter->tooth_index = 0;
+    __enable_irq();
+}
+
+/**
+ * @brief Learn the spacing of every tooth
+ */
+bool ProximityCounter_StartToothLearn(ProximityCounter_t *prox_counter, uint32_t revs) {
+    if (!prox_counter || !prox_counter->tooth_cal || prox_counter->missing_teeth > 0U ||
+        prox_counter->ppr < 2U || prox_counter->ppr > PROXIMITY_TOOTH_MAX) {
+        return false;
+    }
+    
+    ProximityToothCal_t *cal = prox_counter->tooth_cal;
+    __disable_irq();
+    cal->teeth = (uint8_t)prox_counter->ppr;
+    cal->target_revs = revs > 0U ? revs : PROXIMITY_TOOTH_DEFAULT_REVS;
+    cal->state = PROXIMITY_TOOTH_LEARN;
+    memset(cal->period_sum, 0, sizeof(cal->period_sum));
+    cal->revs = 0;
+    prox_counter->tooth_index = 0;
+    __enable_irq();
+    return true;
+}
+
+/**
+ * @brief Load a stored correction table
+ */
+bool ProximityCounter_LoadToothTable(ProximityCounter_t *prox_counter, const uint16_t *table, uint32_t teeth) {
+    if (!prox_counter || !prox_counter->tooth_cal || !table || prox_counter->missing_teeth > 0U ||
+        teeth != prox_counter->ppr || teeth < 2U || teeth > PROXIMITY_TOOTH_MAX) {
+        return false;
+    }
+    for (uint32_t i = 0; i < teeth; i++) {
+        if (table[i] == 0U) {
+            return false;
+        }
+    }
+    
+    ProximityToothCal_t *cal = prox_counter->tooth_cal;
+    __disable_irq();
+    cal->state = PROXIMITY_TOOTH_OFF;
+    __enable_irq();
+    memcpy(cal->correction_q14, table, teeth * sizeof(table[0]));
+    memset(cal->period_sum, 0, sizeof(cal->period_sum));
+    cal->teeth = (uint8_t)teeth;
+    cal->target_revs = 1U;
+    cal->revs = 0;
+    prox_counter->tooth_index = 0;
+    cal->state = PROXIMITY_TOOTH_ALIGN;
+    return true;
+}
+
+/**
+ * @brief Copy the learned correction table
+ */
+uint32_t ProximityCounter_GetToothTable(const ProximityCounter_t *prox_counter, uint16_t *table, uint32_t max) {
+    if (!prox_counter || !prox_counter->tooth_cal || !table) {
+        return 0;
+    }
+    
+    const ProximityToothCal_t *cal = prox_counter->tooth_cal;
+    if (cal->state != PROXIMITY_TOOTH_ACTIVE && cal->state != PROXIMITY_TOOTH_ALIGN) {
+        return 0;
+    }
+    if (cal->teeth > max) {
+        return 0;
+    }
+    memcpy(table, cal->correction_q14, cal->teeth * sizeof(table[0]));
+    return cal->teeth;
+}
+
+/**
+ * @brief Stop applying the tooth correction
+ */
+void ProximityCounter_ClearToothTable(ProximityCounter_t *prox_counter) {
+    if (!prox_counter || !prox_counter->tooth_cal) {
+        return;
+    }
+    prox_counter->tooth_cal->state = PROXIMITY_TOOTH_OFF;
+}
+
+/**
+ * @brief Get the tooth calibration state
+ */
+ProximityToothState_t ProximityCounter_GetToothState(const ProximityCounter_t *prox_counter) {
+    if (!prox_counter || !prox_counter->tooth_cal) {
+        return PROXIMITY_TOOTH_OFF;
+    }
+    return (ProximityToothState_t)prox_counter->tooth_cal->state;
+}
+
+/**
+ * @brief Get the speed statistics of the last closed window
+ */
+bool ProximityCounter_GetStats(const ProximityCounter_t *prox_counter, uint32_t window, RpmStatsResult_t *result) {
+    if (!prox_counter) {
+        return false;
+    }
+    return RpmStats_Get(&prox_counter->stats, window, result);
+}
+
+/**
+ * @brief Attach a speed history
+ */
+void ProximityCounter_SetHistory(ProximityCounter_t *prox_counter, RpmHistory_t *history) {
+    if (!prox_counter) {
+        return;
+    }
+    prox_counter->history = history;
+}
+
+/**
+ * @brief Attach a raw capture recorder
+ */
+void ProximityCounter_SetTrace(ProximityCounter_t *prox_counter, ProximityTrace_t *trace) {
+    if (!prox_counter) {
+        return;
+    }
+    
+    if (trace) {
+        memset(trace, 0, sizeof(ProximityTrace_t));
+        trace->pre = PROXIMITY_TRACE_DEFAULT_PRE;
+        trace->post = PROXIMITY_TRACE_DEFAULT_POST;
+        trace->stop = trace->head - 1U;
+    }
+    __disable_irq();
+    prox_counter->trace = trace;
+    __enable_irq();
+}
+
+/**
+ * @brief Set the trace window and automatic triggers, then re-arm
+ */
+bool ProximityCounter_SetTraceTrigger(ProximityCounter_t *prox_counter, uint32_t pre, uint32_t post,
+                                      uint32_t overspeed_rpm, bool on_glitch) {
+    if (!prox_counter || !prox_counter->trace || pre + post >= PROXIMITY_TRACE_SIZE) {
+        return false;
+    }
+    
+    ProximityTrace_t *trace = prox_counter->trace;
+    __disable_irq();
+    trace->pre = (uint16_t)pre;
+    trace->post = (uint16_t)post;
+    trace->overspeed_rpm = overspeed_rpm;
+    trace->on_glitch = on_glitch ? 1U : 0U;
+    __enable_irq();
+    ProximityCounter_ArmTrace(prox_counter);
+    return true;
+}
+
+/**
+ * @brief Drop the frozen block and record continuously again
+ */
+void ProximityCounter_ArmTrace(ProximityCounter_t *prox_counter) {
+    if (!prox_counter || !prox_counter->trace) {
+        return;
+    }
+    
+    ProximityTrace_t *trace = prox_counter->trace;
+    __disable_irq();
+    trace->head = 0;
+    trace->stop = UINT32_MAX;
+    trace->trigger = 0;
+    trace->cause = PROXIMITY_TRIGGER_NONE;
+    trace->state = PROXIMITY_TRACE_RECORDING;
+    __enable_irq();
+}
+
+/**
+ * @brief Fire the trace trigger
+ */
+void ProximityCounter_TriggerTrace(ProximityCounter_t *prox_counter, ProximityTrigger_t cause) {
+    if (!prox_counter || !prox_counter->trace) {
+        return;
+    }
+    
+    __disable_irq();
+    ProximityCounter_TraceFire(prox_counter->trace, cause);
+    __enable_irq();
+}
+
+/**
+ * @brief Get the recorder state
+ */
+ProximityTraceState_t ProximityCounter_GetTraceState(const ProximityCounter_t *prox_counter) {
+    if (!prox_counter || !prox_counter->trace) {
+        return PROXIMITY_TRACE_RECORDING;
+    }
+    return (ProximityTraceState_t)prox_counter->trace->state;
+}
+
+/**
+ * @brief Get the size of the frozen block
+ */
+uint32_t ProximityCounter_GetTraceLength(const ProximityCounter_t *prox_counter, uint32_t *trigger_at) {
+    if (trigger_at) {
+        *trigger_at = 0;
+    }
+    if (!prox_counter || !prox_counter->trace || prox_counter->trace->state != PROXIMITY_TRACE_FROZEN) {
+        return 0;
+    }
+    
+    const ProximityTrace_t *trace = prox_counter->trace;
+    uint32_t first = ProximityCounter_TraceFirst(trace);
+    if (trigger_at && trace->trigger != first) {
+        *trigger_at = trace->trigger - first - 1U;
+    }
+    uint32_t span = trace->stop - first;  // Captures in the block, index may have wrapped
+    return (span > 0U) ? span - 1U : 0U;
+}
+
+/**
+ * @brief Copy periods of the frozen block
+ */
+uint32_t ProximityCounter_ReadTrace(const ProximityCounter_t *prox_counter, uint32_t offset,
+                                    uint32_t *periods, uint32_t max) {
+    uint32_t length = ProximityCounter_GetTraceLength(prox_counter, NULL);
+    if (!periods || offset >= length) {
+        return 0;
+    }
+    
+    const ProximityTrace_t *trace = prox_counter->trace;
+    uint32_t index = ProximityCounter_TraceFirst(trace) + offset;
+    uint32_t count = 0;
+    while (count < max && offset + count < length) {
+        periods[count++] = trace->samples[(index + 1U) & PROXIMITY_TRACE_MASK] -
+                           trace->samples[index & PROXIMITY_TRACE_MASK];
+        index++;
+    }
+    return count;
+}
+
+/**
+ * @brief Derive direction from a second, phase-shifted sensor
+ */
+bool ProximityCounter_SetDirectionSensor(ProximityCounter_t *prox_counter, bool enable, uint32_t channel) {
+    if (!prox_counter || !prox_counter->htim) {
+        return false;
+    }
+    int32_t slot = ProximityCounter_TimerSlot(prox_counter->htim);
+    channel &= TIM_CHANNEL_4;
+    if (slot < 0 || (enable && (channel == prox_counter->channel || prox_counter->pulse_width))) {
+        return false;
+    }
+    // Never take the B channel from another instance
+    ProximityCounter_t *owner = proximity_dispatch[slot][channel / 4U];
+    if (enable && owner && owner != prox_counter) {
+        return false;
+    }
+    
+    bool was_running = prox_counter->running;
+    if (was_running) {
+        ProximityCounter_Stop(prox_counter);
+    }
+    
+    // Release the previous B channel
+    if (prox_counter->direction_sensing) {
+        if (proximity_dispatch[slot][prox_counter->dir_channel / 4U] == prox_counter) {
+            proximity_dispatch[slot][prox_counter->dir_channel / 4U] = NULL;
+        }
+        prox_counter->capture_mode = prox_counter->dir_saved_mode;
+        prox_counter->direction_sensing = 0;
+    }
+    
+    if (enable) {
+        prox_counter->dir_channel = channel;
+        prox_counter->dir_active_channel = (HAL_TIM_ActiveChannel)(HAL_TIM_ACTIVE_CHANNEL_1 << (channel / 4U));
+        prox_counter->dir_saved_mode = prox_counter->capture_mode;
+        prox_counter->capture_mode = PROXIMITY_CAPTURE_MODE_IT;
+        proximity_dispatch[slot][channel / 4U] = prox_counter;
+        prox_counter->direction_sensing = 1;
+    }
+    prox_counter->direction = 0;
+    prox_counter->dir_candidate = 0;
+    prox_counter->dir_b_ts = 0;
+    
+    if (was_running) {
+        ProximityCounter_Start(prox_counter);
+    }
+    return true;
+}
+
+/**
+ * @brief Measure pulse high time and duty with the paired channel
+ */
+bool ProximityCounter_SetPulseWidth(ProximityCounter_t *prox_counter, bool enable, bool both_edges) {
+    if (!prox_counter || !prox_counter->htim) {
+        return false;
+    }
+    int32_t slot = ProximityCounter_TimerSlot(prox_counter->htim);
+    uint32_t pair = prox_counter->channel ^ TIM_CHANNEL_2;
+    if (slot < 0 || (enable && prox_counter->direction_sensing)) {
+        return false;
+    }
+    // Never reconfigure or take the paired channel from another instance
+    ProximityCounter_t *owner = proximity_dispatch[slot][pair / 4U];
+    if (enable && owner && owner != prox_counter) {
+        return false;
+    }
+    
+    bool was_running = prox_counter->running;
+    if (was_running) {
+        ProximityCounter_Stop(prox_counter);
+    }
+    
+    TIM_IC_InitTypeDef ic = {
+        .ICPolarity = TIM_INPUTCHANNELPOLARITY_RISING,
+        .ICSelection = TIM_ICSELECTION_DIRECTTI,
+        .ICPrescaler = TIM_ICPSC_DIV1,
+        .ICFilter = ProximityCounter_ChannelFilter(prox_counter)
+    };
+    if (prox_counter->pulse_width) {
+        // Give the paired channel its own pin back
+        if (proximity_dispatch[slot][pair / 4U] == prox_counter) {
+            proximity_dispatch[slot][pair / 4U] = NULL;
+        }
+        HAL_TIM_IC_ConfigChannel(prox_counter->htim, &ic, pair);
+        prox_counter->capture_mode = prox_counter->pw_saved_mode;
+        prox_counter->pulse_width = 0;
+    }
+    
+    if (enable) {
+        ic.ICPolarity = TIM_INPUTCHANNELPOLARITY_FALLING;
+        ic.ICSelection = TIM_ICSELECTION_INDIRECTTI;
+        HAL_TIM_IC_ConfigChannel(prox_counter->htim, &ic, pair);
+        prox_counter->pw_channel = pair;
+        prox_counter->pw_active_channel = (HAL_TIM_ActiveChannel)(HAL_TIM_ACTIVE_CHANNEL_1 << (pair / 4U));
+        prox_counter->pw_saved_mode = prox_counter->capture_mode;
+        prox_counter->capture_mode = PROXIMITY_CAPTURE_MODE_IT;
+        proximity_dispatch[slot][pair / 4U] = prox_counter;
+        prox_counter->pulse_width = 1;
+    }
+    prox_counter->both_edges = (enable && both_edges) ? 1U : 0U;
+    prox_counter->pw_high = 0;
+    prox_counter->pw_period = 0;
+    prox_counter->duty_avg = 0.0f;
+    
+    if (was_running) {
+        ProximityCounter_Start(prox_counter);
+    }
+    return true;
+}
+
+/**
+ * @brief Get high time, period and duty of the same pulse
+ */
+bool ProximityCounter_GetPulse(const ProximityCounter_t *prox_counter, ProximityPulse_t *pulse) {
+    if (!prox_counter || !pulse || !prox_counter->pulse_width) {
+        return false;
+    }
+    
+    // The capture ISR writes the pair
+    __disable_irq();
+    uint32_t high = prox_counter->pw_high;
+    uint32_t period = prox_counter->pw_period;
+    __enable_irq();
+    
+    if (period == 0U) {
+        return false;
+    }
+    const float clocks_per_us = (float)(PROXIMITY_TIMCLOCK / 1000000UL);
+    pulse->high_us = (float)high / clocks_per_us;
+    pulse->period_us = (float)period / clocks_per_us;
+    pulse->duty = (float)high / (float)period;
+    pulse->duty_avg = prox_counter->duty_avg;
+    pulse->drift = (prox_counter->duty_ref > 0.0f) ? prox_counter->duty_avg - prox_counter->duty_ref : 0.0f;
+    return true;
+}
+
+/**
+ * @brief Set the duty that drift is reported against
+ */
+void ProximityCounter_SetDutyReference(ProximityCounter_t *prox_counter, float duty) {
+    if (!prox_counter) {
+        return;
+    }
+    prox_counter->duty_ref = (duty < 0.0f) ? prox_counter->duty_avg : duty;
+}
+
+/**
+ * @brief Get the direction of rotation
+ */
+int32_t ProximityCounter_GetDirection(const ProximityCounter_t *prox_counter) {
+    if (!prox_counter || !prox_counter->direction_sensing) {
+        return 0;
+    }
+    return prox_counter->direction;
+}
+
+/**
+ * @brief Get RPM signed by the direction of rotation
+ */
+float ProximityCounter_GetSignedRPM(const ProximityCounter_t *prox_counter) {
+    if (!prox_counter) {
+        return 0.0f;
+    }
+    return (ProximityCounter_GetDirection(prox_counter) < 0) ? -prox_counter->rpm : prox_counter->rpm;
+}
+
+/**
+ * @brief Get the signed pulse total
+ */
+int64_t ProximityCounter_GetPosition(const ProximityCounter_t *prox_counter) {
+    if (!prox_counter) {
+        return 0;
+    }
+    
+    // Written by the capture ISR, not atomic on a 32-bit core
+    __disable_irq();
+    int64_t position = prox_counter->position;
+    __enable_irq();
+    return position;
+}
+
+/**
+ * @brief Configure the missing-tooth reference gap
+ */
+bool ProximityCounter_SetMissingTeeth(ProximityCounter_t *prox_counter, uint32_t missing_teeth) {
+    if (!prox_counter || missing_teeth > PROXIMITY_SYNC_MAX_MISSING ||
+        (missing_teeth > 0U && prox_counter->ppr < missing_teeth + 3U)) {
+        return false;
+    }
+    
+    __disable_irq();
+    prox_counter->missing_teeth = missing_teeth;
+    prox_counter->sync_state = PROXIMITY_SYNC_SEARCHING;
+    prox_counter->sync_period = 0;
+    prox_counter->sync_tooth = 0;
+    __enable_irq();
+    if (missing_teeth > 0U) {
+        ProximityCounter_ClearToothTable(prox_counter);
+    }
+    return true;
+}
+
+/**
+ * @brief Get the synchronisation state
+ */
+ProximitySyncState_t ProximityCounter_GetSyncState(const ProximityCounter_t *prox_counter) {
+    if (!prox_counter) {
+        return PROXIMITY_SYNC_SEARCHING;
+    }
+    return (ProximitySyncState_t)prox_counter->sync_state;
+}
+
+/**
+ * @brief Get the absolute shaft angle
+ */
+float ProximityCounter_GetAngle(const ProximityCounter_t *prox_counter) {
+    if (!prox_counter || prox_counter->missing_teeth == 0U ||
+        prox_counter->sync_state != PROXIMITY_SYNC_SYNCED) {
+        return -1.0f;
+    }
+    
+    // The capture ISR writes these in interrupt mode
+    __disable_irq();
+    uint32_t tooth = prox_counter->sync_tooth;
+    uint32_t period = prox_counter->sync_period;
+    uint64_t last = prox_counter->last_timestamp;
+    __enable_irq();
+    
+    uint64_t now = ProximityCounter_GetTimestamp(prox_counter);
+    float travel = 0.0f;
+    if (period > 0U && now > last) {
+        travel = (float)(now - last) / (float)period;
+    }
+    // Never run past the next edge: one pitch, or the whole gap after the last tooth
+    float limit = (tooth + 1U + prox_counter->missing_teeth >= prox_counter->ppr)
+                ? (float)(prox_counter->missing_teeth + 1U) : 1.0f;
+    if (travel > limit) {
+        travel = limit;
+    }
+    
+    float angle = ((float)tooth + travel) * 360.0f / (float)prox_counter->ppr;
+    return (angle >= 360.0f) ? angle - 360.0f : angle;
+}
+
+/**
+ * @brief Get tracked acceleration
+ */
+float ProximityCounter_GetAcceleration(const ProximityCounter_t *prox_counter) {
+    if (!prox_counter || !prox_counter->tracking) {
+        return 0.0f;
+    }
+    return (float)prox_counter->tracker.accel_q8 / (float)RPM_FILTER_Q_ONE;
+}
+
+/**
+ * @brief Get the tracker's innovation variance
+ */
+float ProximityCounter_GetSpeedVariance(const ProximityCounter_t *prox_counter) {
+    if (!prox_counter || !prox_counter->tracking) {
+        return 0.0f;
+    }
+    return (float)prox_counter->tracker.variance;
+}
+
+/**
+ * @brief Check whether zero speed has been declared
+ */
+bool ProximityCounter_IsStopped(const ProximityCounter_t *prox_counter) {
+    if (!prox_counter) {
+        return true;
+    }
+    return prox_counter->stopped != 0;
+}
+
+/**
+ * @brief Get the prescaler division currently counting
+ */
+uint32_t ProximityCounter_GetPrescaler(const ProximityCounter_t *prox_counter) {
+    if (!prox_counter) {
+        return 0;
+    }
+    return prox_counter->active_psc;
+}
+
+/**
+ * @brief Select the filter chain applied to each RPM sample
+ */
+bool ProximityCounter_SetFilterChain(ProximityCounter_t *prox_counter, RpmFilterChain_t chain) {
+    if (!prox_counter) {
+        return false;
+    }
+    return RpmFilter_SetChain(&prox_counter->filter, chain);
+}
+
+/**
+ * @brief Select block or sliding-window period averaging
+ */
+void ProximityCounter_SetAveraging(ProximityCounter_t *prox_counter, ProximityAveraging_t averaging,
+                                   uint32_t samples, uint32_t window_ms) {
+    if (!prox_counter) {
+        return;
+    }
+    
+    ProximityCounter_ConfigAveraging(prox_counter, averaging, samples, window_ms);
+    
+    // Restart the average in the new mode
+    ProximityCounter_Reset(prox_counter);
+}
+
+/**
+ * @brief Set EMA weight and slew-rate limit of the filter chain
+ */
+bool ProximityCounter_SetFilterParams(ProximityCounter_t *prox_counter, uint16_t alpha_q8, uint32_t slew_rpm) {
+    if (!prox_counter) {
+        return false;
     }
+    return RpmFilter_SetParams(&prox_counter->filter, alpha_q8, slew_rpm);
 }
 
 /**
@@ -16,16 +16,78 @@ extern "C" {
 
 /* Includes ------------------------------------------------------------------*/
 #include "main.h"
+#include "rpm_filter.h"
+#include "rpm_stats.h"
+#include "rpm_history.h"
+#include "timebase/timebase.h"
 #include <stdint.h>
 #include <stdbool.h>
 
 /* Exported defines ----------------------------------------------------------*/
 #define PROXIMITY_MAX_RPM_ALLOWED   10000.0f
 #define PROXIMITY_NO_PULSE_TIMEOUT_MS 10000UL  // 10 seconds
+#define PROXIMITY_MT_DEFAULT_GATE_MS  100UL    // M/T output period
+#define PROXIMITY_STOP_PERIODS        2UL      // Zero speed after this many silent expected periods
+
+// Glitch rejection: edges closer than the predicted period allows are dropped
+#define PROXIMITY_GLITCH_JITTER       0.125f   // Period jitter tolerated on top of max_accel
+#define PROXIMITY_GLITCH_MAX_RUN      3U       // Consecutive rejects before the bound is dropped
+
+// Per-tooth spacing calibration (T-method), corrections are Q14 period multipliers
+#define PROXIMITY_TOOTH_MAX           64U      // Largest PPR a correction table covers
+#define PROXIMITY_TOOTH_Q_SHIFT       14
+#define PROXIMITY_TOOTH_DEFAULT_REVS  16UL     // Revolutions averaged by a learn run
+
+// Input stage: ICPSC captures every 2nd/4th/8th edge to keep the capture rate
+// under a ceiling; ICxF is the strongest filter the fastest edges still pass
+#define PROXIMITY_IC_MAX_DIV          8U
+#define PROXIMITY_IC_FILTER_BUDGET    8U       // Filter settle time <= shortest period / budget
+
+// Pulse width: duty average weight 1/2^shift per output, for drift against the reference
+#define PROXIMITY_DUTY_AVG_SHIFT      6
+
+// Missing-tooth reference: a period over (missing + 0.5) times the previous one is the gap
+#define PROXIMITY_SYNC_MAX_MISSING    3U
 #define PROXIMITY_TIMCLOCK   72000000UL
 #define PROXIMITY_PRESCALAR  72UL
 #define PROXIMITY_COUNTER_HZ (PROXIMITY_TIMCLOCK / PROXIMITY_PRESCALAR)
 #define PROXIMITY_HYSTERESIS_TABLE_SIZE 10
+#define PROXIMITY_MAX_CHANNELS          4U   // CH1..CH4 of one timer
+#define PROXIMITY_DISPATCH_TIMERS       3U   // TIM2, TIM3, TIM4
+
+// Auto-ranging: keep each period between MIN and MAX counter ticks by
+// stepping the TIM2 prescaler in powers of two (1 = 72 MHz ticks)
+#define PROXIMITY_RANGE_MIN_TICKS       16384UL
+#define PROXIMITY_RANGE_MAX_TICKS       65536UL
+#define PROXIMITY_RANGE_MAX_PRESCALER   32768UL
+
+// DMA capture mode: circular CCR1 timestamp ring (power of two, in captures)
+#ifndef PROXIMITY_DMA_BUFFER_SIZE
+#define PROXIMITY_DMA_BUFFER_SIZE 256U
+#endif
+#define PROXIMITY_DMA_MARK_COUNT  32U    // Wrap runs with captures between them, kept between two ProcessCapture calls
+
+// Sliding-window averaging: periods kept in the running-sum ring (power of two)
+#ifndef PROXIMITY_WINDOW_SIZE
+#define PROXIMITY_WINDOW_SIZE     32U
+#endif
+
+// Raw trace: capture timestamps kept in a ring (power of two), frozen around a trigger
+#ifndef PROXIMITY_TRACE_SIZE
+#define PROXIMITY_TRACE_SIZE      256U
+#endif
+#define PROXIMITY_TRACE_DEFAULT_PRE   128U   // Periods kept before the trigger
+#define PROXIMITY_TRACE_DEFAULT_POST  64U    // Periods recorded after it
+
+#if (PROXIMITY_DMA_BUFFER_SIZE & (PROXIMITY_DMA_BUFFER_SIZE - 1U)) != 0U
+#error "PROXIMITY_DMA_BUFFER_SIZE must be a power of two"
+#endif
+#if (PROXIMITY_WINDOW_SIZE & (PROXIMITY_WINDOW_SIZE - 1U)) != 0U
+#error "PROXIMITY_WINDOW_SIZE must be a power of two"
+#endif
+#if (PROXIMITY_TRACE_SIZE & (PROXIMITY_TRACE_SIZE - 1U)) != 0U
+#error "PROXIMITY_TRACE_SIZE must be a power of two"
+#endif
 
 /* Exported types ------------------------------------------------------------*/
 typedef enum {
@@ -33,10 +95,94 @@ typedef enum {
     PROXIMITY_SPEED_UNIT_M_MIN = 1  // Meters per minute
 } ProximitySpeedUnit_t;
 
+typedef enum {
+    PROXIMITY_CAPTURE_MODE_IT = 0,  // One CC1 interrupt per edge
+    PROXIMITY_CAPTURE_MODE_DMA = 1  // CC1 captures DMA'd into a ring, consumed by ProcessCapture
+} ProximityCaptureMode_t;
+
+typedef enum {
+    PROXIMITY_METHOD_PERIOD = 0,    // T-method: every period (or averaging block) is an output
+    PROXIMITY_METHOD_MT = 1         // M/T: edges counted per gate over the exact first-to-last edge time
+} ProximityMethod_t;
+
+typedef enum {
+    PROXIMITY_AVERAGING_BLOCK = 0,  // One output per averaging_samples periods
+    PROXIMITY_AVERAGING_SLIDING = 1 // Running mean of the latest periods, one output per edge
+} ProximityAveraging_t;
+
+typedef enum {
+    PROXIMITY_TOOTH_OFF = 0,        // Periods used as measured
+    PROXIMITY_TOOTH_LEARN,          // Summing each tooth's period over learn revolutions
+    PROXIMITY_TOOTH_ALIGN,          // Table valid, recording one revolution to find its phase
+    PROXIMITY_TOOTH_ACTIVE          // Each period scaled by its tooth's correction
+} ProximityToothState_t;
+
+typedef enum {
+    PROXIMITY_SYNC_SEARCHING = 0,   // Waiting for the reference gap
+    PROXIMITY_SYNC_SYNCED,          // Tooth index and angle valid
+    PROXIMITY_SYNC_LOST             // Gap missing or early, searching again
+} ProximitySyncState_t;
+
+typedef enum {
+    PROXIMITY_TRACE_RECORDING = 0,  // Ring overwritten continuously
+    PROXIMITY_TRACE_TRIGGERED,      // Recording the post-trigger periods
+    PROXIMITY_TRACE_FROZEN          // Block complete, ring no longer written
+} ProximityTraceState_t;
+
+typedef enum {
+    PROXIMITY_TRIGGER_NONE = 0,
+    PROXIMITY_TRIGGER_MANUAL,       // Console or Modbus command
+    PROXIMITY_TRIGGER_OVERSPEED,    // Output RPM above the limit
+    PROXIMITY_TRIGGER_GLITCH        // Edge rejected by the glitch bound
+} ProximityTrigger_t;
+
+typedef RpmFilterBand_t ProximityHysteresisEntry_t;
+
+typedef struct {
+    float high_us;                  // High time of the last complete pulse
+    float period_us;                // Rising-to-rising period of that pulse
+    float duty;                     // high / period, 0..1
+    float duty_avg;                 // Slow average of duty
+    float drift;                    // duty_avg - reference, 0 without a reference
+} ProximityPulse_t;
+
 typedef struct {
-    uint16_t rpm_threshold;  // RPM threshold for this entry
-    uint16_t hysteresis;     // Hysteresis value for this threshold
-} ProximityHysteresisEntry_t;
+    volatile uint8_t state;             // ProximityToothState_t
+    uint8_t teeth;                      // Table length, equals the counter's PPR
+    uint16_t correction_q14[PROXIMITY_TOOTH_MAX]; // Mean period / tooth period, Q14
+    uint64_t period_sum[PROXIMITY_TOOTH_MAX];     // Learn / align accumulators, written by the capture path
+    volatile uint32_t revs;             // Revolutions completed since learn / align started
+    uint32_t target_revs;               // Revolutions to accumulate
+} ProximityToothCal_t;
+
+typedef struct {
+    uint32_t samples[PROXIMITY_TRACE_SIZE]; // Low 32 bits of the capture timestamps, clocks
+    volatile uint32_t head;             // Captures stored, written by the capture path
+    volatile uint32_t stop;             // head that ends recording, kept behind head while armed
+    uint32_t trigger;                   // head when the trigger fired
+    uint16_t pre;                       // Periods kept before the trigger
+    uint16_t post;                      // Periods recorded after it
+    uint32_t overspeed_rpm;             // Trigger above this output RPM, 0 = off
+    uint8_t on_glitch;                  // Trigger on a rejected edge
+    volatile uint8_t state;             // ProximityTraceState_t
+    volatile uint8_t cause;             // ProximityTrigger_t of the frozen block
+} ProximityTrace_t;
+
+typedef struct {
+    uint16_t buffer[PROXIMITY_DMA_BUFFER_SIZE]; // CCRx values written by the DMA
+    volatile uint32_t half_events;      // HT/TC events since start, written by DMA ISR
+    uint32_t read_count;                // Captures consumed by ProcessCapture
+    // One mark per run of timer wraps with no capture between them
+    volatile uint32_t marks[PROXIMITY_DMA_MARK_COUNT];      // Capture index following the run
+    volatile uint32_t mark_wraps[PROXIMITY_DMA_MARK_COUNT]; // Wraps in the run
+    volatile uint32_t mark_psc[PROXIMITY_DMA_MARK_COUNT];   // Division loaded by every wrap of the run
+    volatile uint32_t mark_head;        // Written by update ISR
+    volatile uint32_t mark_tail;        // Written by ProcessCapture, read by update ISR
+    uint32_t mark_last_raw;             // Capture count seen by the previous wrap
+    uint64_t segment_base;              // ProcessCapture's copy of the extended timebase
+    uint32_t psc;                       // Division of the segment ProcessCapture is reading
+} ProximityDmaRing_t;
+
 typedef struct {
     // Configuration parameters
     uint32_t ppr;                    // Pulses per revolution (default: 1)
@@ -44,6 +190,13 @@ typedef struct {
     uint32_t timeout_ms;             // No pulse timeout in milliseconds
     uint32_t averaging_samples;      // Number of samples for averaging (default: 3)
     ProximitySpeedUnit_t speed_unit; // Speed display unit
+    ProximityCaptureMode_t capture_mode; // Interrupt or DMA capture
+    uint8_t auto_range;                  // Retune the prescaler from the measured period
+    ProximityMethod_t method;            // T or M/T speed measurement
+    uint32_t gate_ms;                    // M/T gate time
+    uint32_t stop_periods;               // Expected periods without an edge before zero speed
+    uint32_t max_accel;                  // Physically possible RPM/s, 0 = no glitch rejection
+    uint32_t missing_teeth;              // Teeth left out at the reference gap, 0 = evenly spaced target
     
     // Hysteresis configuration table
     ProximityHysteresisEntry_t hysteresis_table[PROXIMITY_HYSTERESIS_TABLE_SIZE];
@@ -51,25 +204,111 @@ typedef struct {
     
     // Runtime state variables
     volatile float rpm;              // Current RPM value
-    volatile uint32_t last_capture_time;
+    volatile uint8_t stopped;        // Zero speed declared, cleared by the next measured period
+    volatile uint64_t last_capture_cycles;  // Timebase_GetCycles() of the last edge
     volatile uint16_t ic_val1;
     volatile uint16_t ic_val2;
-    volatile uint32_t difference;
+    volatile uint32_t difference;       // Period in timer clock cycles (PROXIMITY_TIMCLOCK)
     volatile int is_first_captured;
-    volatile uint32_t overflow_count;
     volatile uint8_t new_capture_ready;
     
+    // Extended timebase in timer clock cycles. A prescaler written to PSC only
+    // takes effect at the next update, so each wrap starts a new segment.
+    volatile uint32_t timer_wraps;      // Every TIM update since start, written by update ISR
+    volatile uint64_t segment_base;     // Clock cycles at the start of the running segment
+    volatile uint32_t active_psc;       // Division of the running segment
+    volatile uint32_t pending_psc;      // Division loaded at the next update
+    volatile uint32_t requested_psc;    // Division asked for by the main loop
+    uint64_t last_timestamp;            // Extended timestamp of the previous edge (ISR only)
+    
+    // M/T gate: periods closed since gate_first_ts, written by the capture path
+    volatile uint32_t gate_edges;
+    volatile uint64_t gate_first_ts;    // Edge the current gate counts from
+    volatile uint64_t gate_last_ts;     // Latest edge
+    uint64_t gate_start_us;             // Timebase_GetMicros() the current gate opened
+    
     // Averaging variables
-    volatile uint32_t period_sum;
+    ProximityAveraging_t averaging;
+    uint64_t window_clocks;             // Sliding window time bound, 0 = count bound only
+    volatile uint64_t period_sum;
     volatile uint8_t period_count;
     volatile uint8_t first_measurement;
+    uint32_t window[PROXIMITY_WINDOW_SIZE]; // Sliding ring, summed in period_sum
+    uint8_t window_head;                // Oldest period in the ring
+    
+    // Output filter chain, fed with the hysteresis table below
+    RpmFilter_t filter;
+    
+    // Glitch rejection, bound refreshed by ProcessCapture and checked per edge
+    volatile uint32_t glitch_min_period; // Shortest plausible period in clocks, 0 = accept all
+    volatile uint32_t glitch_edges;      // Edges checked
+    volatile uint32_t glitch_rejects;    // Edges dropped as impossible
+    volatile uint8_t glitch_run;         // Consecutive rejects
+    
+    // Input stage, retuned by ProcessCapture from the measured edge rate
+    uint32_t max_irq_hz;                 // Capture rate ceiling, 0 = ICPSC DIV1 and ICxF as configured
+    volatile uint8_t ic_div;             // Edges per capture: 1, 2, 4 or 8
+    uint8_t ic_filter;                   // ICxF loaded with ic_div
+    uint8_t ic_base_filter;              // ICxF found at init, restored without a ceiling
+    
+    // Per-tooth calibration, NULL = off (tables live outside to spare RAM on other channels)
+    ProximityToothCal_t *tooth_cal;
+    volatile uint8_t tooth_index;        // Tooth the next period ends on, written by the capture path
+    
+    // Raw capture recorder, NULL = off
+    ProximityTrace_t *trace;
+    
+    // Multi-resolution speed history, NULL = off (storage is usually a Modbus table)
+    RpmHistory_t *history;
+    
+    // Direction from a second, phase-shifted sensor on another channel of the same timer
+    uint8_t direction_sensing;           // B channel routed to this instance
+    uint32_t dir_channel;                // TIM_CHANNEL_x of the B sensor
+    HAL_TIM_ActiveChannel dir_active_channel;
+    ProximityCaptureMode_t dir_saved_mode; // Capture mode to restore when sensing stops
+    volatile uint64_t dir_b_ts;          // Latest B edge, extended timestamp
+    volatile int8_t direction;           // +1 forward, -1 reverse, 0 unknown
+    volatile int8_t dir_candidate;       // Last per-edge decision, two in a row flip direction
+    volatile int64_t position;           // Signed A-edge total
+    
+    // Pulse width from the paired channel latching the falling edge of the same input
+    uint8_t pulse_width;                 // Paired channel routed to this instance
+    uint8_t both_edges;                  // Falling-to-falling periods are speed samples too
+    uint32_t pw_channel;                 // TIM_CHANNEL_x paired with channel (1<->2, 3<->4)
+    HAL_TIM_ActiveChannel pw_active_channel;
+    ProximityCaptureMode_t pw_saved_mode; // Capture mode to restore when measuring stops
+    volatile uint64_t pw_fall_ts;        // Latest falling edge, 0 after a restart
+    volatile uint32_t pw_high;           // High time of the last complete pulse, clocks
+    volatile uint32_t pw_period;         // Period that pulse started, clocks
+    float duty_avg;                      // Slow duty average, updated by ProcessCapture
+    float duty_ref;                      // Healthy duty to measure drift against, 0 = none
+    
+    // Missing-tooth synchronisation, advanced per edge by the capture path
+    volatile uint8_t sync_state;         // ProximitySyncState_t
+    volatile uint32_t sync_tooth;        // Pitch position of the last edge, 0 = first edge after the gap
+    volatile uint32_t sync_period;       // Last period per pitch, gap compare reference
+    volatile uint32_t sync_revs;         // Gaps confirmed while synced
+    volatile uint32_t sync_losses;       // Sync-loss events
+    
+    // Alpha-beta tracker, replaces the filter chain when enabled
+    uint8_t tracking;
+    RpmTracker_t tracker;
+    volatile uint64_t sample_ts;         // Edge that closed the pending output
+    uint64_t tracker_ts;                 // Edge of the last tracker update
+    uint64_t tracker_us;                 // Timebase_GetMicros() of the last tracker update
     
-    // Hysteresis filter variables
-    volatile int rpm_previous;
-    volatile uint8_t stability_counter;
+    // Windowed statistics of the output speed, fed by ProcessCapture
+    RpmStats_t stats;
     
-    // Timer handle pointer
+    // DMA capture ring, NULL = interrupt mode only (lives outside so IT-mode channels don't carry it)
+    ProximityDmaRing_t *dma;
+    volatile uint32_t dma_overruns;      // Batches dropped because the ring was lapped
+    
+    // Timer handle pointer and the capture channel this instance owns
     TIM_HandleTypeDef *htim;
+    uint32_t channel;                    // TIM_CHANNEL_1..TIM_CHANNEL_4
+    HAL_TIM_ActiveChannel active_channel; // htim->Channel value of this channel's events
+    uint8_t running;                     // Between Start and Stop
 } ProximityCounter_t;
 
 typedef struct {
@@ -77,6 +316,20 @@ typedef struct {
     float diameter;
     uint32_t timeout_ms;
     uint32_t averaging_samples;
+    ProximityCaptureMode_t capture_mode; // Zero-initialised configs keep interrupt mode
+    ProximityDmaRing_t *dma_ring;        // Ring storage for DMA mode, NULL = interrupt mode
+    uint8_t auto_range;                  // 0 = fixed prescaler from htim->Init; off on a shared timer
+    ProximityMethod_t method;            // Zero-initialised configs keep the T-method
+    uint32_t gate_ms;                    // M/T gate time, 0 = PROXIMITY_MT_DEFAULT_GATE_MS
+    uint32_t channel;                    // TIM_CHANNEL_1..4 (zero-initialised = TIM_CHANNEL_1)
+    RpmFilterChain_t filter_chain;       // Zero-initialised configs keep hysteresis only
+    ProximityAveraging_t averaging;      // Zero-initialised configs keep block averaging
+    uint32_t window_ms;                  // Sliding window length in ms, 0 = last averaging_samples periods
+    uint32_t stop_periods;               // Zero speed after k silent periods, 0 = PROXIMITY_STOP_PERIODS
+    uint8_t tracker;                     // 1 = alpha-beta tracker instead of the filter chain
+    uint32_t max_accel;                  // Physically possible RPM/s, 0 = no glitch rejection
+    uint32_t missing_teeth;              // Reference gap width in teeth (e.g. 1 for 36-1), 0 = none
+    uint32_t max_irq_hz;                 // Capture rate ceiling in Hz, 0 = capture every edge
 } ProximityCounterConfig_t;
 
 /* Exported constants --------------------------------------------------------*/
@@ -110,11 +363,21 @@ void ProximityCounter_Start(ProximityCounter_t *prox_counter);
  */
 void ProximityCounter_Stop(ProximityCounter_t *prox_counter);
 
+/**
+ * @brief Stop an instance and release its timer channels
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @retval None
+ * @note Direction and pulse width are switched off first. Other instances
+ *       can then claim the channels; ProximityCounter_Init binds it again.
+ */
+void ProximityCounter_DeInit(ProximityCounter_t *prox_counter);
+
 /**
  * @brief Process new capture data and calculate RPM
  * @param prox_counter: Pointer to ProximityCounter_t structure
  * @retval None
- * @note Call this function in main loop when new_capture_ready flag is set
+ * @note Call this function in main loop when new_capture_ready flag is set.
+ *       In DMA mode it also drains every capture written since the last call.
  */
 void ProximityCounter_ProcessCapture(ProximityCounter_t *prox_counter);
 
@@ -122,10 +385,395 @@ void ProximityCounter_ProcessCapture(ProximityCounter_t *prox_counter);
  * @brief Check for timeout and reset if no pulses detected
  * @param prox_counter: Pointer to ProximityCounter_t structure
  * @retval None
- * @note Call this function periodically in main loop
+ * @note Call this function periodically in main loop. Once the time since
+ *       the last edge exceeds the last period, the real speed can only be
+ *       lower, so the RPM is capped at one pulse per elapsed time. After
+ *       stop_periods silent periods (or timeout_ms) zero speed is declared.
  */
 void ProximityCounter_CheckTimeout(ProximityCounter_t *prox_counter);
 
+/**
+ * @brief Get the current extended timer value
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @retval Timer clock cycles since start, same base as capture timestamps
+ * @note Safe from main loop context; consistent with a pending, unserviced update
+ */
+uint64_t ProximityCounter_GetTimestamp(const ProximityCounter_t *prox_counter);
+
+/**
+ * @brief Enable or disable automatic prescaler ranging
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @param enable: true to retune from the measured period, false for htim->Init prescaler
+ * @retval None
+ */
+void ProximityCounter_SetAutoRange(ProximityCounter_t *prox_counter, bool enable);
+
+/**
+ * @brief Check whether zero speed has been declared
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @retval true after stop detection or timeout, until the next measured period
+ */
+bool ProximityCounter_IsStopped(const ProximityCounter_t *prox_counter);
+
+/**
+ * @brief Get the prescaler division currently counting
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @retval PSC + 1 of the running segment
+ */
+uint32_t ProximityCounter_GetPrescaler(const ProximityCounter_t *prox_counter);
+
+/**
+ * @brief Select T-method or M/T speed measurement
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @param method: PROXIMITY_METHOD_PERIOD or PROXIMITY_METHOD_MT
+ * @param gate_ms: M/T gate time in ms (0 = PROXIMITY_MT_DEFAULT_GATE_MS)
+ * @retval None
+ * @note In M/T mode an output is produced every gate that closed at least one
+ *       period. Below one pulse per gate the gate stretches to the next edge,
+ *       which is the T-method on a single period.
+ */
+void ProximityCounter_SetMethod(ProximityCounter_t *prox_counter, ProximityMethod_t method, uint32_t gate_ms);
+
+/**
+ * @brief Select the filter chain applied to each RPM sample
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @param chain: RPM_FILTER_CHAIN_* id
+ * @retval true if the chain exists
+ * @note Clears the filter state; the next sample passes through unfiltered.
+ */
+bool ProximityCounter_SetFilterChain(ProximityCounter_t *prox_counter, RpmFilterChain_t chain);
+
+/**
+ * @brief Select block or sliding-window period averaging
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @param averaging: PROXIMITY_AVERAGING_BLOCK or PROXIMITY_AVERAGING_SLIDING
+ * @param samples: Periods per average (sliding: capped at PROXIMITY_WINDOW_SIZE)
+ * @param window_ms: Sliding only, average the periods of the last window_ms
+ *                   (up to PROXIMITY_WINDOW_SIZE of them), 0 = use samples
+ * @retval None
+ * @note Sliding mode updates a running sum, so every edge gets a fresh
+ *       average at constant cost. Applies to the T-method only.
+ */
+void ProximityCounter_SetAveraging(ProximityCounter_t *prox_counter, ProximityAveraging_t averaging,
+                                   uint32_t samples, uint32_t window_ms);
+
+/**
+ * @brief Set EMA weight and slew-rate limit of the filter chain
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @param alpha_q8: Weight of the new sample in 1/256 (1..256)
+ * @param slew_rpm: Max RPM change per sample, 0 = unlimited
+ * @retval true if the parameters are in range
+ */
+bool ProximityCounter_SetFilterParams(ProximityCounter_t *prox_counter, uint16_t alpha_q8, uint32_t slew_rpm);
+
+/**
+ * @brief Enable the alpha-beta speed tracker in place of the filter chain
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @param enable: true to track speed and acceleration
+ * @param alpha_q8: Speed gain in 1/256 (1..256, 0 = RPM_TRACKER_DEFAULT_ALPHA_Q8)
+ * @param beta_q8: Acceleration gain in 1/256 (0..256)
+ * @retval None
+ * @note The tracker is corrected at each output using the exact time between
+ *       the edges that closed them, and extrapolated by CheckTimeout between
+ *       outputs.
+ */
+void ProximityCounter_SetTracker(ProximityCounter_t *prox_counter, bool enable, uint16_t alpha_q8, uint16_t beta_q8);
+
+/**
+ * @brief Get tracked acceleration
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @retval Acceleration in RPM/s, 0 when the tracker is off
+ */
+float ProximityCounter_GetAcceleration(const ProximityCounter_t *prox_counter);
+
+/**
+ * @brief Get the tracker's innovation variance
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @retval Mean squared difference between measured and predicted speed, RPM^2
+ */
+float ProximityCounter_GetSpeedVariance(const ProximityCounter_t *prox_counter);
+
+/**
+ * @brief Set the acceleration limit used to reject glitch edges
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @param max_accel: Highest RPM/s the shaft can reach, 0 = accept every edge
+ * @retval None
+ * @note An edge arriving sooner than the last period shortened by max_accel
+ *       (plus PROXIMITY_GLITCH_JITTER) is dropped and the period runs on to
+ *       the next edge. The check is a single compare in the capture path.
+ */
+void ProximityCounter_SetMaxAccel(ProximityCounter_t *prox_counter, uint32_t max_accel);
+
+/**
+ * @brief Get the share of edges rejected as glitches
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @retval Rejected / checked edges since Init, 0..1
+ */
+float ProximityCounter_GetRejectRatio(const ProximityCounter_t *prox_counter);
+
+/**
+ * @brief Set the capture rate ceiling of the adaptive input stage
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @param max_irq_hz: Captures per second to stay under, 0 = capture every edge
+ * @retval None
+ * @note The ICPSC divider steps through 1/2/4/8 as the edge rate rises and
+ *       periods are divided back, so RPM is unchanged. Above 8x the ceiling
+ *       the rate grows again. Sync, tooth calibration, direction and pulse
+ *       width need every edge and hold the divider at 1.
+ */
+void ProximityCounter_SetIrqCeiling(ProximityCounter_t *prox_counter, uint32_t max_irq_hz);
+
+/**
+ * @brief Get the edges per capture of the input stage
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @retval 1, 2, 4 or 8
+ */
+uint32_t ProximityCounter_GetEdgeDivider(const ProximityCounter_t *prox_counter);
+
+/**
+ * @brief Get the capture rate the measured speed produces
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @retval Captures per second, 0 when stopped
+ */
+float ProximityCounter_GetCaptureRate(const ProximityCounter_t *prox_counter);
+
+/**
+ * @brief Attach a tooth calibration object
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @param cal: Calibration storage, NULL to detach
+ * @retval None
+ * @note The object starts off; use StartToothLearn or LoadToothTable.
+ */
+void ProximityCounter_SetToothCal(ProximityCounter_t *prox_counter, ProximityToothCal_t *cal);
+
+/**
+ * @brief Learn the spacing of every tooth
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @param revs: Whole revolutions to average (0 = PROXIMITY_TOOTH_DEFAULT_REVS)
+ * @retval true if learning started (calibration attached, PPR 2..PROXIMITY_TOOTH_MAX)
+ * @note Run at a steady speed. Each tooth's period is summed from the first
+ *       revolution boundary on; ProcessCapture then builds the table and
+ *       starts correcting. A stop or a lost edge restarts the run.
+ */
+bool ProximityCounter_StartToothLearn(ProximityCounter_t *prox_counter, uint32_t revs);
+
+/**
+ * @brief Load a stored correction table
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @param table: Q14 corrections, one per tooth
+ * @param teeth: Entries in table, must equal the PPR
+ * @retval true if the table was accepted
+ * @note Without an index mark the tooth under the sensor is unknown, so one
+ *       revolution is recorded first and the table is rotated to the phase
+ *       that leaves the flattest corrected periods.
+ */
+bool ProximityCounter_LoadToothTable(ProximityCounter_t *prox_counter, const uint16_t *table, uint32_t teeth);
+
+/**
+ * @brief Copy the learned correction table
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @param table: Destination for the Q14 corrections
+ * @param max: Entries table can hold
+ * @retval Number of teeth copied, 0 if no table is in use
+ */
+uint32_t ProximityCounter_GetToothTable(const ProximityCounter_t *prox_counter, uint16_t *table, uint32_t max);
+
+/**
+ * @brief Stop applying the tooth correction
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @retval None
+ */
+void ProximityCounter_ClearToothTable(ProximityCounter_t *prox_counter);
+
+/**
+ * @brief Get the tooth calibration state
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @retval PROXIMITY_TOOTH_OFF when no calibration is attached
+ */
+ProximityToothState_t ProximityCounter_GetToothState(const ProximityCounter_t *prox_counter);
+
+/**
+ * @brief Get the speed statistics of the last closed window
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @param window: 0..RPM_STATS_WINDOWS-1 (1 s, 10 s, 60 s by default)
+ * @param result: Receives count, mean, stddev, min and max in Q8 RPM
+ * @retval true if window exists
+ * @note Every output sample is counted, and a stop adds one zero sample.
+ */
+bool ProximityCounter_GetStats(const ProximityCounter_t *prox_counter, uint32_t window, RpmStatsResult_t *result);
+
+/**
+ * @brief Attach a speed history
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @param history: History set up with RpmHistory_Init, NULL to detach
+ * @retval None
+ * @note Fed with the same samples as the statistics; a 100 ms slot without
+ *       output enters the speed held at that time.
+ */
+void ProximityCounter_SetHistory(ProximityCounter_t *prox_counter, RpmHistory_t *history);
+
+/**
+ * @brief Attach a raw capture recorder
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @param trace: Recorder storage, NULL to detach
+ * @retval None
+ * @note The recorder starts armed with the default pre/post counts and no
+ *       automatic trigger. Every capture costs one store and one increment.
+ */
+void ProximityCounter_SetTrace(ProximityCounter_t *prox_counter, ProximityTrace_t *trace);
+
+/**
+ * @brief Set the trace window and automatic triggers, then re-arm
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @param pre: Periods kept before the trigger
+ * @param post: Periods recorded after the trigger
+ * @param overspeed_rpm: Trigger when the output RPM exceeds this, 0 = off
+ * @param on_glitch: Trigger on an edge rejected as a glitch
+ * @retval true if pre + post fits the ring (pre + post < PROXIMITY_TRACE_SIZE)
+ */
+bool ProximityCounter_SetTraceTrigger(ProximityCounter_t *prox_counter, uint32_t pre, uint32_t post,
+                                      uint32_t overspeed_rpm, bool on_glitch);
+
+/**
+ * @brief Drop the frozen block and record continuously again
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @retval None
+ */
+void ProximityCounter_ArmTrace(ProximityCounter_t *prox_counter);
+
+/**
+ * @brief Fire the trace trigger
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @param cause: Recorded with the block
+ * @retval None
+ * @note Ignored unless recording; the block freezes once post periods
+ *       have followed.
+ */
+void ProximityCounter_TriggerTrace(ProximityCounter_t *prox_counter, ProximityTrigger_t cause);
+
+/**
+ * @brief Get the recorder state
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @retval PROXIMITY_TRACE_RECORDING when no recorder is attached
+ */
+ProximityTraceState_t ProximityCounter_GetTraceState(const ProximityCounter_t *prox_counter);
+
+/**
+ * @brief Get the size of the frozen block
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @param trigger_at: Receives the periods before the trigger, may be NULL
+ * @retval Periods in the block, 0 until frozen
+ */
+uint32_t ProximityCounter_GetTraceLength(const ProximityCounter_t *prox_counter, uint32_t *trigger_at);
+
+/**
+ * @brief Copy periods of the frozen block
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @param offset: First period, 0 = oldest
+ * @param periods: Destination, timer clocks (PROXIMITY_TIMCLOCK) between captures
+ * @param max: Entries periods can hold
+ * @retval Periods copied
+ * @note Raw captures: glitches are included and with ICPSC each period
+ *       spans the edge divider in edges.
+ */
+uint32_t ProximityCounter_ReadTrace(const ProximityCounter_t *prox_counter, uint32_t offset,
+                                    uint32_t *periods, uint32_t max);
+
+/**
+ * @brief Derive direction from a second, phase-shifted sensor
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @param enable: true to route the B channel to this instance
+ * @param channel: TIM_CHANNEL_x of the B sensor on the same timer
+ * @retval true if applied, false if another instance owns the B channel
+ * @note The B channel only latches its edge time; each A edge compares the
+ *       time since the last B edge with the A period. B following A by less
+ *       than half a period is forward, so any offset away from 0 and 180
+ *       degrees works. Runs A in interrupt mode while enabled, because the
+ *       B time has to be compared before the next A edge. An instance bound
+ *       to the B channel has to be released with ProximityCounter_DeInit().
+ */
+bool ProximityCounter_SetDirectionSensor(ProximityCounter_t *prox_counter, bool enable, uint32_t channel);
+
+/**
+ * @brief Measure pulse high time and duty with the paired channel
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @param enable: true to capture the falling edge on the paired channel
+ * @param both_edges: Falling-to-falling periods also feed the speed, doubling
+ *                    the update rate on 1-PPR targets (T-method, even targets)
+ * @retval true if applied, false if another instance owns the paired channel
+ * @note PWM-input wiring: the paired channel (CH2 for CH1, CH4 for CH3) is
+ *       switched to the indirect input on the falling edge, so no second
+ *       sensor is needed. The falling ISR latches one timestamp; the rising
+ *       edge turns it into the high time. Runs in interrupt mode. An instance
+ *       bound to the paired channel has to be released with
+ *       ProximityCounter_DeInit().
+ */
+bool ProximityCounter_SetPulseWidth(ProximityCounter_t *prox_counter, bool enable, bool both_edges);
+
+/**
+ * @brief Get high time, period and duty of the same pulse
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @param pulse: Output snapshot
+ * @retval true if a complete pulse has been measured
+ */
+bool ProximityCounter_GetPulse(const ProximityCounter_t *prox_counter, ProximityPulse_t *pulse);
+
+/**
+ * @brief Set the duty that drift is reported against
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @param duty: Reference duty 0..1, negative to take the current average
+ * @retval None
+ */
+void ProximityCounter_SetDutyReference(ProximityCounter_t *prox_counter, float duty);
+
+/**
+ * @brief Get the direction of rotation
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @retval +1 forward, -1 reverse, 0 unknown or no direction sensor
+ */
+int32_t ProximityCounter_GetDirection(const ProximityCounter_t *prox_counter);
+
+/**
+ * @brief Get RPM signed by the direction of rotation
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @retval Negative in reverse
+ */
+float ProximityCounter_GetSignedRPM(const ProximityCounter_t *prox_counter);
+
+/**
+ * @brief Get the signed pulse total
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @retval A edges counted up forward and down in reverse since Init
+ */
+int64_t ProximityCounter_GetPosition(const ProximityCounter_t *prox_counter);
+
+/**
+ * @brief Configure the missing-tooth reference gap
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @param missing_teeth: Teeth left out at the gap (1..PROXIMITY_SYNC_MAX_MISSING), 0 = no gap
+ * @retval true if accepted; PPR counts the tooth pitches including the missing ones
+ * @note The gap is found per edge by comparing each period with the previous
+ *       one. Once synced, every edge advances the tooth index and the gap
+ *       must return exactly one revolution later, otherwise sync is lost.
+ *       The gap period counts as missing_teeth + 1 pitches in the speed.
+ */
+bool ProximityCounter_SetMissingTeeth(ProximityCounter_t *prox_counter, uint32_t missing_teeth);
+
+/**
+ * @brief Get the synchronisation state
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @retval ProximitySyncState_t
+ */
+ProximitySyncState_t ProximityCounter_GetSyncState(const ProximityCounter_t *prox_counter);
+
+/**
+ * @brief Get the absolute shaft angle
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @retval Degrees from the first edge after the gap (0..360), interpolated
+ *         from the last edge at the last period, -1 while not synced
+ */
+float ProximityCounter_GetAngle(const ProximityCounter_t *prox_counter);
+
 /**
  * @brief Get current RPM value
  * @param prox_counter: Pointer to ProximityCounter_t structure
@@ -242,6 +890,15 @@ void ProximityCounter_UpdateConfig(ProximityCounter_t *prox_counter, uint32_t pp
  */
 void ProximityCounter_HandleCapture(ProximityCounter_t *prox_counter, TIM_HandleTypeDef *htim);
 
+/**
+ * @brief Handle DMA half-transfer callback - call this from HAL_TIM_IC_CaptureHalfCpltCallback
+ * @param prox_counter: Pointer to ProximityCounter_t structure
+ * @param htim: Timer handle that triggered the interrupt
+ * @retval None
+ * @note In DMA mode HAL_TIM_IC_CaptureCallback is the transfer-complete event
+ */
+void ProximityCounter_HandleCaptureHalf(ProximityCounter_t *prox_counter, TIM_HandleTypeDef *htim);
+
 /**
  * @brief Handle timer overflow callback - call this from HAL_TIM_PeriodElapsedCallback
  * @param prox_counter: Pointer to ProximityCounter_t structure
@@ -250,6 +907,29 @@ void ProximityCounter_HandleCapture(ProximityCounter_t *prox_counter, TIM_Handle
  */
 void ProximityCounter_HandleOverflow(ProximityCounter_t *prox_counter, TIM_HandleTypeDef *htim);
 
+/**
+ * @brief Route a capture event to the instance bound to htim/htim->Channel
+ * @param htim: Timer handle that triggered the interrupt
+ * @retval None
+ * @note Call from HAL_TIM_IC_CaptureCallback. Instances register themselves
+ *       in ProximityCounter_Init; lookup is a table index, no search.
+ */
+void ProximityCounter_DispatchCapture(TIM_HandleTypeDef *htim);
+
+/**
+ * @brief Route a DMA half-transfer event - call from HAL_TIM_IC_CaptureHalfCpltCallback
+ * @param htim: Timer handle that triggered the interrupt
+ * @retval None
+ */
+void ProximityCounter_DispatchCaptureHalf(TIM_HandleTypeDef *htim);
+
+/**
+ * @brief Route a timer update to every instance on htim - call from HAL_TIM_PeriodElapsedCallback
+ * @param htim: Timer handle that triggered the interrupt
+ * @retval None
+ */
+void ProximityCounter_DispatchOverflow(TIM_HandleTypeDef *htim);
+
 /**
  * @brief Apply hysteresis filter to RPM value using configurable table
  * @param prox_counter: Pointer to ProximityCounter_t structure
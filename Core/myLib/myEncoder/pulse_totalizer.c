@@ -0,0 +1,257 @@
+/**
+ ******************************************************************************
+ * @file    pulse_totalizer.c
+ * @brief   Hardware pulse totalizer on a timer clocked by the sensor input
+ * @author  Auto-generated
+ * @date    December 2025
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "pulse_totalizer.h"
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define TOTALIZER_PERIOD_SHIFT    16         // Pulses per update = 2^16 (ARR = 0xFFFF)
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief Timer channel of a compare level (CH2, CH3)
+ */
+static uint32_t PulseTotalizer_LevelChannel(uint32_t level) {
+    return TIM_CHANNEL_2 + level * 4U;
+}
+
+/**
+ * @brief Load the compare of a level if its total falls in the running window
+ * @note Call with interrupts disabled or from the timer ISR. The compare only
+ *       sees the low 16 bits, so it is loaded once the overflow count matches
+ *       the high part; a count that already passed the level flags it here.
+ */
+static void PulseTotalizer_Arm(PulseTotalizer_t *totalizer, uint32_t level) {
+    TIM_HandleTypeDef *htim = totalizer->htim;
+    uint32_t it = TIM_IT_CC2 << level;
+    uint64_t value = totalizer->level[level];
+    uint8_t bit = (uint8_t)(1U << level);
+
+    __HAL_TIM_DISABLE_IT(htim, it);
+    if (value == 0U || (totalizer->reached & bit)) {
+        return;
+    }
+
+    uint64_t total = PulseTotalizer_GetTotal(totalizer);
+    if ((value >> TOTALIZER_PERIOD_SHIFT) != (total >> TOTALIZER_PERIOD_SHIFT)) {
+        if (total >= value) {
+            totalizer->reached |= bit;
+        }
+        return;  // A later update loads it
+    }
+
+    (&htim->Instance->CCR2)[level] = (uint32_t)(value & 0xFFFFU);
+    __HAL_TIM_CLEAR_FLAG(htim, TIM_FLAG_CC2 << level);
+    __HAL_TIM_ENABLE_IT(htim, it);
+
+    // The count may have passed the value before the compare was loaded
+    if (PulseTotalizer_GetTotal(totalizer) >= value) {
+        totalizer->reached |= bit;
+        __HAL_TIM_DISABLE_IT(htim, it);
+    }
+}
+
+/**
+ * @brief Reload every level after a change of total or window
+ */
+static void PulseTotalizer_ArmAll(PulseTotalizer_t *totalizer) {
+    for (uint32_t i = 0; i < TOTALIZER_LEVEL_COUNT; i++) {
+        PulseTotalizer_Arm(totalizer, i);
+    }
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief Put a timer into external clock counting
+ */
+bool PulseTotalizer_Init(PulseTotalizer_t *totalizer, const PulseTotalizerConfig_t *config,
+                         TIM_HandleTypeDef *htim) {
+    if (!totalizer || !config || !htim) {
+        return false;
+    }
+
+    memset(totalizer, 0, sizeof(PulseTotalizer_t));
+    totalizer->htim = htim;
+    totalizer->source = config->source;
+    totalizer->level[TOTALIZER_LEVEL_PRESET] = config->preset;
+    totalizer->level[TOTALIZER_LEVEL_TARGET] = config->target;
+
+    // Full 16-bit range, one count per pulse
+    htim->Instance->PSC = 0U;
+    __HAL_TIM_SET_AUTORELOAD(htim, 0xFFFFU);
+
+    TIM_ClockConfigTypeDef clock = { 0 };
+    if (config->source == TOTALIZER_SOURCE_ETR) {
+        clock.ClockSource = TIM_CLOCKSOURCE_ETRMODE2;
+        clock.ClockPolarity = config->falling ? TIM_CLOCKPOLARITY_INVERTED : TIM_CLOCKPOLARITY_NONINVERTED;
+    } else {
+        clock.ClockSource = TIM_CLOCKSOURCE_TI1;
+        clock.ClockPolarity = config->falling ? TIM_CLOCKPOLARITY_FALLING : TIM_CLOCKPOLARITY_RISING;
+    }
+    clock.ClockPrescaler = TIM_CLOCKPRESCALER_DIV1;
+    clock.ClockFilter = config->filter & 0xFU;
+    if (HAL_TIM_ConfigClockSource(htim, &clock) != HAL_OK) {
+        return false;
+    }
+
+    // Compare channels in frozen mode: flags only, no pin
+    TIM_OC_InitTypeDef oc = { 0 };
+    oc.OCMode = TIM_OCMODE_TIMING;
+    oc.OCPolarity = TIM_OCPOLARITY_HIGH;
+    oc.OCFastMode = TIM_OCFAST_DISABLE;
+    for (uint32_t i = 0; i < TOTALIZER_LEVEL_COUNT; i++) {
+        if (HAL_TIM_OC_ConfigChannel(htim, &oc, PulseTotalizer_LevelChannel(i)) != HAL_OK) {
+            return false;
+        }
+    }
+
+    PulseTotalizer_Reset(totalizer);
+    return true;
+}
+
+/**
+ * @brief Start counting, the total carries on from where it stopped
+ */
+void PulseTotalizer_Start(PulseTotalizer_t *totalizer) {
+    if (!totalizer || !totalizer->htim) {
+        return;
+    }
+
+    __disable_irq();
+    PulseTotalizer_ArmAll(totalizer);
+    __enable_irq();
+    HAL_TIM_Base_Start_IT(totalizer->htim);
+    totalizer->running = 1;
+}
+
+/**
+ * @brief Stop counting
+ */
+void PulseTotalizer_Stop(PulseTotalizer_t *totalizer) {
+    if (!totalizer || !totalizer->htim) {
+        return;
+    }
+
+    HAL_TIM_Base_Stop_IT(totalizer->htim);
+    __HAL_TIM_DISABLE_IT(totalizer->htim, TIM_IT_CC2 | TIM_IT_CC3);
+    totalizer->running = 0;
+}
+
+/**
+ * @brief Clear the total and the reached flags
+ */
+void PulseTotalizer_Reset(PulseTotalizer_t *totalizer) {
+    if (!totalizer || !totalizer->htim) {
+        return;
+    }
+
+    __disable_irq();
+    __HAL_TIM_SET_COUNTER(totalizer->htim, 0U);
+    __HAL_TIM_CLEAR_FLAG(totalizer->htim, TIM_FLAG_UPDATE);
+    totalizer->wraps = 0;
+    totalizer->reached = 0;
+    PulseTotalizer_ArmAll(totalizer);
+    __enable_irq();
+}
+
+/**
+ * @brief Get the pulses counted since the last reset
+ * @note Same wrap rule as the proximity timebase: with UIF still pending a
+ *       counter value in the lower half was read after that wrap.
+ */
+uint64_t PulseTotalizer_GetTotal(const PulseTotalizer_t *totalizer) {
+    if (!totalizer || !totalizer->htim) {
+        return 0;
+    }
+
+    uint32_t wraps;
+    uint16_t counter;
+    bool pending;
+
+    // Retry if the update ISR ran while sampling
+    do {
+        wraps = totalizer->wraps;
+        counter = (uint16_t)__HAL_TIM_GET_COUNTER(totalizer->htim);
+        pending = __HAL_TIM_GET_FLAG(totalizer->htim, TIM_FLAG_UPDATE);
+    } while (wraps != totalizer->wraps);
+
+    uint64_t total = ((uint64_t)wraps << TOTALIZER_PERIOD_SHIFT) + counter;
+    if (pending && counter < 0x8000U) {
+        total += 1ULL << TOTALIZER_PERIOD_SHIFT;
+    }
+    return total;
+}
+
+/**
+ * @brief Set a compare level
+ */
+void PulseTotalizer_SetLevel(PulseTotalizer_t *totalizer, TotalizerLevel_t level, uint64_t value) {
+    if (!totalizer || !totalizer->htim || (uint32_t)level >= TOTALIZER_LEVEL_COUNT) {
+        return;
+    }
+
+    __disable_irq();
+    totalizer->level[level] = value;
+    totalizer->reached &= (uint8_t)~(1U << level);
+    PulseTotalizer_Arm(totalizer, level);
+    __enable_irq();
+}
+
+/**
+ * @brief Get a compare level
+ */
+uint64_t PulseTotalizer_GetLevel(const PulseTotalizer_t *totalizer, TotalizerLevel_t level) {
+    if (!totalizer || (uint32_t)level >= TOTALIZER_LEVEL_COUNT) {
+        return 0;
+    }
+    return totalizer->level[level];
+}
+
+/**
+ * @brief Check whether the total has reached a level since the last reset
+ */
+bool PulseTotalizer_IsReached(const PulseTotalizer_t *totalizer, TotalizerLevel_t level) {
+    if (!totalizer || (uint32_t)level >= TOTALIZER_LEVEL_COUNT) {
+        return false;
+    }
+    return (totalizer->reached & (1U << level)) != 0U;
+}
+
+/**
+ * @brief Handle timer overflow callback - call this from HAL_TIM_PeriodElapsedCallback
+ */
+void PulseTotalizer_HandleOverflow(PulseTotalizer_t *totalizer, TIM_HandleTypeDef *htim) {
+    if (!totalizer || !htim || htim != totalizer->htim) {
+        return;
+    }
+
+    totalizer->wraps++;
+    // A level in the new window gets its compare now
+    PulseTotalizer_ArmAll(totalizer);
+}
+
+/**
+ * @brief Handle compare callback - call this from HAL_TIM_OC_DelayElapsedCallback
+ */
+void PulseTotalizer_HandleCompare(PulseTotalizer_t *totalizer, TIM_HandleTypeDef *htim) {
+    if (!totalizer || !htim || htim != totalizer->htim) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < TOTALIZER_LEVEL_COUNT; i++) {
+        if ((uint32_t)htim->Channel == ((uint32_t)HAL_TIM_ACTIVE_CHANNEL_2 << i) &&
+            PulseTotalizer_GetTotal(totalizer) >= totalizer->level[i]) {
+            totalizer->reached |= (uint8_t)(1U << i);
+            __HAL_TIM_DISABLE_IT(htim, TIM_IT_CC2 << i);
+        }
+    }
+}
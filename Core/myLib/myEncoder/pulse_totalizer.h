@@ -0,0 +1,144 @@
+/**
+ ******************************************************************************
+ * @file    pulse_totalizer.h
+ * @brief   Hardware pulse totalizer on a timer clocked by the sensor input
+ * @author  Auto-generated
+ * @date    December 2025
+ ******************************************************************************
+ */
+
+#ifndef __PULSE_TOTALIZER_H
+#define __PULSE_TOTALIZER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Exported defines ----------------------------------------------------------*/
+// Compare levels run on CH2 (preset) and CH3 (target) of the counting timer
+#define TOTALIZER_LEVEL_COUNT       2U
+#define TOTALIZER_DEFAULT_FILTER    3U   // fCK_INT, N=8: ignores spikes under ~110 ns
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum {
+    TOTALIZER_SOURCE_TI1 = 0,       // External clock mode 1 on TI1FP1 (CH1 pin)
+    TOTALIZER_SOURCE_ETR = 1        // External clock mode 2 on the ETR pin
+} TotalizerSource_t;
+
+typedef enum {
+    TOTALIZER_LEVEL_PRESET = 0,     // Early warning, e.g. slow the feed down
+    TOTALIZER_LEVEL_TARGET = 1      // Batch complete
+} TotalizerLevel_t;
+
+typedef struct {
+    TotalizerSource_t source;
+    uint8_t falling;                 // Count falling edges (ETR: inverted input)
+    uint8_t filter;                  // Input filter 0..15 (IC1F / ETF encoding)
+    uint64_t preset;                 // Preset level in pulses, 0 = off
+    uint64_t target;                 // Target level in pulses, 0 = off
+} PulseTotalizerConfig_t;
+
+typedef struct {
+    TIM_HandleTypeDef *htim;
+    TotalizerSource_t source;
+    volatile uint32_t wraps;         // Counter overflows since the last reset, written by update ISR
+    uint64_t level[TOTALIZER_LEVEL_COUNT]; // Compare totals, 0 = off
+    volatile uint8_t reached;        // Bit per level, latched until reset
+    uint8_t running;
+} PulseTotalizer_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+
+/**
+ * @brief Put a timer into external clock counting
+ * @param totalizer: Pointer to PulseTotalizer_t structure
+ * @param config: Pointer to configuration structure
+ * @param htim: Timer handle, base-initialised and not started
+ * @retval true if the clock source was accepted
+ * @note Every pulse is counted by the timer itself; the CPU only sees one
+ *       update per 65536 pulses and the compare hits.
+ */
+bool PulseTotalizer_Init(PulseTotalizer_t *totalizer, const PulseTotalizerConfig_t *config,
+                         TIM_HandleTypeDef *htim);
+
+/**
+ * @brief Start counting, the total carries on from where it stopped
+ * @param totalizer: Pointer to PulseTotalizer_t structure
+ * @retval None
+ */
+void PulseTotalizer_Start(PulseTotalizer_t *totalizer);
+
+/**
+ * @brief Stop counting
+ * @param totalizer: Pointer to PulseTotalizer_t structure
+ * @retval None
+ */
+void PulseTotalizer_Stop(PulseTotalizer_t *totalizer);
+
+/**
+ * @brief Clear the total and the reached flags
+ * @param totalizer: Pointer to PulseTotalizer_t structure
+ * @retval None
+ */
+void PulseTotalizer_Reset(PulseTotalizer_t *totalizer);
+
+/**
+ * @brief Get the pulses counted since the last reset
+ * @param totalizer: Pointer to PulseTotalizer_t structure
+ * @retval Total, safe from the main loop and from interrupts
+ */
+uint64_t PulseTotalizer_GetTotal(const PulseTotalizer_t *totalizer);
+
+/**
+ * @brief Set a compare level
+ * @param totalizer: Pointer to PulseTotalizer_t structure
+ * @param level: TOTALIZER_LEVEL_PRESET or TOTALIZER_LEVEL_TARGET
+ * @param value: Total to flag, 0 = off
+ * @retval None
+ * @note The flag is raised by the timer compare at the exact pulse; a level
+ *       already behind the total is flagged at once.
+ */
+void PulseTotalizer_SetLevel(PulseTotalizer_t *totalizer, TotalizerLevel_t level, uint64_t value);
+
+/**
+ * @brief Get a compare level
+ * @param totalizer: Pointer to PulseTotalizer_t structure
+ * @param level: TOTALIZER_LEVEL_PRESET or TOTALIZER_LEVEL_TARGET
+ * @retval Level total, 0 = off
+ */
+uint64_t PulseTotalizer_GetLevel(const PulseTotalizer_t *totalizer, TotalizerLevel_t level);
+
+/**
+ * @brief Check whether the total has reached a level since the last reset
+ * @param totalizer: Pointer to PulseTotalizer_t structure
+ * @param level: TOTALIZER_LEVEL_PRESET or TOTALIZER_LEVEL_TARGET
+ * @retval true once reached
+ */
+bool PulseTotalizer_IsReached(const PulseTotalizer_t *totalizer, TotalizerLevel_t level);
+
+/**
+ * @brief Handle timer overflow callback - call this from HAL_TIM_PeriodElapsedCallback
+ * @param totalizer: Pointer to PulseTotalizer_t structure
+ * @param htim: Timer handle from the callback
+ * @retval None
+ */
+void PulseTotalizer_HandleOverflow(PulseTotalizer_t *totalizer, TIM_HandleTypeDef *htim);
+
+/**
+ * @brief Handle compare callback - call this from HAL_TIM_OC_DelayElapsedCallback
+ * @param totalizer: Pointer to PulseTotalizer_t structure
+ * @param htim: Timer handle from the callback
+ * @retval None
+ */
+void PulseTotalizer_HandleCompare(PulseTotalizer_t *totalizer, TIM_HandleTypeDef *htim);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PULSE_TOTALIZER_H */
@@ -0,0 +1,353 @@
+/**
+ ******************************************************************************
+ * @file    rpm_filter.c
+ * @brief   Fixed-point RPM filter pipeline and alpha-beta speed tracker
+ * @author  Auto-generated
+ * @date    December 2025
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "rpm_filter.h"
+#include <string.h>
+
+/* Private variables ---------------------------------------------------------*/
+// Chains are fixed at compile time; runtime selection only swaps the table pointer
+static const uint8_t rpm_filter_chain_hysteresis[] = {
+    RPM_FILTER_STAGE_HYSTERESIS, RPM_FILTER_STAGE_END
+};
+static const uint8_t rpm_filter_chain_ema[] = {
+    RPM_FILTER_STAGE_EMA, RPM_FILTER_STAGE_END
+};
+static const uint8_t rpm_filter_chain_median3_ema[] = {
+    RPM_FILTER_STAGE_MEDIAN3, RPM_FILTER_STAGE_EMA, RPM_FILTER_STAGE_END
+};
+static const uint8_t rpm_filter_chain_median5_hysteresis[] = {
+    RPM_FILTER_STAGE_MEDIAN5, RPM_FILTER_STAGE_HYSTERESIS, RPM_FILTER_STAGE_END
+};
+static const uint8_t rpm_filter_chain_median3_ema_slew[] = {
+    RPM_FILTER_STAGE_MEDIAN3, RPM_FILTER_STAGE_EMA, RPM_FILTER_STAGE_SLEW, RPM_FILTER_STAGE_END
+};
+static const uint8_t rpm_filter_chain_none[] = {
+    RPM_FILTER_STAGE_END
+};
+
+static const uint8_t * const rpm_filter_chains[RPM_FILTER_CHAIN_COUNT] = {
+    [RPM_FILTER_CHAIN_HYSTERESIS]         = rpm_filter_chain_hysteresis,
+    [RPM_FILTER_CHAIN_EMA]                = rpm_filter_chain_ema,
+    [RPM_FILTER_CHAIN_MEDIAN3_EMA]        = rpm_filter_chain_median3_ema,
+    [RPM_FILTER_CHAIN_MEDIAN5_HYSTERESIS] = rpm_filter_chain_median5_hysteresis,
+    [RPM_FILTER_CHAIN_MEDIAN3_EMA_SLEW]   = rpm_filter_chain_median3_ema_slew,
+    [RPM_FILTER_CHAIN_NONE]               = rpm_filter_chain_none,
+};
+
+static const char * const rpm_filter_chain_names[RPM_FILTER_CHAIN_COUNT] = {
+    [RPM_FILTER_CHAIN_HYSTERESIS]         = "hyst",
+    [RPM_FILTER_CHAIN_EMA]                = "ema",
+    [RPM_FILTER_CHAIN_MEDIAN3_EMA]        = "median3>ema",
+    [RPM_FILTER_CHAIN_MEDIAN5_HYSTERESIS] = "median5>hyst",
+    [RPM_FILTER_CHAIN_MEDIAN3_EMA_SLEW]   = "median3>ema>slew",
+    [RPM_FILTER_CHAIN_NONE]               = "none",
+};
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief Saturate a 64-bit intermediate to int32
+ */
+static int32_t RpmFilter_Clamp32(int64_t value) {
+    if (value > INT32_MAX) {
+        return INT32_MAX;
+    }
+    if (value < INT32_MIN) {
+        return INT32_MIN;
+    }
+    return (int32_t)value;
+}
+
+/**
+ * @brief Median of the newest window samples, pass-through until the window fills
+ */
+static int32_t RpmFilter_Median(RpmFilter_t *filter, int32_t sample, uint8_t window) {
+    filter->median[filter->median_head] = sample;
+    filter->median_head = (uint8_t)((filter->median_head + 1U) % RPM_FILTER_MEDIAN_MAX);
+    if (filter->median_count < RPM_FILTER_MEDIAN_MAX) {
+        filter->median_count++;
+    }
+    if (filter->median_count < window) {
+        return sample;
+    }
+
+    int32_t sorted[RPM_FILTER_MEDIAN_MAX];
+    uint8_t index = filter->median_head;
+    for (uint8_t i = 0; i < window; i++) {
+        index = (uint8_t)((index + RPM_FILTER_MEDIAN_MAX - 1U) % RPM_FILTER_MEDIAN_MAX);
+        int32_t value = filter->median[index];
+        int j = (int)i - 1;
+        while (j >= 0 && sorted[j] > value) {
+            sorted[j + 1] = sorted[j];
+            j--;
+        }
+        sorted[j + 1] = value;
+    }
+    return sorted[window / 2U];
+}
+
+/**
+ * @brief Exponential moving average, y += alpha * (x - y)
+ */
+static int32_t RpmFilter_Ema(RpmFilter_t *filter, int32_t sample) {
+    if (!filter->ema_valid) {
+        filter->ema = sample;
+        filter->ema_valid = 1;
+        return sample;
+    }
+    int64_t delta = (int64_t)(sample - filter->ema) * filter->ema_alpha_q8;
+    filter->ema += (int32_t)(delta >> RPM_FILTER_Q_SHIFT);
+    return filter->ema;
+}
+
+/**
+ * @brief Limit the change from the previous output to slew_q8
+ */
+static int32_t RpmFilter_Slew(RpmFilter_t *filter, int32_t sample) {
+    if (filter->slew_valid && filter->slew_q8 > 0) {
+        if (sample > filter->slew_prev + filter->slew_q8) {
+            sample = filter->slew_prev + filter->slew_q8;
+        } else if (sample < filter->slew_prev - filter->slew_q8) {
+            sample = filter->slew_prev - filter->slew_q8;
+        }
+    }
+    filter->slew_prev = sample;
+    filter->slew_valid = 1;
+    return sample;
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief Initialize a filter with the default parameters
+ */
+void RpmFilter_Init(RpmFilter_t *filter, RpmFilterChain_t chain) {
+    if (!filter) {
+        return;
+    }
+
+    memset(filter, 0, sizeof(RpmFilter_t));
+    filter->ema_alpha_q8 = RPM_FILTER_DEFAULT_ALPHA_Q8;
+    filter->slew_q8 = (int32_t)(RPM_FILTER_DEFAULT_SLEW_RPM << RPM_FILTER_Q_SHIFT);
+    if (!RpmFilter_SetChain(filter, chain)) {
+        RpmFilter_SetChain(filter, RPM_FILTER_CHAIN_HYSTERESIS);
+    }
+}
+
+/**
+ * @brief Select the stage chain and clear the filter state
+ */
+bool RpmFilter_SetChain(RpmFilter_t *filter, RpmFilterChain_t chain) {
+    if (!filter || (unsigned)chain >= RPM_FILTER_CHAIN_COUNT) {
+        return false;
+    }
+
+    filter->chain = chain;
+    filter->stages = rpm_filter_chains[chain];
+    RpmFilter_Reset(filter);
+    return true;
+}
+
+/**
+ * @brief Set EMA weight and slew-rate limit
+ */
+bool RpmFilter_SetParams(RpmFilter_t *filter, uint16_t alpha_q8, uint32_t slew_rpm) {
+    if (!filter || alpha_q8 == 0 || alpha_q8 > RPM_FILTER_Q_ONE ||
+        slew_rpm > (INT32_MAX >> RPM_FILTER_Q_SHIFT)) {
+        return false;
+    }
+
+    filter->ema_alpha_q8 = alpha_q8;
+    filter->slew_q8 = (int32_t)(slew_rpm << RPM_FILTER_Q_SHIFT);
+    return true;
+}
+
+/**
+ * @brief Clear the state of every stage
+ */
+void RpmFilter_Reset(RpmFilter_t *filter) {
+    if (!filter) {
+        return;
+    }
+
+    filter->median_head = 0;
+    filter->median_count = 0;
+    filter->ema = 0;
+    filter->ema_valid = 0;
+    filter->hyst_prev = 0;
+    filter->hyst_stable = 0;
+    filter->slew_prev = 0;
+    filter->slew_valid = 0;
+}
+
+/**
+ * @brief Run one sample through the chain
+ */
+int32_t RpmFilter_Process(RpmFilter_t *filter, int32_t rpm_q8,
+                          const RpmFilterBand_t *bands, uint8_t band_count) {
+    if (!filter || !filter->stages) {
+        return rpm_q8;
+    }
+
+    for (const uint8_t *stage = filter->stages; *stage != RPM_FILTER_STAGE_END; stage++) {
+        switch (*stage) {
+            case RPM_FILTER_STAGE_MEDIAN3:
+                rpm_q8 = RpmFilter_Median(filter, rpm_q8, 3U);
+                break;
+            case RPM_FILTER_STAGE_MEDIAN5:
+                rpm_q8 = RpmFilter_Median(filter, rpm_q8, 5U);
+                break;
+            case RPM_FILTER_STAGE_EMA:
+                rpm_q8 = RpmFilter_Ema(filter, rpm_q8);
+                break;
+            case RPM_FILTER_STAGE_HYSTERESIS:
+                if (filter->stages == rpm_filter_chain_hysteresis) {
+                    // Legacy chain works in whole RPM, truncated like the old int cast
+                    rpm_q8 &= ~(RPM_FILTER_Q_ONE - 1);
+                }
+                rpm_q8 = RpmFilter_Hysteresis(bands, band_count, rpm_q8,
+                                              filter->hyst_prev, &filter->hyst_stable);
+                filter->hyst_prev = rpm_q8;
+                break;
+            case RPM_FILTER_STAGE_SLEW:
+                rpm_q8 = RpmFilter_Slew(filter, rpm_q8);
+                break;
+            default:
+                break;
+        }
+    }
+    return rpm_q8;
+}
+
+/**
+ * @brief Adaptive hysteresis step shared by the pipeline and the legacy API
+ */
+int32_t RpmFilter_Hysteresis(const RpmFilterBand_t *bands, uint8_t band_count,
+                             int32_t new_q8, int32_t prev_q8, uint8_t *stable) {
+    int32_t threshold = RPM_FILTER_DEFAULT_BAND;
+
+    // Find appropriate threshold from table
+    if (bands) {
+        for (int i = (int)band_count - 1; i >= 0; i--) {
+            if (new_q8 >= ((int32_t)bands[i].rpm_threshold << RPM_FILTER_Q_SHIFT)) {
+                threshold = bands[i].hysteresis;
+                break;
+            }
+        }
+    }
+    threshold <<= RPM_FILTER_Q_SHIFT;
+
+    int32_t diff = new_q8 - prev_q8;
+    int32_t abs_diff = (diff < 0) ? -diff : diff;
+
+    if (abs_diff > threshold) {
+        *stable = 0;
+        return new_q8;
+    }
+
+    if (*stable < RPM_FILTER_STABLE_SAMPLES) {
+        (*stable)++;
+    }
+    if (*stable < RPM_FILTER_STABLE_SAMPLES) {
+        return prev_q8;
+    }
+
+    // Creep towards the sample by a quarter of the gap, in whole RPM
+    int32_t step = (abs_diff / 4) & ~(RPM_FILTER_Q_ONE - 1);
+    if (step < RPM_FILTER_Q_ONE) {
+        step = RPM_FILTER_Q_ONE;
+    }
+    if (step > abs_diff) {
+        step = abs_diff;
+    }
+    return (diff < 0) ? prev_q8 - step : prev_q8 + step;
+}
+
+/**
+ * @brief Initialize an alpha-beta speed tracker
+ */
+void RpmTracker_Init(RpmTracker_t *tracker, uint16_t alpha_q8, uint16_t beta_q8) {
+    if (!tracker) {
+        return;
+    }
+
+    memset(tracker, 0, sizeof(RpmTracker_t));
+    tracker->alpha_q8 = (alpha_q8 == 0U || alpha_q8 > RPM_FILTER_Q_ONE) ? RPM_TRACKER_DEFAULT_ALPHA_Q8 : alpha_q8;
+    tracker->beta_q8 = (beta_q8 > RPM_FILTER_Q_ONE) ? RPM_TRACKER_DEFAULT_BETA_Q8 : beta_q8;
+}
+
+/**
+ * @brief Forget the estimate; the next sample seeds it again
+ */
+void RpmTracker_Reset(RpmTracker_t *tracker) {
+    if (!tracker) {
+        return;
+    }
+
+    tracker->speed_q8 = 0;
+    tracker->accel_q8 = 0;
+    tracker->variance = 0;
+    tracker->valid = 0;
+}
+
+/**
+ * @brief Correct the estimate with a new speed measurement
+ */
+int32_t RpmTracker_Update(RpmTracker_t *tracker, int32_t rpm_q8, uint32_t dt_us) {
+    if (!tracker) {
+        return rpm_q8;
+    }
+    if (!tracker->valid || dt_us == 0U) {
+        tracker->speed_q8 = rpm_q8;
+        tracker->accel_q8 = 0;
+        tracker->variance = 0;
+        tracker->valid = 1;
+        return rpm_q8;
+    }
+
+    // Predict over dt, then split the innovation between speed and acceleration
+    int64_t predicted = tracker->speed_q8 + (int64_t)tracker->accel_q8 * dt_us / 1000000;
+    int64_t residual = rpm_q8 - predicted;
+    tracker->speed_q8 = RpmFilter_Clamp32(predicted + ((residual * tracker->alpha_q8) >> RPM_FILTER_Q_SHIFT));
+    tracker->accel_q8 = RpmFilter_Clamp32(tracker->accel_q8 +
+        ((residual * tracker->beta_q8) >> RPM_FILTER_Q_SHIFT) * 1000000 / dt_us);
+
+    // Innovation variance in RPM^2
+    int64_t square = (residual * residual) >> (2 * RPM_FILTER_Q_SHIFT);
+    int64_t variance = (int64_t)tracker->variance + ((square - (int64_t)tracker->variance) >> RPM_TRACKER_VARIANCE_SHIFT);
+    tracker->variance = (variance > UINT32_MAX) ? UINT32_MAX : (uint32_t)variance;
+
+    if (tracker->speed_q8 < 0) {
+        tracker->speed_q8 = 0;
+    }
+    return tracker->speed_q8;
+}
+
+/**
+ * @brief Extrapolate the estimate without a measurement
+ */
+int32_t RpmTracker_Predict(const RpmTracker_t *tracker, uint32_t dt_us) {
+    if (!tracker || !tracker->valid) {
+        return 0;
+    }
+
+    int32_t predicted = RpmFilter_Clamp32(tracker->speed_q8 + (int64_t)tracker->accel_q8 * dt_us / 1000000);
+    return (predicted < 0) ? 0 : predicted;
+}
+
+/**
+ * @brief Get a printable name of a chain
+ */
+const char* RpmFilter_ChainName(RpmFilterChain_t chain) {
+    if ((unsigned)chain >= RPM_FILTER_CHAIN_COUNT) {
+        return "?";
+    }
+    return rpm_filter_chain_names[chain];
+}
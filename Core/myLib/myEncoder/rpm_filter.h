@@ -0,0 +1,193 @@
+/**
+ ******************************************************************************
+ * @file    rpm_filter.h
+ * @brief   Fixed-point RPM filter pipeline and alpha-beta speed tracker
+ * @author  Auto-generated
+ * @date    December 2025
+ ******************************************************************************
+ */
+
+#ifndef __RPM_FILTER_H
+#define __RPM_FILTER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Exported defines ----------------------------------------------------------*/
+// Samples travel through the pipeline as Q8 RPM (RPM * 256)
+#define RPM_FILTER_Q_SHIFT          8
+#define RPM_FILTER_Q_ONE            (1L << RPM_FILTER_Q_SHIFT)
+#define RPM_FILTER_MEDIAN_MAX       5U
+#define RPM_FILTER_MAX_STAGES       4U
+#define RPM_FILTER_DEFAULT_ALPHA_Q8 77U     // ~0.3, same weight as Encoder_GetRPM
+#define RPM_FILTER_DEFAULT_SLEW_RPM 200U    // Max change per sample
+#define RPM_FILTER_DEFAULT_BAND     50      // Hysteresis when no band table is given
+#define RPM_FILTER_STABLE_SAMPLES   10U     // In-band samples before the output creeps
+
+// Alpha-beta tracker gains in 1/256, critically damped pair (beta = alpha^2 / (2 - alpha))
+#define RPM_TRACKER_DEFAULT_ALPHA_Q8 128U
+#define RPM_TRACKER_DEFAULT_BETA_Q8  43U
+#define RPM_TRACKER_VARIANCE_SHIFT   3      // Innovation variance averages over 2^3 updates
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum {
+    RPM_FILTER_STAGE_END = 0,
+    RPM_FILTER_STAGE_MEDIAN3,
+    RPM_FILTER_STAGE_MEDIAN5,
+    RPM_FILTER_STAGE_EMA,
+    RPM_FILTER_STAGE_HYSTERESIS,
+    RPM_FILTER_STAGE_SLEW
+} RpmFilterStage_t;
+
+typedef enum {
+    RPM_FILTER_CHAIN_HYSTERESIS = 0,    // Legacy behaviour, zero-initialised configs keep it
+    RPM_FILTER_CHAIN_EMA,
+    RPM_FILTER_CHAIN_MEDIAN3_EMA,
+    RPM_FILTER_CHAIN_MEDIAN5_HYSTERESIS,
+    RPM_FILTER_CHAIN_MEDIAN3_EMA_SLEW,
+    RPM_FILTER_CHAIN_NONE,
+    RPM_FILTER_CHAIN_COUNT
+} RpmFilterChain_t;
+
+typedef struct {
+    uint16_t rpm_threshold;  // RPM threshold for this entry
+    uint16_t hysteresis;     // Hysteresis value for this threshold
+} RpmFilterBand_t;
+
+typedef struct {
+    const uint8_t *stages;              // RPM_FILTER_STAGE_END terminated, from the chain table
+    RpmFilterChain_t chain;
+    uint16_t ema_alpha_q8;              // 1..256, weight of the new sample
+    int32_t slew_q8;                    // Max change per sample, 0 = unlimited
+
+    // Per-stage state
+    int32_t median[RPM_FILTER_MEDIAN_MAX];
+    uint8_t median_head;
+    uint8_t median_count;
+    int32_t ema;
+    uint8_t ema_valid;
+    int32_t hyst_prev;
+    uint8_t hyst_stable;
+    int32_t slew_prev;
+    uint8_t slew_valid;
+} RpmFilter_t;
+
+typedef struct {
+    int32_t speed_q8;                   // Estimated speed, Q8 RPM
+    int32_t accel_q8;                   // Estimated acceleration, Q8 RPM/s
+    uint32_t variance;                  // Mean squared innovation, RPM^2
+    uint16_t alpha_q8;                  // Speed gain, 1..256
+    uint16_t beta_q8;                   // Acceleration gain, 0..256
+    uint8_t valid;                      // Seeded by a first sample
+} RpmTracker_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+
+/**
+ * @brief Initialize a filter with the default parameters
+ * @param filter: Pointer to RpmFilter_t structure
+ * @param chain: Stage chain to run
+ * @retval None
+ */
+void RpmFilter_Init(RpmFilter_t *filter, RpmFilterChain_t chain);
+
+/**
+ * @brief Select the stage chain and clear the filter state
+ * @param filter: Pointer to RpmFilter_t structure
+ * @param chain: Stage chain to run
+ * @retval true if the chain exists
+ */
+bool RpmFilter_SetChain(RpmFilter_t *filter, RpmFilterChain_t chain);
+
+/**
+ * @brief Set EMA weight and slew-rate limit
+ * @param filter: Pointer to RpmFilter_t structure
+ * @param alpha_q8: Weight of the new sample in 1/256 (1..256)
+ * @param slew_rpm: Max output change per sample in RPM, 0 = unlimited
+ * @retval true if the parameters are in range
+ */
+bool RpmFilter_SetParams(RpmFilter_t *filter, uint16_t alpha_q8, uint32_t slew_rpm);
+
+/**
+ * @brief Clear the state of every stage
+ * @param filter: Pointer to RpmFilter_t structure
+ * @retval None
+ */
+void RpmFilter_Reset(RpmFilter_t *filter);
+
+/**
+ * @brief Run one sample through the chain
+ * @param filter: Pointer to RpmFilter_t structure
+ * @param rpm_q8: New sample in Q8 RPM
+ * @param bands: Hysteresis table sorted by rpm_threshold (may be NULL)
+ * @param band_count: Number of entries in bands
+ * @retval Filtered value in Q8 RPM
+ */
+int32_t RpmFilter_Process(RpmFilter_t *filter, int32_t rpm_q8,
+                          const RpmFilterBand_t *bands, uint8_t band_count);
+
+/**
+ * @brief Adaptive hysteresis step shared by the pipeline and the legacy API
+ * @param bands: Hysteresis table sorted by rpm_threshold (may be NULL)
+ * @param band_count: Number of entries in bands
+ * @param new_q8: New sample in Q8 RPM
+ * @param prev_q8: Previous output in Q8 RPM
+ * @param stable: Pointer to the in-band sample counter
+ * @retval Filtered value in Q8 RPM
+ * @note Creeping steps are whole RPM, so integer inputs give integer outputs.
+ *       RpmFilter_Process truncates samples to whole RPM on the legacy
+ *       RPM_FILTER_CHAIN_HYSTERESIS chain.
+ */
+int32_t RpmFilter_Hysteresis(const RpmFilterBand_t *bands, uint8_t band_count,
+                             int32_t new_q8, int32_t prev_q8, uint8_t *stable);
+
+/**
+ * @brief Initialize an alpha-beta speed tracker
+ * @param tracker: Pointer to RpmTracker_t structure
+ * @param alpha_q8: Speed gain in 1/256 (1..256, 0 = default)
+ * @param beta_q8: Acceleration gain in 1/256 (0..256)
+ * @retval None
+ */
+void RpmTracker_Init(RpmTracker_t *tracker, uint16_t alpha_q8, uint16_t beta_q8);
+
+/**
+ * @brief Forget the estimate; the next sample seeds it again
+ * @param tracker: Pointer to RpmTracker_t structure
+ * @retval None
+ */
+void RpmTracker_Reset(RpmTracker_t *tracker);
+
+/**
+ * @brief Correct the estimate with a new speed measurement
+ * @param tracker: Pointer to RpmTracker_t structure
+ * @param rpm_q8: Measured speed in Q8 RPM
+ * @param dt_us: Time since the previous measurement in microseconds
+ * @retval Estimated speed in Q8 RPM
+ */
+int32_t RpmTracker_Update(RpmTracker_t *tracker, int32_t rpm_q8, uint32_t dt_us);
+
+/**
+ * @brief Extrapolate the estimate without a measurement
+ * @param tracker: Pointer to RpmTracker_t structure
+ * @param dt_us: Time since the last update in microseconds
+ * @retval Predicted speed in Q8 RPM, never negative
+ */
+int32_t RpmTracker_Predict(const RpmTracker_t *tracker, uint32_t dt_us);
+
+/**
+ * @brief Get a printable name of a chain
+ * @param chain: Stage chain
+ * @retval Name such as "median3>ema", "?" if unknown
+ */
+const char* RpmFilter_ChainName(RpmFilterChain_t chain);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RPM_FILTER_H */
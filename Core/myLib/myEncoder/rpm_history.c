@@ -0,0 +1,195 @@
+/**
+ ******************************************************************************
+ * @file    rpm_history.c
+ * @brief   Multi-resolution speed history (round-robin tiers of mean/min/max)
+ * @author  Auto-generated
+ * @date    December 2025
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "rpm_history.h"
+#include <string.h>
+
+/* Private variables ---------------------------------------------------------*/
+static const uint16_t rpm_history_sizes[RPM_HISTORY_TIERS] = {
+    RPM_HISTORY_TIER0_SIZE, RPM_HISTORY_TIER1_SIZE, RPM_HISTORY_TIER2_SIZE
+};
+static const uint16_t rpm_history_spans[RPM_HISTORY_TIERS] = {
+    0U, RPM_HISTORY_TIER1_SPAN, RPM_HISTORY_TIER2_SPAN
+};
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief Q8 RPM -> entry units, saturated to a word
+ */
+static uint16_t RpmHistory_Units(int64_t rpm_q8) {
+    if (rpm_q8 <= 0) {
+        return 0;
+    }
+    uint64_t units = ((uint64_t)rpm_q8 * RPM_HISTORY_UNITS_PER_RPM + 128U) >> 8;
+    return (units > 0xFFFFU) ? 0xFFFFU : (uint16_t)units;
+}
+
+/**
+ * @brief Empty the entry being built
+ */
+static void RpmHistory_ClearTier(RpmHistoryTier_t *tier) {
+    tier->sum = 0;
+    tier->n = 0;
+    tier->min = 0xFFFFU;
+    tier->max = 0;
+}
+
+/**
+ * @brief Empty the open tier 0 slot
+ */
+static void RpmHistory_ClearSlot(RpmHistory_t *history) {
+    history->slot_sum_q8 = 0;
+    history->slot_n = 0;
+    history->slot_min_q8 = INT32_MAX;
+    history->slot_max_q8 = INT32_MIN;
+}
+
+/**
+ * @brief Store an entry in a tier and consolidate it into the tiers above
+ * @note One step per tier: the next tier only closes when span entries
+ *       have been added to it.
+ */
+static void RpmHistory_Push(RpmHistory_t *history, uint32_t level, uint16_t mean, uint16_t min, uint16_t max) {
+    while (level < RPM_HISTORY_TIERS) {
+        RpmHistoryTier_t *tier = &history->tier[level];
+        uint16_t *entry = &tier->entries[tier->head * RPM_HISTORY_ENTRY_WORDS];
+        entry[0] = mean;
+        entry[1] = min;
+        entry[2] = max;
+        tier->head = (uint16_t)((tier->head + 1U) % tier->size);
+        if (tier->count < tier->size) {
+            tier->count++;
+        }
+
+        if (++level >= RPM_HISTORY_TIERS) {
+            break;
+        }
+        RpmHistoryTier_t *up = &history->tier[level];
+        up->sum += mean;
+        up->n++;
+        if (min < up->min) {
+            up->min = min;
+        }
+        if (max > up->max) {
+            up->max = max;
+        }
+        if (up->n < up->span) {
+            break;
+        }
+        mean = (uint16_t)((up->sum + up->n / 2U) / up->n);
+        min = up->min;
+        max = up->max;
+        RpmHistory_ClearTier(up);
+    }
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief Initialize the tiers over caller storage
+ */
+void RpmHistory_Init(RpmHistory_t *history, uint16_t *storage, uint32_t now_ms) {
+    if (!history || !storage) {
+        return;
+    }
+
+    memset(history, 0, sizeof(RpmHistory_t));
+    for (uint32_t i = 0; i < RPM_HISTORY_TIERS; i++) {
+        history->tier[i].entries = storage;
+        history->tier[i].size = rpm_history_sizes[i];
+        history->tier[i].span = rpm_history_spans[i];
+        storage += rpm_history_sizes[i] * RPM_HISTORY_ENTRY_WORDS;
+    }
+    RpmHistory_Reset(history, now_ms);
+}
+
+/**
+ * @brief Clear every tier
+ */
+void RpmHistory_Reset(RpmHistory_t *history, uint32_t now_ms) {
+    if (!history) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < RPM_HISTORY_TIERS; i++) {
+        RpmHistoryTier_t *tier = &history->tier[i];
+        if (tier->entries) {
+            memset(tier->entries, 0, tier->size * RPM_HISTORY_ENTRY_WORDS * sizeof(uint16_t));
+        }
+        tier->head = 0;
+        tier->count = 0;
+        RpmHistory_ClearTier(tier);
+    }
+    history->slot_start_ms = now_ms;
+    RpmHistory_ClearSlot(history);
+}
+
+/**
+ * @brief Add one speed sample to the open tier 0 slot
+ */
+void RpmHistory_Add(RpmHistory_t *history, int32_t rpm_q8) {
+    if (!history) {
+        return;
+    }
+
+    history->slot_sum_q8 += (uint64_t)((rpm_q8 > 0) ? rpm_q8 : 0);
+    history->slot_n++;
+    if (rpm_q8 < history->slot_min_q8) {
+        history->slot_min_q8 = rpm_q8;
+    }
+    if (rpm_q8 > history->slot_max_q8) {
+        history->slot_max_q8 = rpm_q8;
+    }
+}
+
+/**
+ * @brief Close the tier 0 slots that have run out and roll them up
+ */
+void RpmHistory_Tick(RpmHistory_t *history, uint32_t now_ms, int32_t rpm_q8) {
+    if (!history || !history->tier[0].entries) {
+        return;
+    }
+
+    // Called late (blocking flash write): more than a full ring behind starts over at now
+    if ((now_ms - history->slot_start_ms) >= RPM_HISTORY_SLOT_MS * RPM_HISTORY_TIER0_SIZE) {
+        history->slot_start_ms = now_ms - RPM_HISTORY_SLOT_MS;
+    }
+
+    while ((now_ms - history->slot_start_ms) >= RPM_HISTORY_SLOT_MS) {
+        if (history->slot_n > 0U) {
+            RpmHistory_Push(history, 0, RpmHistory_Units((int64_t)(history->slot_sum_q8 / history->slot_n)),
+                            RpmHistory_Units(history->slot_min_q8), RpmHistory_Units(history->slot_max_q8));
+        } else {
+            // No output in this slot: the speed held (or stayed at zero)
+            uint16_t held = RpmHistory_Units(rpm_q8);
+            RpmHistory_Push(history, 0, held, held, held);
+        }
+        RpmHistory_ClearSlot(history);
+        history->slot_start_ms += RPM_HISTORY_SLOT_MS;
+    }
+}
+
+/**
+ * @brief Get an entry, 0 = newest
+ */
+bool RpmHistory_Get(const RpmHistory_t *history, uint32_t tier, uint32_t age, uint16_t entry[RPM_HISTORY_ENTRY_WORDS]) {
+    if (!history || !entry || tier >= RPM_HISTORY_TIERS) {
+        return false;
+    }
+
+    const RpmHistoryTier_t *t = &history->tier[tier];
+    if (!t->entries || age >= t->count) {
+        return false;
+    }
+    uint32_t index = (t->head + t->size - 1U - age) % t->size;
+    memcpy(entry, &t->entries[index * RPM_HISTORY_ENTRY_WORDS], RPM_HISTORY_ENTRY_WORDS * sizeof(uint16_t));
+    return true;
+}
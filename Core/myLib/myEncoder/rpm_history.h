@@ -0,0 +1,112 @@
+/**
+ ******************************************************************************
+ * @file    rpm_history.h
+ * @brief   Multi-resolution speed history (round-robin tiers of mean/min/max)
+ * @author  Auto-generated
+ * @date    December 2025
+ ******************************************************************************
+ */
+
+#ifndef __RPM_HISTORY_H
+#define __RPM_HISTORY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Exported defines ----------------------------------------------------------*/
+// Tier 0 consolidates raw samples per slot; every higher tier consolidates
+// span entries of the tier below it, so each roll-up is constant time
+#define RPM_HISTORY_TIERS           3U
+#define RPM_HISTORY_SLOT_MS         100UL    // Tier 0 entry length
+#define RPM_HISTORY_TIER0_SIZE      100U     // 100 x 100 ms = 10 s
+#define RPM_HISTORY_TIER1_SIZE      120U     // 120 x 1 s = 2 min
+#define RPM_HISTORY_TIER1_SPAN      10U      // Tier 0 entries per tier 1 entry
+#define RPM_HISTORY_TIER2_SIZE      60U      // 60 x 1 min = 1 h
+#define RPM_HISTORY_TIER2_SPAN      60U      // Tier 1 entries per tier 2 entry
+
+// Entries are three words (mean, min, max) in 1/RPM_HISTORY_UNITS_PER_RPM RPM, saturated
+#define RPM_HISTORY_UNITS_PER_RPM   10U
+#define RPM_HISTORY_ENTRY_WORDS     3U
+#define RPM_HISTORY_WORDS           (RPM_HISTORY_ENTRY_WORDS * \
+                                     (RPM_HISTORY_TIER0_SIZE + RPM_HISTORY_TIER1_SIZE + RPM_HISTORY_TIER2_SIZE))
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct {
+    uint16_t *entries;                  // size x {mean, min, max}, oldest at head once full
+    uint16_t size;                      // Entries in the ring
+    uint16_t span;                      // Lower-tier entries per entry (0 for tier 0)
+    volatile uint16_t head;             // Next entry written
+    volatile uint16_t count;            // Valid entries, saturates at size
+    // Consolidation of the entry being built
+    uint32_t sum;
+    uint16_t n;
+    uint16_t min;
+    uint16_t max;
+} RpmHistoryTier_t;
+
+typedef struct {
+    RpmHistoryTier_t tier[RPM_HISTORY_TIERS];
+    uint32_t slot_start_ms;             // Tick the open tier 0 slot started
+    // Raw samples of the open tier 0 slot, Q8 RPM
+    uint64_t slot_sum_q8;
+    uint32_t slot_n;
+    int32_t slot_min_q8;
+    int32_t slot_max_q8;
+} RpmHistory_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+
+/**
+ * @brief Initialize the tiers over caller storage
+ * @param history: Pointer to RpmHistory_t structure
+ * @param storage: RPM_HISTORY_WORDS words, tier 0 first; may be a Modbus register table
+ * @param now_ms: Current tick in ms
+ * @retval None
+ */
+void RpmHistory_Init(RpmHistory_t *history, uint16_t *storage, uint32_t now_ms);
+
+/**
+ * @brief Clear every tier
+ * @param history: Pointer to RpmHistory_t structure
+ * @param now_ms: Current tick in ms
+ * @retval None
+ */
+void RpmHistory_Reset(RpmHistory_t *history, uint32_t now_ms);
+
+/**
+ * @brief Add one speed sample to the open tier 0 slot
+ * @param history: Pointer to RpmHistory_t structure
+ * @param rpm_q8: Sample in Q8 RPM
+ * @retval None
+ */
+void RpmHistory_Add(RpmHistory_t *history, int32_t rpm_q8);
+
+/**
+ * @brief Close the tier 0 slots that have run out and roll them up
+ * @param history: Pointer to RpmHistory_t structure
+ * @param now_ms: Current tick in ms
+ * @param rpm_q8: Current output speed, entered for a slot without samples
+ * @retval None
+ */
+void RpmHistory_Tick(RpmHistory_t *history, uint32_t now_ms, int32_t rpm_q8);
+
+/**
+ * @brief Get an entry, 0 = newest
+ * @param history: Pointer to RpmHistory_t structure
+ * @param tier: 0..RPM_HISTORY_TIERS-1
+ * @param age: Entries back from the newest
+ * @param entry: Receives mean, min, max in 1/RPM_HISTORY_UNITS_PER_RPM RPM
+ * @retval true if the entry exists
+ */
+bool RpmHistory_Get(const RpmHistory_t *history, uint32_t tier, uint32_t age, uint16_t entry[RPM_HISTORY_ENTRY_WORDS]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RPM_HISTORY_H */
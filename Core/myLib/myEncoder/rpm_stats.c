@@ -0,0 +1,179 @@
+/**
+ ******************************************************************************
+ * @file    rpm_stats.c
+ * @brief   Fixed-point windowed speed statistics (mean, stddev, min, max)
+ * @author  Auto-generated
+ * @date    December 2025
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "rpm_stats.h"
+#include <string.h>
+
+/* Private variables ---------------------------------------------------------*/
+static const uint32_t rpm_stats_default_windows[RPM_STATS_WINDOWS] = {
+    RPM_STATS_DEFAULT_WINDOW_1, RPM_STATS_DEFAULT_WINDOW_2, RPM_STATS_DEFAULT_WINDOW_3
+};
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief Integer square root, once per closed window
+ */
+static uint32_t RpmStats_Sqrt(uint64_t value) {
+    uint64_t root = 0;
+    uint64_t bit = 1ULL << 62;
+
+    while (bit > value) {
+        bit >>= 2;
+    }
+    while (bit != 0U) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)root;
+}
+
+/**
+ * @brief Empty the running accumulator of a window
+ */
+static void RpmStats_Clear(RpmStatsWindow_t *window) {
+    window->count = 0;
+    window->mean = 0;
+    window->m2 = 0;
+    window->min_q8 = INT32_MAX;
+    window->max_q8 = INT32_MIN;
+}
+
+/**
+ * @brief Publish the running accumulator as the window's result
+ */
+static void RpmStats_Close(RpmStatsWindow_t *window) {
+    RpmStatsResult_t *last = &window->last;
+
+    last->count = window->count;
+    if (window->count > 0U) {
+        last->mean_q8 = (window->mean + (1L << (RPM_STATS_MEAN_SHIFT - 1))) >> RPM_STATS_MEAN_SHIFT;
+        last->stddev_q8 = RpmStats_Sqrt(window->m2 / window->count);  // Q16 RPM^2 -> Q8 RPM
+        last->min_q8 = window->min_q8;
+        last->max_q8 = window->max_q8;
+    } else {
+        last->mean_q8 = 0;
+        last->stddev_q8 = 0;
+        last->min_q8 = 0;
+        last->max_q8 = 0;
+    }
+    last->sequence++;
+    RpmStats_Clear(window);
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief Initialize the windows and open them at now_ms
+ */
+void RpmStats_Init(RpmStats_t *stats, const uint32_t *window_ms, uint32_t now_ms) {
+    if (!stats) {
+        return;
+    }
+
+    memset(stats, 0, sizeof(RpmStats_t));
+    for (uint32_t i = 0; i < RPM_STATS_WINDOWS; i++) {
+        stats->window[i].window_ms = window_ms ? window_ms[i] : rpm_stats_default_windows[i];
+    }
+    RpmStats_Reset(stats, now_ms);
+}
+
+/**
+ * @brief Drop the running windows and the published results
+ */
+void RpmStats_Reset(RpmStats_t *stats, uint32_t now_ms) {
+    if (!stats) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < RPM_STATS_WINDOWS; i++) {
+        RpmStatsWindow_t *window = &stats->window[i];
+        memset(&window->last, 0, sizeof(RpmStatsResult_t));
+        window->start_ms = now_ms;
+        RpmStats_Clear(window);
+    }
+}
+
+/**
+ * @brief Add one speed sample to every window
+ */
+void RpmStats_Add(RpmStats_t *stats, int32_t rpm_q8) {
+    if (!stats) {
+        return;
+    }
+
+    if (rpm_q8 > RPM_STATS_MAX_Q8) {
+        rpm_q8 = RPM_STATS_MAX_Q8;
+    } else if (rpm_q8 < -RPM_STATS_MAX_Q8) {
+        rpm_q8 = -RPM_STATS_MAX_Q8;
+    }
+    int32_t x = rpm_q8 * (1L << RPM_STATS_MEAN_SHIFT);
+
+    for (uint32_t i = 0; i < RPM_STATS_WINDOWS; i++) {
+        RpmStatsWindow_t *window = &stats->window[i];
+        if (window->window_ms == 0U) {
+            continue;
+        }
+
+        // Welford: mean += d / n, m2 += d * (x - new mean)
+        window->count++;
+        int32_t delta = x - window->mean;
+        window->mean += delta / (int32_t)window->count;
+        int64_t spread = (int64_t)delta * (int64_t)(x - window->mean);
+        window->m2 += (uint64_t)(spread >> (2 * RPM_STATS_MEAN_SHIFT));
+
+        if (rpm_q8 < window->min_q8) {
+            window->min_q8 = rpm_q8;
+        }
+        if (rpm_q8 > window->max_q8) {
+            window->max_q8 = rpm_q8;
+        }
+    }
+}
+
+/**
+ * @brief Close the windows whose time has run out
+ */
+void RpmStats_Tick(RpmStats_t *stats, uint32_t now_ms) {
+    if (!stats) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < RPM_STATS_WINDOWS; i++) {
+        RpmStatsWindow_t *window = &stats->window[i];
+        if (window->window_ms == 0U || (now_ms - window->start_ms) < window->window_ms) {
+            continue;
+        }
+
+        RpmStats_Close(window);
+        window->start_ms += window->window_ms;
+        // Called late (blocking flash write, debugger): realign instead of replaying empty windows
+        if ((now_ms - window->start_ms) >= window->window_ms) {
+            window->start_ms = now_ms;
+        }
+    }
+}
+
+/**
+ * @brief Get the result of the last closed window
+ */
+bool RpmStats_Get(const RpmStats_t *stats, uint32_t window, RpmStatsResult_t *result) {
+    if (!stats || !result || window >= RPM_STATS_WINDOWS) {
+        return false;
+    }
+
+    *result = stats->window[window].last;
+    return true;
+}
@@ -0,0 +1,108 @@
+/**
+ ******************************************************************************
+ * @file    rpm_stats.h
+ * @brief   Fixed-point windowed speed statistics (mean, stddev, min, max)
+ * @author  Auto-generated
+ * @date    December 2025
+ ******************************************************************************
+ */
+
+#ifndef __RPM_STATS_H
+#define __RPM_STATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Exported defines ----------------------------------------------------------*/
+// Samples arrive as Q8 RPM like the filter pipeline; the running mean keeps 4 more bits
+#define RPM_STATS_WINDOWS           3U
+#define RPM_STATS_MEAN_SHIFT        4
+#define RPM_STATS_MAX_Q8            (32767L << 8)   // Larger samples are clamped
+#define RPM_STATS_DEFAULT_WINDOW_1  1000UL          // ms
+#define RPM_STATS_DEFAULT_WINDOW_2  10000UL
+#define RPM_STATS_DEFAULT_WINDOW_3  60000UL
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct {
+    uint32_t count;                     // Samples in the window
+    int32_t mean_q8;                    // Q8 RPM
+    uint32_t stddev_q8;                 // Population standard deviation, Q8 RPM
+    int32_t min_q8;
+    int32_t max_q8;
+    uint32_t sequence;                  // Windows closed so far, tells a poller the result is new
+} RpmStatsResult_t;
+
+typedef struct {
+    uint32_t window_ms;                 // Window length, 0 = unused slot
+    uint32_t start_ms;                  // Tick the running window opened
+    // Welford accumulator of the running window
+    uint32_t count;
+    int32_t mean;                       // Q(8 + RPM_STATS_MEAN_SHIFT) RPM
+    uint64_t m2;                        // Sum of squared deviations, Q16 RPM^2
+    int32_t min_q8;
+    int32_t max_q8;
+    RpmStatsResult_t last;              // Result of the last closed window
+} RpmStatsWindow_t;
+
+typedef struct {
+    RpmStatsWindow_t window[RPM_STATS_WINDOWS];
+} RpmStats_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+
+/**
+ * @brief Initialize the windows and open them at now_ms
+ * @param stats: Pointer to RpmStats_t structure
+ * @param window_ms: RPM_STATS_WINDOWS lengths in ms, NULL = 1 s / 10 s / 60 s
+ * @param now_ms: Current tick in ms
+ * @retval None
+ */
+void RpmStats_Init(RpmStats_t *stats, const uint32_t *window_ms, uint32_t now_ms);
+
+/**
+ * @brief Drop the running windows and the published results
+ * @param stats: Pointer to RpmStats_t structure
+ * @param now_ms: Current tick in ms
+ * @retval None
+ */
+void RpmStats_Reset(RpmStats_t *stats, uint32_t now_ms);
+
+/**
+ * @brief Add one speed sample to every window
+ * @param stats: Pointer to RpmStats_t structure
+ * @param rpm_q8: Sample in Q8 RPM
+ * @retval None
+ * @note O(1) per window: Welford update of mean and squared deviations,
+ *       no sample history is kept.
+ */
+void RpmStats_Add(RpmStats_t *stats, int32_t rpm_q8);
+
+/**
+ * @brief Close the windows whose time has run out
+ * @param stats: Pointer to RpmStats_t structure
+ * @param now_ms: Current tick in ms
+ * @retval None
+ * @note Windows are back to back; one that closes without samples
+ *       publishes a count of 0.
+ */
+void RpmStats_Tick(RpmStats_t *stats, uint32_t now_ms);
+
+/**
+ * @brief Get the result of the last closed window
+ * @param stats: Pointer to RpmStats_t structure
+ * @param window: 0..RPM_STATS_WINDOWS-1
+ * @param result: Receives the result
+ * @retval true if window exists
+ */
+bool RpmStats_Get(const RpmStats_t *stats, uint32_t window, RpmStatsResult_t *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RPM_STATS_H */
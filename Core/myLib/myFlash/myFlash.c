@@ -228,3 +228,216 @@ void myFlash_LoadDebugConfig(myDebugConfig *out)
     out->enabled = (uint8_t)((data >> 16) & 0xFF);
     out->interval = (uint16_t)(data & 0xFFFF);
 }
+
+HAL_StatusTypeDef myFlash_SaveChannelTable(const myChannelTable *table)
+{
+    uint32_t buffer[MYFLASH_AUX_CHANNELS * 4U];
+    for (uint32_t i = 0; i < MYFLASH_AUX_CHANNELS; i++) {
+        buffer[i * 4U + 0U] = table->channels[i].enabled;
+        buffer[i * 4U + 1U] = table->channels[i].pulsesPerRev;
+        buffer[i * 4U + 2U] = table->channels[i].diameter;
+        buffer[i * 4U + 3U] = table->channels[i].timeout;
+    }
+    return NVS_WriteWords(MYFLASH_PAGE_CHANNELS, buffer, MYFLASH_AUX_CHANNELS * 4U);
+}
+
+void myFlash_LoadChannelTable(myChannelTable *out)
+{
+    uint32_t buffer[MYFLASH_AUX_CHANNELS * 4U];
+    NVS_ReadWords(MYFLASH_PAGE_CHANNELS, buffer, MYFLASH_AUX_CHANNELS * 4U);
+    for (uint32_t i = 0; i < MYFLASH_AUX_CHANNELS; i++) {
+        uint32_t *ch = &buffer[i * 4U];
+        if (ch[0] > 1U) {
+            ch[0] = 0U; // Erased page: channel off
+        }
+        if (ch[1] == 0U || ch[1] > 10000U) {
+            ch[1] = 1U; // Default PPR 1
+        }
+        if (ch[2] == 0U || ch[2] > 100000U) {
+            ch[2] = 250U; // Default diameter in mm
+        }
+        if (ch[3] < 1000U || ch[3] > 60000U) {
+            ch[3] = 10000U; // Default 10s timeout in ms
+        }
+        out->channels[i].enabled      = ch[0];
+        out->channels[i].pulsesPerRev = ch[1];
+        out->channels[i].diameter     = ch[2];
+        out->channels[i].timeout      = ch[3];
+    }
+}
+
+HAL_StatusTypeDef myFlash_SaveToothTable(const myToothTable *table)
+{
+    uint32_t buffer[1U + MYFLASH_TOOTH_MAX / 2U];
+    buffer[0] = table->teeth;
+    // Two corrections per word: [odd:16][even:16]
+    for (uint32_t i = 0; i < MYFLASH_TOOTH_MAX / 2U; i++) {
+        buffer[1U + i] = ((uint32_t)table->correction[2U * i + 1U] << 16) | table->correction[2U * i];
+    }
+    return NVS_WriteWords(MYFLASH_PAGE_TOOTH, buffer, 1U + MYFLASH_TOOTH_MAX / 2U);
+}
+
+void myFlash_LoadToothTable(myToothTable *out)
+{
+    uint32_t buffer[1U + MYFLASH_TOOTH_MAX / 2U];
+    NVS_ReadWords(MYFLASH_PAGE_TOOTH, buffer, 1U + MYFLASH_TOOTH_MAX / 2U);
+    out->teeth = buffer[0];
+    if (out->teeth < 2U || out->teeth > MYFLASH_TOOTH_MAX) {
+        out->teeth = 0U; // Erased page: no table
+    }
+    for (uint32_t i = 0; i < MYFLASH_TOOTH_MAX / 2U; i++) {
+        out->correction[2U * i]      = (uint16_t)(buffer[1U + i] & 0xFFFFU);
+        out->correction[2U * i + 1U] = (uint16_t)(buffer[1U + i] >> 16);
+    }
+    for (uint32_t i = 0; i < out->teeth; i++) {
+        if (out->correction[i] == 0U) {
+            out->teeth = 0U; // Corrupt entry
+        }
+    }
+}
+
+HAL_StatusTypeDef myFlash_SaveMissingTeeth(uint32_t missing)
+{
+    return NVS_WriteWords(MYFLASH_PAGE_SYNC, &missing, 1U);
+}
+
+uint32_t myFlash_LoadMissingTeeth(void)
+{
+    uint32_t missing = NVS_ReadWord(MYFLASH_PAGE_SYNC);
+    return (missing == 0xFFFFFFFFU) ? 0U : missing; // Erased page: no gap
+}
+
+HAL_StatusTypeDef myFlash_SaveDirectionSensor(uint32_t enabled)
+{
+    return NVS_WriteWords(MYFLASH_PAGE_DIRECTION, &enabled, 1U);
+}
+
+uint32_t myFlash_LoadDirectionSensor(void)
+{
+    uint32_t enabled = NVS_ReadWord(MYFLASH_PAGE_DIRECTION);
+    return (enabled == 1U) ? 1U : 0U; // Erased page: off
+}
+
+HAL_StatusTypeDef myFlash_SavePulseConfig(const myPulseConfig *config)
+{
+    uint32_t data;
+    // Pack config into data: [dutyRef:16][reserved:8][mode:8]
+    data = ((uint32_t)config->dutyRef << 16) | (uint32_t)config->mode;
+    return NVS_WriteWords(MYFLASH_PAGE_PULSE, &data, 1U);
+}
+
+void myFlash_LoadPulseConfig(myPulseConfig *out)
+{
+    uint32_t data = NVS_ReadWord(MYFLASH_PAGE_PULSE);
+    out->mode = (uint8_t)(data & 0xFFU);
+    out->dutyRef = (uint16_t)(data >> 16);
+    if (out->mode > 2U) {
+        out->mode = 0U;    // Erased page: off
+        out->dutyRef = 0U;
+    }
+    if (out->dutyRef > 10000U) {
+        out->dutyRef = 0U;
+    }
+}
+
+HAL_StatusTypeDef myFlash_SaveTotalizerLevels(const myTotalizerLevels *levels)
+{
+    uint32_t buffer[2] = { levels->preset, levels->target };
+    return NVS_WriteWords(MYFLASH_PAGE_TOTALIZER, buffer, 2U);
+}
+
+void myFlash_LoadTotalizerLevels(myTotalizerLevels *out)
+{
+    uint32_t buffer[2];
+    NVS_ReadWords(MYFLASH_PAGE_TOTALIZER, buffer, 2U);
+    out->preset = (buffer[0] == 0xFFFFFFFFU) ? 0U : buffer[0]; // Erased page: off
+    out->target = (buffer[1] == 0xFFFFFFFFU) ? 0U : buffer[1];
+}
+
+HAL_StatusTypeDef myFlash_SaveTraceConfig(const myTraceConfig *config)
+{
+    // [post:16][pre:16], overspeed RPM, glitch trigger
+    uint32_t buffer[3] = {
+        ((uint32_t)config->post << 16) | config->pre,
+        config->overspeedRpm,
+        config->onGlitch
+    };
+    return NVS_WriteWords(MYFLASH_PAGE_TRACE, buffer, 3U);
+}
+
+void myFlash_LoadTraceConfig(myTraceConfig *out)
+{
+    uint32_t buffer[3];
+    NVS_ReadWords(MYFLASH_PAGE_TRACE, buffer, 3U);
+    if (buffer[0] == 0xFFFFFFFFU) {
+        out->pre = 128U;           // Erased page: default window, no automatic trigger
+        out->post = 64U;
+        out->overspeedRpm = 0U;
+        out->onGlitch = 0U;
+        return;
+    }
+    out->pre = (uint16_t)(buffer[0] & 0xFFFFU);
+    out->post = (uint16_t)(buffer[0] >> 16);
+    out->overspeedRpm = buffer[1];
+    out->onGlitch = (buffer[2] == 1U) ? 1U : 0U;
+}
+
+HAL_StatusTypeDef myFlash_SaveQuadEncoderTable(const myQuadEncoderTable *table)
+{
+    // Low-speed counts after the original blocks, so a table saved without them stays aligned
+    uint32_t buffer[MYFLASH_QUAD_ENCODERS * (MYFLASH_QUAD_ENCODER_WORDS + 1U)];
+    for (uint32_t i = 0; i < MYFLASH_QUAD_ENCODERS; i++) {
+        buffer[i * MYFLASH_QUAD_ENCODER_WORDS + 0U] = table->encoders[i].enabled;
+        buffer[i * MYFLASH_QUAD_ENCODER_WORDS + 1U] = table->encoders[i].pulsesPerRev;
+        buffer[i * MYFLASH_QUAD_ENCODER_WORDS + 2U] = table->encoders[i].diameter;
+        buffer[i * MYFLASH_QUAD_ENCODER_WORDS + 3U] = table->encoders[i].sampleTimeMs;
+        buffer[MYFLASH_QUAD_ENCODERS * MYFLASH_QUAD_ENCODER_WORDS + i] = table->encoders[i].lowSpeedCounts;
+    }
+    return NVS_WriteWords(MYFLASH_PAGE_QUAD_ENCODERS, buffer, MYFLASH_QUAD_ENCODERS * (MYFLASH_QUAD_ENCODER_WORDS + 1U));
+}
+
+void myFlash_LoadQuadEncoderTable(myQuadEncoderTable *out)
+{
+    uint32_t buffer[MYFLASH_QUAD_ENCODERS * (MYFLASH_QUAD_ENCODER_WORDS + 1U)];
+    NVS_ReadWords(MYFLASH_PAGE_QUAD_ENCODERS, buffer, MYFLASH_QUAD_ENCODERS * (MYFLASH_QUAD_ENCODER_WORDS + 1U));
+    for (uint32_t i = 0; i < MYFLASH_QUAD_ENCODERS; i++) {
+        uint32_t *enc = &buffer[i * MYFLASH_QUAD_ENCODER_WORDS];
+        if (enc[0] > 1U) {
+            enc[0] = 0U; // Erased page: encoder off
+        }
+        if (enc[1] == 0U || enc[1] > 10000U) {
+            enc[1] = 1000U; // Default 1000 PPR
+        }
+        if (enc[2] == 0U || enc[2] > 100000U) {
+            enc[2] = 250U; // Default diameter in mm
+        }
+        if (enc[3] < 10U || enc[3] > 10000U) {
+            enc[3] = 100U; // Default 100 ms RPM update
+        }
+        uint32_t lowSpeed = buffer[MYFLASH_QUAD_ENCODERS * MYFLASH_QUAD_ENCODER_WORDS + i];
+        if (lowSpeed > 1000U) {
+            lowSpeed = 16U; // Erased: time edges below 16 counts per window
+        }
+        out->encoders[i].enabled      = enc[0];
+        out->encoders[i].pulsesPerRev = enc[1];
+        out->encoders[i].diameter     = enc[2];
+        out->encoders[i].sampleTimeMs = enc[3];
+        out->encoders[i].lowSpeedCounts = lowSpeed;
+    }
+}
+
+HAL_StatusTypeDef myFlash_SaveCaptureConfig(const myCaptureConfig *config)
+{
+    uint32_t buffer[4] = { config->method, config->gateMs, config->maxAccel, config->maxIrqHz };
+    return NVS_WriteWords(MYFLASH_PAGE_CAPTURE, buffer, 4U);
+}
+
+void myFlash_LoadCaptureConfig(myCaptureConfig *out)
+{
+    uint32_t buffer[4];
+    NVS_ReadWords(MYFLASH_PAGE_CAPTURE, buffer, 4U);
+    out->method = (buffer[0] == 1U) ? 1U : 0U; // Erased page: T-method
+    out->gateMs = (buffer[1] >= 10U && buffer[1] <= 10000U) ? buffer[1] : 100U;
+    out->maxAccel = (buffer[2] == 0xFFFFFFFFU) ? 0U : buffer[2]; // Erased: glitch rejection off
+    out->maxIrqHz = (buffer[3] == 0xFFFFFFFFU) ? 0U : buffer[3]; // Erased: capture every edge
+}
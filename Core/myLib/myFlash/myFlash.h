@@ -15,6 +15,20 @@
 #define MYFLASH_PAGE_HYSTERESIS 	0x0801E400U  // hysteresis table
 #define MYFLASH_PAGE_MODBUS_UART 	0x0801E000U  // Modbus UART configuration (page-aligned)
 #define MYFLASH_PAGE_DEBUG 			0x0801DC00U  // debug data
+#define MYFLASH_PAGE_CHANNELS 		0x0801D800U  // extra proximity channels (TIM2 CH2..CH4)
+#define MYFLASH_PAGE_TOOTH 			0x0801D400U  // CH1 per-tooth spacing corrections
+#define MYFLASH_PAGE_SYNC 			0x0801D000U  // CH1 missing-tooth gap width
+#define MYFLASH_PAGE_DIRECTION 		0x0801CC00U  // CH1 direction sensor on CH2
+#define MYFLASH_PAGE_PULSE 			0x0801C800U  // CH1 pulse-width mode and duty reference
+#define MYFLASH_PAGE_TOTALIZER 		0x0801C400U  // TIM4 totalizer preset/target levels
+#define MYFLASH_PAGE_TRACE 			0x0801C000U  // CH1 raw trace window and triggers
+#define MYFLASH_PAGE_QUAD_ENCODERS 	0x0801BC00U  // quadrature encoders by timer (TIM1..TIM4)
+#define MYFLASH_PAGE_CAPTURE 		0x0801B800U  // proximity capture settings shared by CH1..CH4
+
+#define MYFLASH_AUX_CHANNELS  		3U           // CH1 keeps using MYFLASH_PAGE_ENCODER
+#define MYFLASH_TOOTH_MAX     		64U          // matches PROXIMITY_TOOTH_MAX
+#define MYFLASH_QUAD_ENCODERS 		4U           // matches ENCODER_TIMER_COUNT
+#define MYFLASH_QUAD_ENCODER_WORDS 4U        // words per encoder, low-speed counts follow all blocks
 // === Data structures ===
 typedef struct {
 	uint32_t baudRate;        // e.g., 9600, 115200
@@ -63,6 +77,58 @@ typedef struct {
 	uint16_t interval;
 	uint8_t enabled;
 } myDebugConfig;
+
+typedef struct {
+	uint32_t enabled;         // 1=channel measured, 0=off
+	uint32_t pulsesPerRev;    // PPR
+	uint32_t diameter;        // DIA in mm
+	uint32_t timeout;         // no-pulse timeout in ms
+} myChannelParams;
+
+typedef struct {
+	myChannelParams channels[MYFLASH_AUX_CHANNELS];  // [0] = CH2 ... [2] = CH4
+} myChannelTable;
+
+typedef struct {
+	uint32_t teeth;                              // valid entries, 0 = no table
+	uint16_t correction[MYFLASH_TOOTH_MAX];      // Q14 period multipliers
+} myToothTable;
+
+typedef struct {
+	uint8_t mode;             // 0=off, 1=pulse width, 2=pulse width + both edges
+	uint16_t dutyRef;         // reference duty in 0.01 %, 0 = none
+} myPulseConfig;
+
+typedef struct {
+	uint32_t preset;          // preset level in pulses, 0 = off
+	uint32_t target;          // target level in pulses, 0 = off
+} myTotalizerLevels;
+
+typedef struct {
+	uint16_t pre;             // periods kept before the trigger
+	uint16_t post;            // periods recorded after it
+	uint32_t overspeedRpm;    // trigger above this RPM, 0 = off
+	uint8_t onGlitch;         // trigger on a rejected glitch edge
+} myTraceConfig;
+
+typedef struct {
+	uint32_t enabled;         // 1=encoder counted on this timer, 0=off
+	uint32_t pulsesPerRev;    // PPR per channel (x4 applied by the encoder lib)
+	uint32_t diameter;        // wheel DIA in mm
+	uint32_t sampleTimeMs;    // RPM update period in ms
+	uint32_t lowSpeedCounts;  // Window counts below which edges are timed (1/T), 0 = off
+} myQuadEncoderParams;
+
+typedef struct {
+	myQuadEncoderParams encoders[MYFLASH_QUAD_ENCODERS];  // [0] = TIM1 ... [3] = TIM4
+} myQuadEncoderTable;
+
+typedef struct {
+	uint32_t method;          // 0=T-method (period), 1=M/T gate count
+	uint32_t gateMs;          // M/T gate time in ms
+	uint32_t maxAccel;        // Glitch rejection limit in RPM/s, 0=off
+	uint32_t maxIrqHz;        // Capture rate ceiling per channel, 0=every edge
+} myCaptureConfig;
 // === High-level helpers built on NVS ===
 HAL_StatusTypeDef myFlash_SaveUARTParams(const myUARTParams *params);
 void               myFlash_LoadUARTParams(myUARTParams *out);
@@ -90,6 +156,33 @@ void               myFlash_LoadHysteresisTable(myHysteresisTable *out);
 
 HAL_StatusTypeDef myFlash_SaveDebugConfig(const myDebugConfig *log);
 void               myFlash_LoadDebugConfig(myDebugConfig *out);
+
+HAL_StatusTypeDef myFlash_SaveChannelTable(const myChannelTable *table);
+void               myFlash_LoadChannelTable(myChannelTable *out);
+
+HAL_StatusTypeDef myFlash_SaveToothTable(const myToothTable *table);
+void               myFlash_LoadToothTable(myToothTable *out);
+
+HAL_StatusTypeDef myFlash_SaveMissingTeeth(uint32_t missing);
+uint32_t           myFlash_LoadMissingTeeth(void);
+
+HAL_StatusTypeDef myFlash_SaveDirectionSensor(uint32_t enabled);
+uint32_t           myFlash_LoadDirectionSensor(void);
+
+HAL_StatusTypeDef myFlash_SavePulseConfig(const myPulseConfig *config);
+void               myFlash_LoadPulseConfig(myPulseConfig *out);
+
+HAL_StatusTypeDef myFlash_SaveTotalizerLevels(const myTotalizerLevels *levels);
+void               myFlash_LoadTotalizerLevels(myTotalizerLevels *out);
+
+HAL_StatusTypeDef myFlash_SaveTraceConfig(const myTraceConfig *config);
+void               myFlash_LoadTraceConfig(myTraceConfig *out);
+
+HAL_StatusTypeDef myFlash_SaveQuadEncoderTable(const myQuadEncoderTable *table);
+void               myFlash_LoadQuadEncoderTable(myQuadEncoderTable *out);
+
+HAL_StatusTypeDef myFlash_SaveCaptureConfig(const myCaptureConfig *config);
+void               myFlash_LoadCaptureConfig(myCaptureConfig *out);
 // === Low-level backward-compatible aliases ===
 #define myFlash_Write(addr, data)      NVS_WriteWord((addr), (data))
 #define myFlash_Read(addr)             NVS_ReadWord((addr))
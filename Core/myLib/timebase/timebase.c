@@ -0,0 +1,92 @@
+/**
+ ******************************************************************************
+ * @file    timebase.c
+ * @brief   Shared 64-bit high-resolution timestamps (DWT cycle counter)
+ * @author  Auto-generated
+ * @date    December 2025
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "timebase.h"
+
+/* Private variables ---------------------------------------------------------*/
+static uint64_t timebase_tick0;             // Extended HAL tick at the origin
+static uint32_t timebase_cycles0;           // CYCCNT at the origin
+static volatile uint32_t timebase_halves;   // Bit 31 changes of the HAL tick, written by SysTick only
+static bool timebase_started;
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief The cycle counter is enabled and counting
+ */
+static bool Timebase_IsRunning(void) {
+    return (CoreDebug->DEMCR & CoreDebug_DEMCR_TRCENA_Msk) && (DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk);
+}
+
+/**
+ * @brief HAL tick extended to 64 bits
+ * @note A half wrap Timebase_Tick has not counted yet shows as a parity
+ *       mismatch with bit 31 of the tick and is added here.
+ */
+static uint64_t Timebase_TickMs(void) {
+    uint32_t halves = timebase_halves;
+    uint32_t tick = HAL_GetTick();
+
+    if ((halves & 1U) != (tick >> 31)) {
+        halves++;
+    }
+    return ((uint64_t)(halves >> 1) << 32) | tick;
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief Start the DWT cycle counter and take the time origin
+ */
+void Timebase_Init(void) {
+    // Restarts if the counter was stopped meanwhile (host sim reset)
+    if (timebase_started && Timebase_IsRunning()) {
+        return;
+    }
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    timebase_tick0 = Timebase_TickMs();
+    timebase_cycles0 = DWT->CYCCNT;
+    timebase_started = true;
+}
+
+/**
+ * @brief SysTick hook, call after HAL_IncTick()
+ */
+void Timebase_Tick(void) {
+    if ((timebase_halves & 1U) != (HAL_GetTick() >> 31)) {
+        timebase_halves++;
+    }
+}
+
+/**
+ * @brief Core clock cycles since Timebase_Init()
+ */
+uint64_t Timebase_GetCycles(void) {
+    uint64_t estimate = (Timebase_TickMs() - timebase_tick0) * (SystemCoreClock / 1000U);
+    if (!Timebase_IsRunning()) {
+        return estimate;
+    }
+
+    // The tick is within a few ms of the truth, CYCCNT gives the exact
+    // residue modulo 2^32: take the value with that residue nearest the tick
+    uint32_t cycles = DWT->CYCCNT - timebase_cycles0;
+    int32_t offset = (int32_t)(cycles - (uint32_t)estimate);
+    return estimate + (int64_t)offset;
+}
+
+/**
+ * @brief Microseconds since Timebase_Init()
+ */
+uint64_t Timebase_GetMicros(void) {
+    return Timebase_CyclesToMicros(Timebase_GetCycles());
+}
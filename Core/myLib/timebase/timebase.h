@@ -0,0 +1,69 @@
+/**
+ ******************************************************************************
+ * @file    timebase.h
+ * @brief   Shared 64-bit high-resolution timestamps (DWT cycle counter)
+ * @author  Auto-generated
+ * @date    December 2025
+ ******************************************************************************
+ */
+
+#ifndef __TIMEBASE_H
+#define __TIMEBASE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Exported functions prototypes ---------------------------------------------*/
+
+/**
+ * @brief Start the DWT cycle counter and take the time origin
+ * @retval None
+ * @note Idempotent: every module that reads the timebase calls it from its
+ *       own init, the first call wins.
+ */
+void Timebase_Init(void);
+
+/**
+ * @brief SysTick hook, call after HAL_IncTick()
+ * @retval None
+ * @note Only carries the 32-bit HAL tick across its wrap (every ~49.7 days);
+ *       the readers below do not depend on it otherwise.
+ */
+void Timebase_Tick(void);
+
+/**
+ * @brief Core clock cycles since Timebase_Init()
+ * @retval 64-bit cycle count, never wraps
+ * @note No shared state is written, so it is safe from any interrupt priority.
+ *       The 32-bit CYCCNT is placed on the HAL tick, which only has to be
+ *       within half a CYCCNT wrap (~29 s at 72 MHz). Falls back to tick
+ *       resolution if the cycle counter is not running.
+ */
+uint64_t Timebase_GetCycles(void);
+
+/**
+ * @brief Microseconds since Timebase_Init()
+ * @retval 64-bit microsecond count
+ */
+uint64_t Timebase_GetMicros(void);
+
+/**
+ * @brief Convert a cycle interval to microseconds
+ * @param cycles: Difference of two Timebase_GetCycles() values
+ * @retval Microseconds
+ */
+static inline uint64_t Timebase_CyclesToMicros(uint64_t cycles) {
+    return cycles / (SystemCoreClock / 1000000U);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TIMEBASE_H */
@@ -0,0 +1,126 @@
+/**
+ ******************************************************************************
+ * @file    hal_sim.h
+ * @brief   Controls for the simulated peripherals behind the host HAL shim
+ * @date    October 2026
+ ******************************************************************************
+ * @attention
+ *
+ * The simulated timer keeps CNT/CCRx/SR/DIER as plain registers. Events are
+ * split the same way the silicon splits them: HAL_Sim_TIM_Advance() and
+ * HAL_Sim_TIM_Capture() only latch values and raise flags, and
+ * HAL_Sim_TIM_IRQ() runs the pending interrupt exactly like TIMx_IRQHandler
+ * would. Tests can therefore stage any interleaving of captures and updates
+ * before the ISR sees them.
+ *
+ ******************************************************************************
+ */
+
+#ifndef __HAL_SIM_H
+#define __HAL_SIM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f1xx_hal.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct {
+    const UART_HandleTypeDef *huart;   // Handle of the last transmit
+    uint8_t data[256];                 // Copy of the last transmitted frame
+    uint16_t len;                      // Length of the last transmitted frame
+    uint32_t count;                    // Number of transmits since reset
+} HAL_Sim_UartTx_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+
+/**
+ * @brief Reset every simulated peripheral, the tick and the flash image
+ * @retval None
+ */
+void HAL_Sim_Reset(void);
+
+/**
+ * @brief Set / advance the millisecond tick returned by HAL_GetTick()
+ */
+void HAL_Sim_SetTick(uint32_t tick);
+void HAL_Sim_AdvanceTick(uint32_t ms);
+
+/**
+ * @brief Advance time by microseconds: DWT->CYCCNT (if enabled) and the tick
+ * @note HAL_Sim_AdvanceTick() moves the cycle counter as well; HAL_Sim_SetTick()
+ *       does not.
+ */
+void HAL_Sim_AdvanceMicros(uint32_t us);
+
+/**
+ * @brief Advance the timer counter by a number of counter ticks
+ * @param htim: Timer handle
+ * @param ticks: Counter ticks (after the prescaler)
+ * @retval Number of counter wraps; UIF is raised on any wrap but not serviced
+ */
+uint32_t HAL_Sim_TIM_Advance(TIM_HandleTypeDef *htim, uint32_t ticks);
+
+/**
+ * @brief Count the timer down by a number of counter ticks (encoder turning backwards)
+ * @param htim: Timer handle
+ * @param ticks: Counter ticks
+ * @retval Number of underflows; UIF is raised on any underflow but not serviced
+ * @note Sets CR1.DIR like the encoder interface; HAL_Sim_TIM_Advance() clears it.
+ */
+uint32_t HAL_Sim_TIM_Retreat(TIM_HandleTypeDef *htim, uint32_t ticks);
+
+/**
+ * @brief Advance the timer by a number of timer clock cycles (before the prescaler)
+ * @param htim: Timer handle
+ * @param clocks: Timer clock cycles
+ * @retval Number of counter wraps; UIF is raised on any wrap but not serviced
+ * @note A PSC written since the last update only applies after the next wrap.
+ */
+uint32_t HAL_Sim_TIM_AdvanceClocks(TIM_HandleTypeDef *htim, uint32_t clocks);
+
+/**
+ * @brief Latch CNT into CCRx of a capture channel and raise CCxIF
+ * @param htim: Timer handle
+ * @param channel: TIM_CHANNEL_1..TIM_CHANNEL_4
+ * @retval None
+ * @note Sets CCxOF if CCxIF was still pending, like the hardware. With CCxDE
+ *       enabled the value is moved by the linked DMA channel instead. With
+ *       ICxPSC set only every 2nd/4th/8th call latches.
+ */
+void HAL_Sim_TIM_Capture(TIM_HandleTypeDef *htim, uint32_t channel);
+
+/**
+ * @brief Latch an explicit value into CCRx and raise CCxIF
+ */
+void HAL_Sim_TIM_CaptureValue(TIM_HandleTypeDef *htim, uint32_t channel, uint16_t value);
+
+/**
+ * @brief Service pending, enabled timer events through HAL_TIM_IRQHandler
+ * @retval true if the handler ran
+ */
+bool HAL_Sim_TIM_IRQ(TIM_HandleTypeDef *htim);
+
+/**
+ * @brief Service pending, enabled HT/TC events through HAL_DMA_IRQHandler
+ * @retval true if the handler ran
+ */
+bool HAL_Sim_DMA_IRQ(DMA_HandleTypeDef *hdma);
+
+/**
+ * @brief Feed bytes into an active HAL_UART_Receive_DMA buffer (circular)
+ */
+void HAL_Sim_UART_Receive(UART_HandleTypeDef *huart, const uint8_t *data, uint16_t len);
+
+/**
+ * @brief Last frame handed to HAL_UART_Transmit / HAL_UART_Transmit_DMA
+ */
+const HAL_Sim_UartTx_t *HAL_Sim_UART_LastTx(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HAL_SIM_H */
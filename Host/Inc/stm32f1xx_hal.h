@@ -0,0 +1,600 @@
+/**
+ ******************************************************************************
+ * @file    stm32f1xx_hal.h
+ * @brief   Host-side stand-in for the STM32F1 HAL used by Core/myLib
+ * @date    October 2026
+ ******************************************************************************
+ * @attention
+ *
+ * This header is only on the include path of the Host/ build. It exposes the
+ * subset of the STM32F1xx HAL and CMSIS API that the myLib modules touch, with
+ * the same names, register layout and bit positions as the real headers, so
+ * the library sources compile unmodified on x86-64. Peripherals are plain
+ * structs driven by hal_sim.c; see hal_sim.h for the simulation controls.
+ *
+ ******************************************************************************
+ */
+
+#ifndef __STM32F1xx_HAL_H
+#define __STM32F1xx_HAL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/* Exported defines ----------------------------------------------------------*/
+#define __IO    volatile
+#define __I     volatile const
+#define __weak  __attribute__((weak))
+
+#define HAL_MAX_DELAY      0xFFFFFFFFU
+
+#define SET                1U
+#define RESET              0U
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum {
+    HAL_OK       = 0x00U,
+    HAL_ERROR    = 0x01U,
+    HAL_BUSY     = 0x02U,
+    HAL_TIMEOUT  = 0x03U
+} HAL_StatusTypeDef;
+
+typedef enum {
+    HAL_UNLOCKED = 0x00U,
+    HAL_LOCKED   = 0x01U
+} HAL_LockTypeDef;
+
+typedef enum {
+    TIM1_UP_IRQn        = 25,
+    TIM2_IRQn           = 28,
+    TIM3_IRQn           = 29,
+    TIM4_IRQn           = 30,
+    DMA1_Channel1_IRQn  = 11,
+    DMA1_Channel2_IRQn  = 12,
+    DMA1_Channel3_IRQn  = 13,
+    DMA1_Channel4_IRQn  = 14,
+    DMA1_Channel5_IRQn  = 15,
+    DMA1_Channel6_IRQn  = 16,
+    DMA1_Channel7_IRQn  = 17,
+    USART1_IRQn         = 37,
+    USART3_IRQn         = 39
+} IRQn_Type;
+
+/* ============================== Core (CMSIS) ============================== */
+
+extern volatile uint32_t hal_sim_primask;
+extern volatile uint32_t hal_sim_irq_disable_count;
+
+static inline uint32_t __get_PRIMASK(void) { return hal_sim_primask; }
+static inline void __set_PRIMASK(uint32_t primask) { hal_sim_primask = primask; }
+static inline void __disable_irq(void) { hal_sim_primask = 1U; hal_sim_irq_disable_count++; }
+static inline void __enable_irq(void) { hal_sim_primask = 0U; }
+static inline void __DSB(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void __DMB(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void __ISB(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void __NOP(void) { }
+
+extern uint32_t SystemCoreClock;
+
+/* DWT cycle counter; counts only with TRCENA and CYCCNTENA set, like the core */
+typedef struct {
+    __IO uint32_t CTRL;
+    __IO uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct {
+    __IO uint32_t DHCSR;
+    __IO uint32_t DCRSR;
+    __IO uint32_t DCRDR;
+    __IO uint32_t DEMCR;
+} CoreDebug_Type;
+
+#define DWT_CTRL_CYCCNTENA_Msk      (0x1UL << 0U)
+#define CoreDebug_DEMCR_TRCENA_Msk  (0x1UL << 24U)
+
+extern DWT_Type hal_sim_dwt;
+extern CoreDebug_Type hal_sim_coredebug;
+#define DWT        (&hal_sim_dwt)
+#define CoreDebug  (&hal_sim_coredebug)
+
+/* ================================== TIM =================================== */
+
+typedef struct {
+    __IO uint32_t CR1;
+    __IO uint32_t CR2;
+    __IO uint32_t SMCR;
+    __IO uint32_t DIER;
+    __IO uint32_t SR;
+    __IO uint32_t EGR;
+    __IO uint32_t CCMR1;
+    __IO uint32_t CCMR2;
+    __IO uint32_t CCER;
+    __IO uint32_t CNT;
+    __IO uint32_t PSC;
+    __IO uint32_t ARR;
+    __IO uint32_t RCR;
+    __IO uint32_t CCR1;
+    __IO uint32_t CCR2;
+    __IO uint32_t CCR3;
+    __IO uint32_t CCR4;
+    __IO uint32_t BDTR;
+    __IO uint32_t DCR;
+    __IO uint32_t DMAR;
+    __IO uint32_t OR;
+} TIM_TypeDef;
+
+/* Register bits (same positions as stm32f103xb.h) */
+#define TIM_CR1_CEN         (0x1UL << 0U)
+#define TIM_CR1_URS         (0x1UL << 2U)
+#define TIM_CR1_DIR         (0x1UL << 4U)
+#define TIM_CR1_ARPE        (0x1UL << 7U)
+
+#define TIM_SMCR_SMS        (0x7UL << 0U)
+#define TIM_SMCR_TS         (0x7UL << 4U)
+#define TIM_SMCR_ETF        (0xFUL << 8U)
+#define TIM_SMCR_ETPS       (0x3UL << 12U)
+#define TIM_SMCR_ECE        (0x1UL << 14U)
+#define TIM_SMCR_ETP        (0x1UL << 15U)
+
+#define TIM_DIER_UIE        (0x1UL << 0U)
+#define TIM_DIER_CC1IE      (0x1UL << 1U)
+#define TIM_DIER_CC2IE      (0x1UL << 2U)
+#define TIM_DIER_CC3IE      (0x1UL << 3U)
+#define TIM_DIER_CC4IE      (0x1UL << 4U)
+#define TIM_DIER_UDE        (0x1UL << 8U)
+#define TIM_DIER_CC1DE      (0x1UL << 9U)
+#define TIM_DIER_CC2DE      (0x1UL << 10U)
+#define TIM_DIER_CC3DE      (0x1UL << 11U)
+#define TIM_DIER_CC4DE      (0x1UL << 12U)
+
+#define TIM_SR_UIF          (0x1UL << 0U)
+#define TIM_SR_CC1IF        (0x1UL << 1U)
+#define TIM_SR_CC2IF        (0x1UL << 2U)
+#define TIM_SR_CC3IF        (0x1UL << 3U)
+#define TIM_SR_CC4IF        (0x1UL << 4U)
+#define TIM_SR_CC1OF        (0x1UL << 9U)
+#define TIM_SR_CC2OF        (0x1UL << 10U)
+#define TIM_SR_CC3OF        (0x1UL << 11U)
+#define TIM_SR_CC4OF        (0x1UL << 12U)
+
+#define TIM_EGR_UG          (0x1UL << 0U)
+
+#define TIM_CCMR1_CC1S      (0x3UL << 0U)
+#define TIM_CCMR1_CC1S_0    (0x1UL << 0U)
+#define TIM_CCMR1_CC1S_1    (0x2UL << 0U)
+#define TIM_CCMR1_IC1PSC    (0x3UL << 2U)
+#define TIM_CCMR1_IC1PSC_0  (0x1UL << 2U)
+#define TIM_CCMR1_IC1PSC_1  (0x2UL << 2U)
+#define TIM_CCMR1_IC1F      (0xFUL << 4U)
+#define TIM_CCMR1_CC2S      (0x3UL << 8U)
+#define TIM_CCMR1_IC2PSC    (0x3UL << 10U)
+#define TIM_CCMR1_IC2F      (0xFUL << 12U)
+
+#define TIM_CCER_CC1E       (0x1UL << 0U)
+#define TIM_CCER_CC1P       (0x1UL << 1U)
+
+/* HAL identifiers */
+#define TIM_CHANNEL_1                   0x00000000U
+#define TIM_CHANNEL_2                   0x00000004U
+#define TIM_CHANNEL_3                   0x00000008U
+#define TIM_CHANNEL_4                   0x0000000CU
+#define TIM_CHANNEL_ALL                 0x0000003CU
+
+#define TIM_FLAG_UPDATE                 TIM_SR_UIF
+#define TIM_FLAG_CC1                    TIM_SR_CC1IF
+#define TIM_FLAG_CC2                    TIM_SR_CC2IF
+#define TIM_FLAG_CC3                    TIM_SR_CC3IF
+#define TIM_FLAG_CC4                    TIM_SR_CC4IF
+#define TIM_FLAG_CC1OF                  TIM_SR_CC1OF
+#define TIM_FLAG_CC2OF                  TIM_SR_CC2OF
+#define TIM_FLAG_CC3OF                  TIM_SR_CC3OF
+#define TIM_FLAG_CC4OF                  TIM_SR_CC4OF
+
+#define TIM_IT_UPDATE                   TIM_DIER_UIE
+#define TIM_IT_CC1                      TIM_DIER_CC1IE
+#define TIM_IT_CC2                      TIM_DIER_CC2IE
+#define TIM_IT_CC3                      TIM_DIER_CC3IE
+#define TIM_IT_CC4                      TIM_DIER_CC4IE
+
+#define TIM_DMA_UPDATE                  TIM_DIER_UDE
+#define TIM_DMA_CC1                     TIM_DIER_CC1DE
+#define TIM_DMA_CC2                     TIM_DIER_CC2DE
+#define TIM_DMA_CC3                     TIM_DIER_CC3DE
+#define TIM_DMA_CC4                     TIM_DIER_CC4DE
+
+#define TIM_DMA_ID_UPDATE               ((uint16_t) 0x0000)
+#define TIM_DMA_ID_CC1                  ((uint16_t) 0x0001)
+#define TIM_DMA_ID_CC2                  ((uint16_t) 0x0002)
+#define TIM_DMA_ID_CC3                  ((uint16_t) 0x0003)
+#define TIM_DMA_ID_CC4                  ((uint16_t) 0x0004)
+
+#define TIM_COUNTERMODE_UP              0x00000000U
+#define TIM_CLOCKDIVISION_DIV1          0x00000000U
+#define TIM_AUTORELOAD_PRELOAD_DISABLE  0x00000000U
+#define TIM_AUTORELOAD_PRELOAD_ENABLE   TIM_CR1_ARPE
+#define TIM_CLOCKSOURCE_INTERNAL        (0x1UL << 12U)
+#define TIM_CLOCKSOURCE_ETRMODE2        (0x2UL << 12U)
+#define TIM_CLOCKSOURCE_TI1             (0x5UL << 4U)
+#define TIM_CLOCKPOLARITY_INVERTED      TIM_SMCR_ETP
+#define TIM_CLOCKPOLARITY_NONINVERTED   0x00000000U
+#define TIM_CLOCKPOLARITY_RISING        TIM_INPUTCHANNELPOLARITY_RISING
+#define TIM_CLOCKPOLARITY_FALLING       TIM_INPUTCHANNELPOLARITY_FALLING
+#define TIM_CLOCKPRESCALER_DIV1         0x00000000U
+#define TIM_TRGO_RESET                  0x00000000U
+#define TIM_MASTERSLAVEMODE_DISABLE     0x00000000U
+
+#define TIM_ICPOLARITY_RISING           0x00000000U
+#define TIM_ICPOLARITY_FALLING          TIM_CCER_CC1P
+#define TIM_INPUTCHANNELPOLARITY_RISING   0x00000000U
+#define TIM_INPUTCHANNELPOLARITY_FALLING  TIM_CCER_CC1P
+#define TIM_INPUTCHANNELPOLARITY_BOTHEDGE (TIM_CCER_CC1P | (0x1UL << 3U))
+
+#define TIM_ICSELECTION_DIRECTTI        TIM_CCMR1_CC1S_0
+#define TIM_ICSELECTION_INDIRECTTI      TIM_CCMR1_CC1S_1
+#define TIM_ICSELECTION_TRC             TIM_CCMR1_CC1S
+
+#define TIM_ICPSC_DIV1                  0x00000000U
+#define TIM_ICPSC_DIV2                  TIM_CCMR1_IC1PSC_0
+#define TIM_ICPSC_DIV4                  TIM_CCMR1_IC1PSC_1
+#define TIM_ICPSC_DIV8                  TIM_CCMR1_IC1PSC
+
+#define TIM_OCMODE_TIMING               0x00000000U
+#define TIM_OCPOLARITY_HIGH             0x00000000U
+#define TIM_OCFAST_DISABLE              0x00000000U
+
+#define TIM_ENCODERMODE_TI1             0x00000001U
+#define TIM_ENCODERMODE_TI2             0x00000002U
+#define TIM_ENCODERMODE_TI12            0x00000003U
+
+typedef enum {
+    HAL_TIM_ACTIVE_CHANNEL_1       = 0x01U,
+    HAL_TIM_ACTIVE_CHANNEL_2       = 0x02U,
+    HAL_TIM_ACTIVE_CHANNEL_3       = 0x04U,
+    HAL_TIM_ACTIVE_CHANNEL_4       = 0x08U,
+    HAL_TIM_ACTIVE_CHANNEL_CLEARED = 0x00U
+} HAL_TIM_ActiveChannel;
+
+typedef enum {
+    HAL_TIM_STATE_RESET = 0x00U,
+    HAL_TIM_STATE_READY = 0x01U,
+    HAL_TIM_STATE_BUSY  = 0x02U
+} HAL_TIM_StateTypeDef;
+
+typedef struct {
+    uint32_t Prescaler;
+    uint32_t CounterMode;
+    uint32_t Period;
+    uint32_t ClockDivision;
+    uint32_t RepetitionCounter;
+    uint32_t AutoReloadPreload;
+} TIM_Base_InitTypeDef;
+
+typedef struct {
+    uint32_t ICPolarity;
+    uint32_t ICSelection;
+    uint32_t ICPrescaler;
+    uint32_t ICFilter;
+} TIM_IC_InitTypeDef;
+
+typedef struct {
+    uint32_t OCMode;
+    uint32_t Pulse;
+    uint32_t OCPolarity;
+    uint32_t OCNPolarity;
+    uint32_t OCFastMode;
+    uint32_t OCIdleState;
+    uint32_t OCNIdleState;
+} TIM_OC_InitTypeDef;
+
+typedef struct {
+    uint32_t EncoderMode;
+    uint32_t IC1Polarity;
+    uint32_t IC1Selection;
+    uint32_t IC1Prescaler;
+    uint32_t IC1Filter;
+    uint32_t IC2Polarity;
+    uint32_t IC2Selection;
+    uint32_t IC2Prescaler;
+    uint32_t IC2Filter;
+} TIM_Encoder_InitTypeDef;
+
+typedef struct {
+    uint32_t ClockSource;
+    uint32_t ClockPolarity;
+    uint32_t ClockPrescaler;
+    uint32_t ClockFilter;
+} TIM_ClockConfigTypeDef;
+
+typedef struct {
+    uint32_t MasterOutputTrigger;
+    uint32_t MasterSlaveMode;
+} TIM_MasterConfigTypeDef;
+
+struct __DMA_HandleTypeDef;
+
+typedef struct {
+    TIM_TypeDef                  *Instance;
+    TIM_Base_InitTypeDef         Init;
+    HAL_TIM_ActiveChannel        Channel;
+    struct __DMA_HandleTypeDef   *hdma[7];
+    HAL_LockTypeDef              Lock;
+    __IO HAL_TIM_StateTypeDef    State;
+} TIM_HandleTypeDef;
+
+extern TIM_TypeDef hal_sim_tim1;
+extern TIM_TypeDef hal_sim_tim2;
+extern TIM_TypeDef hal_sim_tim3;
+extern TIM_TypeDef hal_sim_tim4;
+#define TIM1  (&hal_sim_tim1)
+#define TIM2  (&hal_sim_tim2)
+#define TIM3  (&hal_sim_tim3)
+#define TIM4  (&hal_sim_tim4)
+
+#define __HAL_TIM_GET_COUNTER(__HANDLE__)            ((__HANDLE__)->Instance->CNT)
+#define __HAL_TIM_SET_COUNTER(__HANDLE__, __C__)     ((__HANDLE__)->Instance->CNT = (__C__))
+#define __HAL_TIM_GET_AUTORELOAD(__HANDLE__)         ((__HANDLE__)->Instance->ARR)
+#define __HAL_TIM_SET_AUTORELOAD(__HANDLE__, __A__)  \
+    do { (__HANDLE__)->Instance->ARR = (__A__); (__HANDLE__)->Init.Period = (__A__); } while (0)
+#define __HAL_TIM_SET_PRESCALER(__HANDLE__, __P__)   ((__HANDLE__)->Instance->PSC = (__P__))
+#define __HAL_TIM_GET_FLAG(__HANDLE__, __F__)        (((__HANDLE__)->Instance->SR & (__F__)) == (__F__))
+/* SR bits are rc_w0 on silicon; a plain struct needs an explicit AND to clear only __F__ */
+#define __HAL_TIM_CLEAR_FLAG(__HANDLE__, __F__)      ((__HANDLE__)->Instance->SR &= ~(__F__))
+#define __HAL_TIM_CLEAR_IT(__HANDLE__, __I__)        ((__HANDLE__)->Instance->SR &= ~(__I__))
+#define __HAL_TIM_ENABLE_IT(__HANDLE__, __I__)       ((__HANDLE__)->Instance->DIER |= (__I__))
+#define __HAL_TIM_DISABLE_IT(__HANDLE__, __I__)      ((__HANDLE__)->Instance->DIER &= ~(__I__))
+#define __HAL_TIM_ENABLE_DMA(__HANDLE__, __D__)      ((__HANDLE__)->Instance->DIER |= (__D__))
+#define __HAL_TIM_DISABLE_DMA(__HANDLE__, __D__)     ((__HANDLE__)->Instance->DIER &= ~(__D__))
+#define __HAL_TIM_GET_IT_SOURCE(__HANDLE__, __I__)   ((((__HANDLE__)->Instance->DIER & (__I__)) == (__I__)) ? SET : RESET)
+#define __HAL_TIM_IS_TIM_COUNTING_DOWN(__HANDLE__)   (((__HANDLE__)->Instance->CR1 & TIM_CR1_DIR) == TIM_CR1_DIR)
+#define __HAL_TIM_ENABLE(__HANDLE__)                 ((__HANDLE__)->Instance->CR1 |= TIM_CR1_CEN)
+#define __HAL_TIM_DISABLE(__HANDLE__)                ((__HANDLE__)->Instance->CR1 &= ~TIM_CR1_CEN)
+
+HAL_StatusTypeDef HAL_TIM_Base_Init(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_Base_DeInit(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_Base_Stop_IT(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_ConfigClockSource(TIM_HandleTypeDef *htim, TIM_ClockConfigTypeDef *sClockSourceConfig);
+HAL_StatusTypeDef HAL_TIMEx_MasterConfigSynchronization(TIM_HandleTypeDef *htim, TIM_MasterConfigTypeDef *sMasterConfig);
+HAL_StatusTypeDef HAL_TIM_IC_Init(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_IC_ConfigChannel(TIM_HandleTypeDef *htim, TIM_IC_InitTypeDef *sConfig, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_IC_Start_IT(TIM_HandleTypeDef *htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_IC_Stop_IT(TIM_HandleTypeDef *htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_OC_ConfigChannel(TIM_HandleTypeDef *htim, TIM_OC_InitTypeDef *sConfig, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_Encoder_Init(TIM_HandleTypeDef *htim, TIM_Encoder_InitTypeDef *sConfig);
+HAL_StatusTypeDef HAL_TIM_Encoder_Start(TIM_HandleTypeDef *htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_Encoder_Stop(TIM_HandleTypeDef *htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_Encoder_DeInit(TIM_HandleTypeDef *htim);
+uint32_t          HAL_TIM_ReadCapturedValue(TIM_HandleTypeDef *htim, uint32_t Channel);
+void              HAL_TIM_IRQHandler(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_IC_Start_DMA(TIM_HandleTypeDef *htim, uint32_t Channel, uint32_t *pData, uint16_t Length);
+HAL_StatusTypeDef HAL_TIM_IC_Stop_DMA(TIM_HandleTypeDef *htim, uint32_t Channel);
+void              HAL_TIM_IC_CaptureCallback(TIM_HandleTypeDef *htim);
+void              HAL_TIM_IC_CaptureHalfCpltCallback(TIM_HandleTypeDef *htim);
+void              HAL_TIM_OC_DelayElapsedCallback(TIM_HandleTypeDef *htim);
+void              HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim);
+
+/* ================================== DMA =================================== */
+
+typedef struct {
+    __IO uint32_t CCR;
+    __IO uint32_t CNDTR;
+    __IO uint32_t CPAR;
+    __IO uint32_t CMAR;
+} DMA_Channel_TypeDef;
+
+#define DMA_PERIPH_TO_MEMORY    0x00000000U
+#define DMA_MEMORY_TO_PERIPH    (0x1UL << 4U)
+#define DMA_NORMAL              0x00000000U
+#define DMA_CIRCULAR            (0x1UL << 5U)
+#define DMA_PINC_DISABLE        0x00000000U
+#define DMA_MINC_ENABLE         (0x1UL << 7U)
+#define DMA_PDATAALIGN_BYTE     0x00000000U
+#define DMA_PDATAALIGN_HALFWORD (0x1UL << 8U)
+#define DMA_MDATAALIGN_BYTE     0x00000000U
+#define DMA_MDATAALIGN_HALFWORD (0x1UL << 10U)
+#define DMA_PRIORITY_LOW        0x00000000U
+#define DMA_PRIORITY_HIGH       (0x2UL << 12U)
+
+typedef struct {
+    uint32_t Direction;
+    uint32_t PeriphInc;
+    uint32_t MemInc;
+    uint32_t PeriphDataAlignment;
+    uint32_t MemDataAlignment;
+    uint32_t Mode;
+    uint32_t Priority;
+} DMA_InitTypeDef;
+
+typedef struct {
+    __IO uint32_t ISR;
+    __IO uint32_t IFCR;
+} DMA_TypeDef;
+
+#define DMA_FLAG_GL1            0x00000001U
+#define DMA_FLAG_TC1            0x00000002U
+#define DMA_FLAG_HT1            0x00000004U
+#define DMA_FLAG_TE1            0x00000008U
+#define DMA_IT_TC               (0x1UL << 1U)
+#define DMA_IT_HT               (0x1UL << 2U)
+#define DMA_IT_TE               (0x1UL << 3U)
+
+typedef struct __DMA_HandleTypeDef {
+    DMA_Channel_TypeDef *Instance;
+    DMA_InitTypeDef     Init;
+    void                *Parent;
+    void                *MemBaseAddress;   /* host only: buffer the sim writes into */
+    uint16_t            XferSize;          /* host only: CNDTR reload value */
+    void (*XferCpltCallback)(struct __DMA_HandleTypeDef *hdma);
+    void (*XferHalfCpltCallback)(struct __DMA_HandleTypeDef *hdma);
+} DMA_HandleTypeDef;
+
+extern DMA_TypeDef hal_sim_dma1;
+extern DMA_Channel_TypeDef hal_sim_dma1_channel[7];
+#define DMA1           (&hal_sim_dma1)
+#define DMA1_Channel1  (&hal_sim_dma1_channel[0])
+#define DMA1_Channel2  (&hal_sim_dma1_channel[1])
+#define DMA1_Channel3  (&hal_sim_dma1_channel[2])
+#define DMA1_Channel4  (&hal_sim_dma1_channel[3])
+#define DMA1_Channel5  (&hal_sim_dma1_channel[4])
+#define DMA1_Channel6  (&hal_sim_dma1_channel[5])
+#define DMA1_Channel7  (&hal_sim_dma1_channel[6])
+
+#define __HAL_DMA_GET_COUNTER(__HANDLE__)  ((__HANDLE__)->Instance->CNDTR)
+#define __HAL_LINKDMA(__HANDLE__, __PPP_DMA_FIELD__, __DMA_HANDLE__) \
+    do { (__HANDLE__)->__PPP_DMA_FIELD__ = &(__DMA_HANDLE__); (__DMA_HANDLE__).Parent = (__HANDLE__); } while (0)
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma);
+void              HAL_DMA_IRQHandler(DMA_HandleTypeDef *hdma);
+#define __HAL_RCC_DMA1_CLK_ENABLE()        do { } while (0)
+
+/* ================================== GPIO ================================== */
+
+typedef struct {
+    __IO uint32_t IDR;
+    __IO uint32_t ODR;
+} GPIO_TypeDef;
+
+typedef enum {
+    GPIO_PIN_RESET = 0U,
+    GPIO_PIN_SET
+} GPIO_PinState;
+
+#define GPIO_PIN_0   ((uint16_t)0x0001)
+#define GPIO_PIN_1   ((uint16_t)0x0002)
+#define GPIO_PIN_2   ((uint16_t)0x0004)
+#define GPIO_PIN_3   ((uint16_t)0x0008)
+#define GPIO_PIN_4   ((uint16_t)0x0010)
+#define GPIO_PIN_5   ((uint16_t)0x0020)
+#define GPIO_PIN_6   ((uint16_t)0x0040)
+#define GPIO_PIN_7   ((uint16_t)0x0080)
+#define GPIO_PIN_8   ((uint16_t)0x0100)
+#define GPIO_PIN_9   ((uint16_t)0x0200)
+#define GPIO_PIN_10  ((uint16_t)0x0400)
+#define GPIO_PIN_11  ((uint16_t)0x0800)
+#define GPIO_PIN_12  ((uint16_t)0x1000)
+#define GPIO_PIN_13  ((uint16_t)0x2000)
+#define GPIO_PIN_14  ((uint16_t)0x4000)
+#define GPIO_PIN_15  ((uint16_t)0x8000)
+
+extern GPIO_TypeDef hal_sim_gpioa;
+extern GPIO_TypeDef hal_sim_gpiob;
+#define GPIOA  (&hal_sim_gpioa)
+#define GPIOB  (&hal_sim_gpiob)
+
+void          HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+
+/* ================================== UART ================================== */
+
+typedef struct {
+    __IO uint32_t SR;
+    __IO uint32_t DR;
+    __IO uint32_t BRR;
+    __IO uint32_t CR1;
+    __IO uint32_t CR2;
+    __IO uint32_t CR3;
+    __IO uint32_t GTPR;
+} USART_TypeDef;
+
+#define UART_WORDLENGTH_8B      0x00000000U
+#define UART_WORDLENGTH_9B      (0x1UL << 12U)
+#define UART_STOPBITS_1         0x00000000U
+#define UART_STOPBITS_2         (0x2UL << 12U)
+#define UART_PARITY_NONE        0x00000000U
+#define UART_PARITY_EVEN        (0x1UL << 10U)
+#define UART_PARITY_ODD         ((0x1UL << 10U) | (0x1UL << 9U))
+#define UART_HWCONTROL_NONE     0x00000000U
+#define UART_HWCONTROL_RTS      (0x1UL << 8U)
+#define UART_HWCONTROL_CTS      (0x1UL << 9U)
+#define UART_HWCONTROL_RTS_CTS  ((0x1UL << 8U) | (0x1UL << 9U))
+#define UART_MODE_RX            (0x1UL << 2U)
+#define UART_MODE_TX            (0x1UL << 3U)
+#define UART_MODE_TX_RX         ((0x1UL << 2U) | (0x1UL << 3U))
+#define UART_OVERSAMPLING_16    0x00000000U
+
+#define UART_FLAG_RXNE          (0x1UL << 5U)
+#define UART_FLAG_IDLE          (0x1UL << 4U)
+#define UART_FLAG_ORE           (0x1UL << 3U)
+#define UART_IT_IDLE            (0x1UL << 4U)
+
+typedef struct {
+    uint32_t BaudRate;
+    uint32_t WordLength;
+    uint32_t StopBits;
+    uint32_t Parity;
+    uint32_t Mode;
+    uint32_t HwFlowCtl;
+    uint32_t OverSampling;
+} UART_InitTypeDef;
+
+typedef struct {
+    USART_TypeDef      *Instance;
+    UART_InitTypeDef   Init;
+    uint8_t            *pRxBuffPtr;
+    uint16_t           RxXferSize;
+    DMA_HandleTypeDef  *hdmatx;
+    DMA_HandleTypeDef  *hdmarx;
+} UART_HandleTypeDef;
+
+extern USART_TypeDef hal_sim_usart1;
+extern USART_TypeDef hal_sim_usart3;
+#define USART1  (&hal_sim_usart1)
+#define USART3  (&hal_sim_usart3)
+
+#define __HAL_UART_GET_FLAG(__HANDLE__, __F__)   (((__HANDLE__)->Instance->SR & (__F__)) == (__F__))
+#define __HAL_UART_ENABLE_IT(__HANDLE__, __I__)  ((__HANDLE__)->Instance->CR1 |= (__I__))
+#define __HAL_UART_DISABLE_IT(__HANDLE__, __I__) ((__HANDLE__)->Instance->CR1 &= ~(__I__))
+#define __HAL_UART_CLEAR_IDLEFLAG(__HANDLE__)    ((__HANDLE__)->Instance->SR &= ~UART_FLAG_IDLE)
+#define __HAL_UART_CLEAR_OREFLAG(__HANDLE__)     ((__HANDLE__)->Instance->SR &= ~UART_FLAG_ORE)
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart);
+HAL_StatusTypeDef HAL_UART_DeInit(UART_HandleTypeDef *huart);
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_UART_Receive(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_Receive_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_DMAStop(UART_HandleTypeDef *huart);
+
+/* ================================= FLASH ================================== */
+
+#define FLASH_BASE              0x08000000UL
+#define FLASH_BANK1_END         0x0801FFFFUL
+#define FLASH_PAGE_SIZE         0x400U
+#define FLASH_TYPEERASE_PAGES   0x00U
+#define FLASH_TYPEPROGRAM_HALFWORD  0x01U
+#define FLASH_TYPEPROGRAM_WORD      0x02U
+
+typedef struct {
+    uint32_t TypeErase;
+    uint32_t Banks;
+    uint32_t PageAddress;
+    uint32_t NbPages;
+} FLASH_EraseInitTypeDef;
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void);
+HAL_StatusTypeDef HAL_FLASH_Lock(void);
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data);
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *PageError);
+
+/* ============================ System / NVIC =============================== */
+
+void     HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority);
+void     HAL_NVIC_EnableIRQ(IRQn_Type IRQn);
+void     HAL_NVIC_DisableIRQ(IRQn_Type IRQn);
+void     HAL_NVIC_SystemReset(void);
+
+void     HAL_IncTick(void);
+uint32_t HAL_GetTick(void);
+void     HAL_Delay(uint32_t Delay);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STM32F1xx_HAL_H */
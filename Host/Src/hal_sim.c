@@ -0,0 +1,781 @@
+/**
+ ******************************************************************************
+ * @file    hal_sim.c
+ * @brief   Simulated STM32F1 peripherals for the host build
+ * @date    October 2026
+ ******************************************************************************
+ * @attention
+ *
+ * Only the behaviour the myLib modules depend on is modelled:
+ *  - TIM: CNT/ARR wrap with UIF, CCRx latch with CCxIF/CCxOF, DIER gating and
+ *    the HAL_TIM_IRQHandler dispatch order (CC1..CC4 before UPDATE). With
+ *    CCxDE set a capture is moved by the linked DMA channel instead. PSC is
+ *    preloaded: a new value only divides the clock after the next update.
+ *    ICxPSC in CCMRx drops all but every 2nd/4th/8th edge of a channel.
+ *    Channels set up by HAL_TIM_OC_ConfigChannel raise CCxIF when
+ *    HAL_Sim_TIM_Advance() steps CNT onto CCRx; the external clock sources
+ *    only load SMCR, counted pulses are HAL_Sim_TIM_Advance() ticks.
+ *  - DMA: CNDTR countdown, circular reload and HT/TC flags serviced through
+ *    HAL_DMA_IRQHandler.
+ *  - UART: blocking and DMA transmit are captured for inspection, circular
+ *    DMA receive decrements CNDTR like the DMA1 channel does.
+ *  - DWT: CYCCNT runs at SystemCoreClock with the simulated time once
+ *    TRCENA and CYCCNTENA are set.
+ *  - FLASH: a 128 KB image mapped at FLASH_BASE so the absolute addresses in
+ *    myFlash.h and the direct reads in nonVolatileStorage.c work unmodified.
+ *    Erase sets 0xFF, program only succeeds on erased half-words.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "hal_sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+/* Private define ------------------------------------------------------------*/
+#define HAL_SIM_FLASH_SIZE      (FLASH_BANK1_END - FLASH_BASE + 1UL)
+#define HAL_SIM_NVIC_LINES      64U
+#define HAL_SIM_DMA_CCR_EN      (0x1UL << 0U)
+
+/* Private variables ---------------------------------------------------------*/
+volatile uint32_t hal_sim_primask = 0U;
+volatile uint32_t hal_sim_irq_disable_count = 0U;
+
+TIM_TypeDef hal_sim_tim1;
+TIM_TypeDef hal_sim_tim2;
+TIM_TypeDef hal_sim_tim3;
+TIM_TypeDef hal_sim_tim4;
+DMA_TypeDef hal_sim_dma1;
+DMA_Channel_TypeDef hal_sim_dma1_channel[7];
+GPIO_TypeDef hal_sim_gpioa;
+GPIO_TypeDef hal_sim_gpiob;
+USART_TypeDef hal_sim_usart1;
+USART_TypeDef hal_sim_usart3;
+DWT_Type hal_sim_dwt;
+CoreDebug_Type hal_sim_coredebug;
+uint32_t SystemCoreClock = 72000000U;
+
+static volatile uint32_t sim_tick = 0U;
+static uint32_t sim_tick_us = 0U;   // Microseconds into the current tick
+static uint8_t *sim_flash = NULL;
+static bool sim_flash_locked = true;
+static bool sim_nvic_enabled[HAL_SIM_NVIC_LINES];
+static HAL_Sim_UartTx_t sim_last_tx;
+
+/* Prescaler shadow register and prescaler counter per timer */
+static struct {
+    uint32_t psc_shadow;
+    uint32_t psc_count;
+} sim_tim_psc[4];
+
+/* Input prescaler event counter per timer channel */
+static uint32_t sim_tim_ic_events[4][4];
+
+/* Output compare channels per timer, bit per channel */
+static uint32_t sim_tim_oc[4];
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief Map the flash image at its on-chip address before main() runs
+ */
+__attribute__((constructor))
+static void HAL_Sim_MapFlash(void) {
+    void *hint = (void *)(uintptr_t)FLASH_BASE;
+    void *p = mmap(hint, HAL_SIM_FLASH_SIZE, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p != hint) {
+        fprintf(stderr, "hal_sim: cannot map flash image at 0x%08lX\n", (unsigned long)FLASH_BASE);
+        abort();
+    }
+    sim_flash = (uint8_t *)p;
+    memset(sim_flash, 0xFF, HAL_SIM_FLASH_SIZE);
+}
+
+static volatile uint32_t *HAL_Sim_CCR(TIM_TypeDef *tim, uint32_t channel) {
+    switch (channel) {
+        case TIM_CHANNEL_1: return &tim->CCR1;
+        case TIM_CHANNEL_2: return &tim->CCR2;
+        case TIM_CHANNEL_3: return &tim->CCR3;
+        default:            return &tim->CCR4;
+    }
+}
+
+static uint32_t HAL_Sim_TimIndex(const TIM_TypeDef *tim) {
+    if (tim == TIM1) return 0U;
+    if (tim == TIM2) return 1U;
+    if (tim == TIM3) return 2U;
+    return 3U;
+}
+
+static uint32_t HAL_Sim_ChannelIndex(uint32_t channel) {
+    return (channel >> 2U) & 0x3U;
+}
+
+static uint32_t HAL_Sim_DmaShift(const DMA_HandleTypeDef *hdma) {
+    return (uint32_t)(hdma->Instance - hal_sim_dma1_channel) * 4U;
+}
+
+/**
+ * @brief One peripheral-to-memory DMA beat: store, count down, raise HT/TC
+ */
+static void HAL_Sim_DmaTransfer(DMA_HandleTypeDef *hdma, uint32_t value) {
+    DMA_Channel_TypeDef *ch = hdma->Instance;
+    uint32_t index = hdma->XferSize - ch->CNDTR;
+    if (hdma->Init.MemDataAlignment == DMA_MDATAALIGN_HALFWORD) {
+        ((uint16_t *)hdma->MemBaseAddress)[index] = (uint16_t)value;
+    } else {
+        ((uint8_t *)hdma->MemBaseAddress)[index] = (uint8_t)value;
+    }
+    ch->CNDTR--;
+
+    uint32_t shift = HAL_Sim_DmaShift(hdma);
+    if (ch->CNDTR == hdma->XferSize / 2U) {
+        DMA1->ISR |= (DMA_FLAG_HT1 | DMA_FLAG_GL1) << shift;
+    }
+    if (ch->CNDTR == 0U) {
+        DMA1->ISR |= (DMA_FLAG_TC1 | DMA_FLAG_GL1) << shift;
+        if (hdma->Init.Mode == DMA_CIRCULAR) {
+            ch->CNDTR = hdma->XferSize;
+        } else {
+            ch->CCR &= ~HAL_SIM_DMA_CCR_EN;
+        }
+    }
+}
+
+static void HAL_Sim_TIM_DMACaptureCplt(DMA_HandleTypeDef *hdma) {
+    TIM_HandleTypeDef *htim = (TIM_HandleTypeDef *)hdma->Parent;
+    for (uint32_t idx = 0; idx < 4U; idx++) {
+        if (htim->hdma[TIM_DMA_ID_CC1 + idx] == hdma) {
+            htim->Channel = (HAL_TIM_ActiveChannel)(HAL_TIM_ACTIVE_CHANNEL_1 << idx);
+        }
+    }
+    HAL_TIM_IC_CaptureCallback(htim);
+    htim->Channel = HAL_TIM_ACTIVE_CHANNEL_CLEARED;
+}
+
+static void HAL_Sim_TIM_DMACaptureHalfCplt(DMA_HandleTypeDef *hdma) {
+    TIM_HandleTypeDef *htim = (TIM_HandleTypeDef *)hdma->Parent;
+    for (uint32_t idx = 0; idx < 4U; idx++) {
+        if (htim->hdma[TIM_DMA_ID_CC1 + idx] == hdma) {
+            htim->Channel = (HAL_TIM_ActiveChannel)(HAL_TIM_ACTIVE_CHANNEL_1 << idx);
+        }
+    }
+    HAL_TIM_IC_CaptureHalfCpltCallback(htim);
+    htim->Channel = HAL_TIM_ACTIVE_CHANNEL_CLEARED;
+}
+
+/**
+ * @brief Run the cycle counter for a time span
+ */
+static void HAL_Sim_CountCycles(uint64_t us) {
+    if ((hal_sim_coredebug.DEMCR & CoreDebug_DEMCR_TRCENA_Msk) &&
+        (hal_sim_dwt.CTRL & DWT_CTRL_CYCCNTENA_Msk)) {
+        hal_sim_dwt.CYCCNT += (uint32_t)(us * (SystemCoreClock / 1000000U));
+    }
+}
+
+static bool HAL_Sim_FlashInRange(uint32_t address, uint32_t size) {
+    return address >= FLASH_BASE && (uint64_t)address + size <= (uint64_t)FLASH_BANK1_END + 1U;
+}
+
+/* Simulation controls -------------------------------------------------------*/
+
+void HAL_Sim_Reset(void) {
+    TIM_TypeDef *tims[] = { TIM1, TIM2, TIM3, TIM4 };
+    for (size_t i = 0; i < sizeof(tims) / sizeof(tims[0]); i++) {
+        memset((void *)tims[i], 0, sizeof(TIM_TypeDef));
+        tims[i]->ARR = 0xFFFFU;
+    }
+    memset(sim_tim_psc, 0, sizeof(sim_tim_psc));
+    memset(sim_tim_ic_events, 0, sizeof(sim_tim_ic_events));
+    memset(sim_tim_oc, 0, sizeof(sim_tim_oc));
+    memset((void *)&hal_sim_dma1, 0, sizeof(hal_sim_dma1));
+    memset((void *)hal_sim_dma1_channel, 0, sizeof(hal_sim_dma1_channel));
+    memset((void *)&hal_sim_gpioa, 0, sizeof(hal_sim_gpioa));
+    memset((void *)&hal_sim_gpiob, 0, sizeof(hal_sim_gpiob));
+    memset((void *)&hal_sim_usart1, 0, sizeof(hal_sim_usart1));
+    memset((void *)&hal_sim_usart3, 0, sizeof(hal_sim_usart3));
+    memset(sim_nvic_enabled, 0, sizeof(sim_nvic_enabled));
+    memset(&sim_last_tx, 0, sizeof(sim_last_tx));
+    memset((void *)&hal_sim_dwt, 0, sizeof(hal_sim_dwt));
+    memset((void *)&hal_sim_coredebug, 0, sizeof(hal_sim_coredebug));
+    memset(sim_flash, 0xFF, HAL_SIM_FLASH_SIZE);
+    sim_flash_locked = true;
+    sim_tick = 0U;
+    sim_tick_us = 0U;
+    hal_sim_primask = 0U;
+    hal_sim_irq_disable_count = 0U;
+}
+
+void HAL_Sim_SetTick(uint32_t tick) {
+    sim_tick = tick;
+}
+
+void HAL_Sim_AdvanceTick(uint32_t ms) {
+    HAL_Sim_CountCycles((uint64_t)ms * 1000U);
+    sim_tick += ms;
+}
+
+void HAL_Sim_AdvanceMicros(uint32_t us) {
+    HAL_Sim_CountCycles(us);
+    sim_tick_us += us;
+    sim_tick += sim_tick_us / 1000U;
+    sim_tick_us %= 1000U;
+}
+
+uint32_t HAL_Sim_TIM_Advance(TIM_HandleTypeDef *htim, uint32_t ticks) {
+    TIM_TypeDef *tim = htim->Instance;
+    if ((tim->CR1 & TIM_CR1_CEN) == 0U) {
+        return 0U;
+    }
+    uint64_t modulus = (uint64_t)tim->ARR + 1U;
+    uint64_t cnt = (uint64_t)tim->CNT + ticks;
+    uint32_t wraps = (uint32_t)(cnt / modulus);
+    uint32_t oc = sim_tim_oc[HAL_Sim_TimIndex(tim)];
+    for (uint32_t idx = 0; idx < 4U && ticks > 0U; idx++) {
+        /* Compare match: CNT passes through CCRx on one of the steps */
+        uint64_t ccr = *HAL_Sim_CCR(tim, idx << 2U) % modulus;
+        if ((oc & (1UL << idx)) && (ccr + modulus - tim->CNT - 1U) % modulus < ticks) {
+            tim->SR |= TIM_SR_CC1IF << idx;
+        }
+    }
+    tim->CNT = (uint32_t)(cnt % modulus);
+    tim->CR1 &= ~TIM_CR1_DIR;
+    if (wraps > 0U) {
+        tim->SR |= TIM_SR_UIF;
+        sim_tim_psc[HAL_Sim_TimIndex(tim)].psc_shadow = tim->PSC;
+    }
+    return wraps;
+}
+
+uint32_t HAL_Sim_TIM_Retreat(TIM_HandleTypeDef *htim, uint32_t ticks) {
+    TIM_TypeDef *tim = htim->Instance;
+    if ((tim->CR1 & TIM_CR1_CEN) == 0U) {
+        return 0U;
+    }
+    uint64_t modulus = (uint64_t)tim->ARR + 1U;
+    uint32_t wraps = 0U;
+    if (ticks > tim->CNT) {
+        wraps = (uint32_t)((ticks - tim->CNT - 1U) / modulus + 1U);
+    }
+    tim->CNT = (uint32_t)(((uint64_t)tim->CNT + modulus * wraps - ticks) % modulus);
+    tim->CR1 |= TIM_CR1_DIR;
+    if (wraps > 0U) {
+        tim->SR |= TIM_SR_UIF;
+    }
+    return wraps;
+}
+
+uint32_t HAL_Sim_TIM_AdvanceClocks(TIM_HandleTypeDef *htim, uint32_t clocks) {
+    TIM_TypeDef *tim = htim->Instance;
+    if ((tim->CR1 & TIM_CR1_CEN) == 0U) {
+        return 0U;
+    }
+    uint32_t idx = HAL_Sim_TimIndex(tim);
+    uint32_t wraps = 0U;
+    uint64_t left = clocks;
+    while (left > 0U) {
+        uint64_t div = (uint64_t)sim_tim_psc[idx].psc_shadow + 1U;
+        uint64_t to_wrap = ((uint64_t)tim->ARR + 1U - tim->CNT) * div - sim_tim_psc[idx].psc_count;
+        if (left < to_wrap) {
+            uint64_t total = sim_tim_psc[idx].psc_count + left;
+            tim->CNT += (uint32_t)(total / div);
+            sim_tim_psc[idx].psc_count = (uint32_t)(total % div);
+            break;
+        }
+        /* Update event: the preloaded PSC takes over from here */
+        left -= to_wrap;
+        tim->CNT = 0U;
+        tim->SR |= TIM_SR_UIF;
+        sim_tim_psc[idx].psc_shadow = tim->PSC;
+        sim_tim_psc[idx].psc_count = 0U;
+        wraps++;
+    }
+    return wraps;
+}
+
+void HAL_Sim_TIM_CaptureValue(TIM_HandleTypeDef *htim, uint32_t channel, uint16_t value) {
+    TIM_TypeDef *tim = htim->Instance;
+    uint32_t idx = HAL_Sim_ChannelIndex(channel);
+    uint32_t ccif = TIM_SR_CC1IF << idx;
+    DMA_HandleTypeDef *hdma = htim->hdma[TIM_DMA_ID_CC1 + idx];
+    uint32_t ccmr = (idx < 2U) ? tim->CCMR1 : tim->CCMR2;
+    uint32_t icpsc = (ccmr >> (((idx & 1U) ? 8U : 0U) + 2U)) & 0x3U;
+    uint32_t *events = &sim_tim_ic_events[HAL_Sim_TimIndex(tim)][idx];
+    if (++(*events) < (1UL << icpsc)) {
+        return;
+    }
+    *events = 0U;
+    if ((tim->DIER & (TIM_DIER_CC1DE << idx)) && hdma && (hdma->Instance->CCR & HAL_SIM_DMA_CCR_EN)) {
+        /* The DMA read of CCRx clears CCxIF straight away */
+        *HAL_Sim_CCR(tim, channel) = value;
+        HAL_Sim_DmaTransfer(hdma, value);
+        return;
+    }
+    if (tim->SR & ccif) {
+        tim->SR |= TIM_SR_CC1OF << idx;
+    }
+    *HAL_Sim_CCR(tim, channel) = value;
+    tim->SR |= ccif;
+}
+
+void HAL_Sim_TIM_Capture(TIM_HandleTypeDef *htim, uint32_t channel) {
+    HAL_Sim_TIM_CaptureValue(htim, channel, (uint16_t)htim->Instance->CNT);
+}
+
+bool HAL_Sim_TIM_IRQ(TIM_HandleTypeDef *htim) {
+    TIM_TypeDef *tim = htim->Instance;
+    uint32_t pending = tim->SR & tim->DIER & (TIM_SR_UIF | TIM_SR_CC1IF | TIM_SR_CC2IF |
+                                              TIM_SR_CC3IF | TIM_SR_CC4IF);
+    if (pending == 0U || hal_sim_primask) {
+        return false;
+    }
+    HAL_TIM_IRQHandler(htim);
+    return true;
+}
+
+bool HAL_Sim_DMA_IRQ(DMA_HandleTypeDef *hdma) {
+    uint32_t shift = HAL_Sim_DmaShift(hdma);
+    uint32_t pending = (DMA1->ISR >> shift) & hdma->Instance->CCR & (DMA_IT_TC | DMA_IT_HT | DMA_IT_TE);
+    if (pending == 0U || hal_sim_primask) {
+        return false;
+    }
+    HAL_DMA_IRQHandler(hdma);
+    return true;
+}
+
+void HAL_Sim_UART_Receive(UART_HandleTypeDef *huart, const uint8_t *data, uint16_t len) {
+    if (!huart || !huart->hdmarx || !huart->pRxBuffPtr || huart->RxXferSize == 0U) {
+        return;
+    }
+    DMA_Channel_TypeDef *ch = huart->hdmarx->Instance;
+    for (uint16_t i = 0; i < len; i++) {
+        if (ch->CNDTR == 0U) {
+            if ((huart->hdmarx->Init.Mode & DMA_CIRCULAR) == 0U) {
+                break;
+            }
+            ch->CNDTR = huart->RxXferSize;
+        }
+        huart->pRxBuffPtr[huart->RxXferSize - ch->CNDTR] = data[i];
+        ch->CNDTR--;
+    }
+    huart->Instance->SR |= UART_FLAG_IDLE;
+}
+
+const HAL_Sim_UartTx_t *HAL_Sim_UART_LastTx(void) {
+    return &sim_last_tx;
+}
+
+/* TIM -----------------------------------------------------------------------*/
+
+HAL_StatusTypeDef HAL_TIM_Base_Init(TIM_HandleTypeDef *htim) {
+    if (!htim || !htim->Instance) {
+        return HAL_ERROR;
+    }
+    htim->Instance->PSC = htim->Init.Prescaler;
+    htim->Instance->ARR = htim->Init.Period;
+    /* HAL generates UG here, which loads the prescaler shadow */
+    sim_tim_psc[HAL_Sim_TimIndex(htim->Instance)].psc_shadow = htim->Init.Prescaler;
+    sim_tim_psc[HAL_Sim_TimIndex(htim->Instance)].psc_count = 0U;
+    htim->Instance->CR1 = (htim->Instance->CR1 & ~TIM_CR1_ARPE) | htim->Init.AutoReloadPreload;
+    htim->State = HAL_TIM_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_DeInit(TIM_HandleTypeDef *htim) {
+    if (!htim || !htim->Instance) {
+        return HAL_ERROR;
+    }
+    __HAL_TIM_DISABLE(htim);
+    htim->State = HAL_TIM_STATE_RESET;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef *htim) {
+    __HAL_TIM_ENABLE_IT(htim, TIM_IT_UPDATE);
+    __HAL_TIM_ENABLE(htim);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Stop_IT(TIM_HandleTypeDef *htim) {
+    __HAL_TIM_DISABLE_IT(htim, TIM_IT_UPDATE);
+    if ((htim->Instance->CCER & 0x1111U) == 0U) {
+        __HAL_TIM_DISABLE(htim);
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_ConfigClockSource(TIM_HandleTypeDef *htim, TIM_ClockConfigTypeDef *sClockSourceConfig) {
+    if (!htim || !sClockSourceConfig) {
+        return HAL_ERROR;
+    }
+    TIM_TypeDef *tim = htim->Instance;
+    uint32_t filter = sClockSourceConfig->ClockFilter & 0xFU;
+    tim->SMCR &= ~(TIM_SMCR_SMS | TIM_SMCR_TS | TIM_SMCR_ETF | TIM_SMCR_ETPS | TIM_SMCR_ECE | TIM_SMCR_ETP);
+    if (sClockSourceConfig->ClockSource == TIM_CLOCKSOURCE_ETRMODE2) {
+        tim->SMCR |= TIM_SMCR_ECE | (filter << 8U) | (sClockSourceConfig->ClockPolarity & TIM_SMCR_ETP) |
+                     (sClockSourceConfig->ClockPrescaler & TIM_SMCR_ETPS);
+    } else if (sClockSourceConfig->ClockSource == TIM_CLOCKSOURCE_TI1) {
+        /* External clock mode 1 on TI1FP1; CC1 disabled, filter and polarity on TI1 */
+        tim->SMCR |= TIM_CLOCKSOURCE_TI1 | TIM_SMCR_SMS;
+        tim->CCER = (tim->CCER & ~0xBUL) | (sClockSourceConfig->ClockPolarity & 0xAU);
+        tim->CCMR1 = (tim->CCMR1 & ~TIM_CCMR1_IC1F) | (filter << 4U);
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_OC_ConfigChannel(TIM_HandleTypeDef *htim, TIM_OC_InitTypeDef *sConfig, uint32_t Channel) {
+    if (!htim || !sConfig) {
+        return HAL_ERROR;
+    }
+    TIM_TypeDef *tim = htim->Instance;
+    uint32_t idx = HAL_Sim_ChannelIndex(Channel);
+    volatile uint32_t *ccmr = (idx < 2U) ? &tim->CCMR1 : &tim->CCMR2;
+    uint32_t shift = (idx & 1U) ? 8U : 0U;
+    *ccmr = (*ccmr & ~(0xFFUL << shift)) | ((sConfig->OCMode & 0x70U) << shift);
+    *HAL_Sim_CCR(tim, Channel) = sConfig->Pulse;
+    sim_tim_oc[HAL_Sim_TimIndex(tim)] |= 1UL << idx;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIMEx_MasterConfigSynchronization(TIM_HandleTypeDef *htim, TIM_MasterConfigTypeDef *sMasterConfig) {
+    (void)htim;
+    (void)sMasterConfig;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_IC_Init(TIM_HandleTypeDef *htim) {
+    return HAL_TIM_Base_Init(htim);
+}
+
+HAL_StatusTypeDef HAL_TIM_IC_ConfigChannel(TIM_HandleTypeDef *htim, TIM_IC_InitTypeDef *sConfig, uint32_t Channel) {
+    if (!htim || !sConfig) {
+        return HAL_ERROR;
+    }
+    TIM_TypeDef *tim = htim->Instance;
+    uint32_t idx = HAL_Sim_ChannelIndex(Channel);
+    sim_tim_oc[HAL_Sim_TimIndex(tim)] &= ~(1UL << idx);
+    uint32_t field = (sConfig->ICSelection & 0x3U) | (sConfig->ICPrescaler & 0xCU) |
+                     ((sConfig->ICFilter & 0xFU) << 4U);
+    volatile uint32_t *ccmr = (idx < 2U) ? &tim->CCMR1 : &tim->CCMR2;
+    uint32_t shift = (idx & 1U) ? 8U : 0U;
+    *ccmr = (*ccmr & ~(0xFFUL << shift)) | (field << shift);
+    uint32_t pol_shift = idx * 4U;
+    tim->CCER = (tim->CCER & ~(0xAUL << pol_shift)) | ((sConfig->ICPolarity & 0xAU) << pol_shift);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_IC_Start_IT(TIM_HandleTypeDef *htim, uint32_t Channel) {
+    uint32_t idx = HAL_Sim_ChannelIndex(Channel);
+    __HAL_TIM_ENABLE_IT(htim, TIM_IT_CC1 << idx);
+    htim->Instance->CCER |= TIM_CCER_CC1E << (idx * 4U);
+    __HAL_TIM_ENABLE(htim);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_IC_Stop_IT(TIM_HandleTypeDef *htim, uint32_t Channel) {
+    uint32_t idx = HAL_Sim_ChannelIndex(Channel);
+    __HAL_TIM_DISABLE_IT(htim, TIM_IT_CC1 << idx);
+    htim->Instance->CCER &= ~(TIM_CCER_CC1E << (idx * 4U));
+    if ((htim->Instance->CCER & 0x1111U) == 0U) {
+        __HAL_TIM_DISABLE(htim);
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_Encoder_Init(TIM_HandleTypeDef *htim, TIM_Encoder_InitTypeDef *sConfig) {
+    if (HAL_TIM_Base_Init(htim) != HAL_OK || !sConfig) {
+        return HAL_ERROR;
+    }
+    htim->Instance->SMCR = (htim->Instance->SMCR & ~TIM_SMCR_SMS) | sConfig->EncoderMode;
+    htim->Instance->CCMR1 = (sConfig->IC1Selection & 0x3U) | ((sConfig->IC2Selection & 0x3U) << 8U);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_Encoder_Start(TIM_HandleTypeDef *htim, uint32_t Channel) {
+    (void)Channel;
+    htim->Instance->CCER |= TIM_CCER_CC1E | (TIM_CCER_CC1E << 4U);
+    __HAL_TIM_ENABLE(htim);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_Encoder_DeInit(TIM_HandleTypeDef *htim) {
+    return HAL_TIM_Base_DeInit(htim);
+}
+
+HAL_StatusTypeDef HAL_TIM_Encoder_Stop(TIM_HandleTypeDef *htim, uint32_t Channel) {
+    (void)Channel;
+    htim->Instance->CCER &= ~(TIM_CCER_CC1E | (TIM_CCER_CC1E << 4U));
+    __HAL_TIM_DISABLE(htim);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_IC_Start_DMA(TIM_HandleTypeDef *htim, uint32_t Channel, uint32_t *pData, uint16_t Length) {
+    uint32_t idx = HAL_Sim_ChannelIndex(Channel);
+    DMA_HandleTypeDef *hdma = htim->hdma[TIM_DMA_ID_CC1 + idx];
+    if (!hdma || !hdma->Instance || !pData || Length == 0U) {
+        return HAL_ERROR;
+    }
+    hdma->XferCpltCallback = HAL_Sim_TIM_DMACaptureCplt;
+    hdma->XferHalfCpltCallback = HAL_Sim_TIM_DMACaptureHalfCplt;
+    hdma->MemBaseAddress = pData;
+    hdma->XferSize = Length;
+    hdma->Instance->CNDTR = Length;
+    hdma->Instance->CCR |= HAL_SIM_DMA_CCR_EN | DMA_IT_TC | DMA_IT_HT | DMA_IT_TE;
+    DMA1->ISR &= ~(0xFUL << HAL_Sim_DmaShift(hdma));
+
+    __HAL_TIM_ENABLE_DMA(htim, TIM_DMA_CC1 << idx);
+    htim->Instance->CCER |= TIM_CCER_CC1E << (idx * 4U);
+    __HAL_TIM_ENABLE(htim);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_IC_Stop_DMA(TIM_HandleTypeDef *htim, uint32_t Channel) {
+    uint32_t idx = HAL_Sim_ChannelIndex(Channel);
+    DMA_HandleTypeDef *hdma = htim->hdma[TIM_DMA_ID_CC1 + idx];
+    __HAL_TIM_DISABLE_DMA(htim, TIM_DMA_CC1 << idx);
+    htim->Instance->CCER &= ~(TIM_CCER_CC1E << (idx * 4U));
+    if (hdma && hdma->Instance) {
+        hdma->Instance->CCR &= ~(HAL_SIM_DMA_CCR_EN | DMA_IT_TC | DMA_IT_HT | DMA_IT_TE);
+    }
+    if ((htim->Instance->CCER & 0x1111U) == 0U) {
+        __HAL_TIM_DISABLE(htim);
+    }
+    return HAL_OK;
+}
+
+uint32_t HAL_TIM_ReadCapturedValue(TIM_HandleTypeDef *htim, uint32_t Channel) {
+    /* Reading CCRx clears CCxIF on silicon */
+    htim->Instance->SR &= ~(TIM_SR_CC1IF << HAL_Sim_ChannelIndex(Channel));
+    return *HAL_Sim_CCR(htim->Instance, Channel);
+}
+
+void HAL_TIM_IRQHandler(TIM_HandleTypeDef *htim) {
+    static const HAL_TIM_ActiveChannel active[4] = {
+        HAL_TIM_ACTIVE_CHANNEL_1, HAL_TIM_ACTIVE_CHANNEL_2,
+        HAL_TIM_ACTIVE_CHANNEL_3, HAL_TIM_ACTIVE_CHANNEL_4
+    };
+    for (uint32_t idx = 0; idx < 4U; idx++) {
+        uint32_t flag = TIM_SR_CC1IF << idx;
+        if (__HAL_TIM_GET_FLAG(htim, flag) && __HAL_TIM_GET_IT_SOURCE(htim, TIM_IT_CC1 << idx) == SET) {
+            __HAL_TIM_CLEAR_IT(htim, flag);
+            htim->Channel = active[idx];
+            if (sim_tim_oc[HAL_Sim_TimIndex(htim->Instance)] & (1UL << idx)) {
+                HAL_TIM_OC_DelayElapsedCallback(htim);
+            } else {
+                HAL_TIM_IC_CaptureCallback(htim);
+            }
+            htim->Channel = HAL_TIM_ACTIVE_CHANNEL_CLEARED;
+        }
+    }
+    if (__HAL_TIM_GET_FLAG(htim, TIM_FLAG_UPDATE) && __HAL_TIM_GET_IT_SOURCE(htim, TIM_IT_UPDATE) == SET) {
+        __HAL_TIM_CLEAR_IT(htim, TIM_IT_UPDATE);
+        HAL_TIM_PeriodElapsedCallback(htim);
+    }
+}
+
+__weak void HAL_TIM_IC_CaptureCallback(TIM_HandleTypeDef *htim) {
+    (void)htim;
+}
+
+__weak void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim) {
+    (void)htim;
+}
+
+__weak void HAL_TIM_OC_DelayElapsedCallback(TIM_HandleTypeDef *htim) {
+    (void)htim;
+}
+
+__weak void HAL_TIM_IC_CaptureHalfCpltCallback(TIM_HandleTypeDef *htim) {
+    (void)htim;
+}
+
+/* DMA -----------------------------------------------------------------------*/
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma) {
+    return (hdma && hdma->Instance) ? HAL_OK : HAL_ERROR;
+}
+
+void HAL_DMA_IRQHandler(DMA_HandleTypeDef *hdma) {
+    uint32_t shift = HAL_Sim_DmaShift(hdma);
+    uint32_t flags = DMA1->ISR >> shift;
+    uint32_t ccr = hdma->Instance->CCR;
+
+    if ((flags & DMA_FLAG_HT1) && (ccr & DMA_IT_HT)) {
+        DMA1->ISR &= ~(DMA_FLAG_HT1 << shift);
+        if (hdma->XferHalfCpltCallback) {
+            hdma->XferHalfCpltCallback(hdma);
+        }
+    } else if ((flags & DMA_FLAG_TC1) && (ccr & DMA_IT_TC)) {
+        DMA1->ISR &= ~(DMA_FLAG_TC1 << shift);
+        if (hdma->XferCpltCallback) {
+            hdma->XferCpltCallback(hdma);
+        }
+    }
+    if ((DMA1->ISR >> shift & (DMA_FLAG_HT1 | DMA_FLAG_TC1 | DMA_FLAG_TE1)) == 0U) {
+        DMA1->ISR &= ~(DMA_FLAG_GL1 << shift);
+    }
+}
+
+/* GPIO ----------------------------------------------------------------------*/
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState) {
+    if (PinState != GPIO_PIN_RESET) {
+        GPIOx->ODR |= GPIO_Pin;
+    } else {
+        GPIOx->ODR &= ~(uint32_t)GPIO_Pin;
+    }
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin) {
+    return (GPIOx->IDR & GPIO_Pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+/* UART ----------------------------------------------------------------------*/
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart) {
+    return (huart && huart->Instance) ? HAL_OK : HAL_ERROR;
+}
+
+HAL_StatusTypeDef HAL_UART_DeInit(UART_HandleTypeDef *huart) {
+    return (huart && huart->Instance) ? HAL_OK : HAL_ERROR;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size, uint32_t Timeout) {
+    (void)Timeout;
+    return HAL_UART_Transmit_DMA(huart, pData, Size);
+}
+
+HAL_StatusTypeDef HAL_UART_Receive(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size, uint32_t Timeout) {
+    (void)huart;
+    (void)pData;
+    (void)Size;
+    (void)Timeout;
+    return HAL_TIMEOUT;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size) {
+    if (!huart || !pData || Size == 0U) {
+        return HAL_ERROR;
+    }
+    uint16_t n = (Size > sizeof(sim_last_tx.data)) ? (uint16_t)sizeof(sim_last_tx.data) : Size;
+    sim_last_tx.huart = huart;
+    memcpy(sim_last_tx.data, pData, n);
+    sim_last_tx.len = n;
+    sim_last_tx.count++;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Receive_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size) {
+    if (!huart || !pData || Size == 0U) {
+        return HAL_ERROR;
+    }
+    huart->pRxBuffPtr = pData;
+    huart->RxXferSize = Size;
+    if (huart->hdmarx && huart->hdmarx->Instance) {
+        huart->hdmarx->Instance->CNDTR = Size;
+        huart->hdmarx->MemBaseAddress = pData;
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_DMAStop(UART_HandleTypeDef *huart) {
+    if (huart && huart->hdmarx && huart->hdmarx->Instance) {
+        huart->hdmarx->Instance->CNDTR = 0U;
+    }
+    return HAL_OK;
+}
+
+/* FLASH ---------------------------------------------------------------------*/
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void) {
+    sim_flash_locked = false;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Lock(void) {
+    sim_flash_locked = true;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data) {
+    uint32_t halfwords = (TypeProgram == FLASH_TYPEPROGRAM_WORD) ? 2U : 1U;
+    if (sim_flash_locked || (Address & 1U) || !HAL_Sim_FlashInRange(Address, halfwords * 2U)) {
+        return HAL_ERROR;
+    }
+    uint16_t *dst = (uint16_t *)(sim_flash + (Address - FLASH_BASE));
+    for (uint32_t i = 0; i < halfwords; i++) {
+        uint16_t hw = (uint16_t)(Data >> (16U * i));
+        if (dst[i] != 0xFFFFU && hw != 0U) {
+            return HAL_ERROR;   // PGERR: half-word not erased
+        }
+        dst[i] = hw;
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *PageError) {
+    if (sim_flash_locked || !pEraseInit) {
+        return HAL_ERROR;
+    }
+    uint32_t page = pEraseInit->PageAddress & ~(FLASH_PAGE_SIZE - 1U);
+    uint32_t size = pEraseInit->NbPages * FLASH_PAGE_SIZE;
+    if (!HAL_Sim_FlashInRange(page, size)) {
+        if (PageError) {
+            *PageError = page;
+        }
+        return HAL_ERROR;
+    }
+    memset(sim_flash + (page - FLASH_BASE), 0xFF, size);
+    if (PageError) {
+        *PageError = 0xFFFFFFFFU;
+    }
+    return HAL_OK;
+}
+
+/* System / NVIC -------------------------------------------------------------*/
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority) {
+    (void)IRQn;
+    (void)PreemptPriority;
+    (void)SubPriority;
+}
+
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn) {
+    if ((uint32_t)IRQn < HAL_SIM_NVIC_LINES) {
+        sim_nvic_enabled[IRQn] = true;
+    }
+}
+
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn) {
+    if ((uint32_t)IRQn < HAL_SIM_NVIC_LINES) {
+        sim_nvic_enabled[IRQn] = false;
+    }
+}
+
+void HAL_NVIC_SystemReset(void) {
+    fprintf(stderr, "hal_sim: HAL_NVIC_SystemReset()\n");
+    exit(0);
+}
+
+void HAL_IncTick(void) {
+    HAL_Sim_CountCycles(1000U);
+    sim_tick++;
+}
+
+uint32_t HAL_GetTick(void) {
+    return sim_tick;
+}
+
+void HAL_Delay(uint32_t Delay) {
+    HAL_Sim_AdvanceTick(Delay);
+}
+
+__weak void Error_Handler(void) {
+    fprintf(stderr, "hal_sim: Error_Handler()\n");
+    abort();
+}
@@ -0,0 +1,448 @@
+/**
+ ******************************************************************************
+ * @file    bench_main.c
+ * @brief   Host micro-benchmarks for the firmware hot paths
+ * @date    October 2026
+ ******************************************************************************
+ * @attention
+ *
+ * Every case is calibrated by doubling its iteration count until one run
+ * takes at least BENCH_MIN_NS, then reports ns/op, cycles/op and ops/s.
+ * Cycles come from the x86 time-stamp counter (constant-rate reference
+ * cycles, "-" on other hosts). Numbers are for comparing revisions on the
+ * same PC, not absolute Cortex-M3 timings.
+ *
+ * Usage: mylib_bench [filter]   (runs cases whose name contains filter)
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAS_TSC       1
+#else
+#define BENCH_HAS_TSC       0
+#endif
+#include "hal_sim.h"
+#include "myEncoder/proximity_counter.h"
+#include "modbus/crc16/crc16.h"
+#include "modbus/modbus_slave/modbus_slave.h"
+#include "queue/queue.h"
+
+/* Private define ------------------------------------------------------------*/
+#define BENCH_MIN_NS        50000000ULL   // 50 ms per measured run
+#define BENCH_MAX_ITER      (1ULL << 32)
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct {
+    const char *name;
+    void (*setup)(void);
+    void (*run)(uint64_t iterations);
+} BenchCase_t;
+
+/* Private variables ---------------------------------------------------------*/
+static volatile uint32_t bench_sink;
+
+static TIM_HandleTypeDef bench_htim2;
+static DMA_HandleTypeDef bench_hdma_tim2_ch1;
+static ProximityCounter_t bench_counter;
+static ProximityDmaRing_t bench_dma_ring;
+static ProximityCounter_t bench_channels[3];   // TIM2 CH2..CH4
+
+static UART_HandleTypeDef bench_huart3;
+static uint16_t bench_holding_regs[10];
+static modbus_slave_config_t bench_slave_cfg;
+
+static uint8_t bench_fc03_frame[8];
+static uint8_t bench_fc06_frame[8];
+static uint8_t bench_crc_buf[256];
+
+static RpmFilter_t bench_filter;
+static RpmTracker_t bench_tracker;
+static int32_t bench_rpm_samples[256];    // Q8 RPM around 1500 with noise and spikes
+
+/* Private functions ---------------------------------------------------------*/
+
+static uint64_t Bench_NowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t Bench_NowCycles(void) {
+#if BENCH_HAS_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static void Bench_AppendCrc(uint8_t *frame, uint16_t len) {
+    uint16_t crc = modbus_crc16(frame, len);
+    frame[len] = crc & 0xFF;
+    frame[len + 1] = crc >> 8;
+}
+
+/* HAL callbacks routed to the counter, same as Core/Src/main.c */
+void HAL_TIM_IC_CaptureCallback(TIM_HandleTypeDef *htim) {
+    ProximityCounter_DispatchCapture(htim);
+}
+
+void HAL_TIM_IC_CaptureHalfCpltCallback(TIM_HandleTypeDef *htim) {
+    ProximityCounter_DispatchCaptureHalf(htim);
+}
+
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim) {
+    ProximityCounter_DispatchOverflow(htim);
+}
+
+/* Proximity counter ---------------------------------------------------------*/
+
+static void Setup_ProximityMode(ProximityCaptureMode_t mode, ProximityMethod_t method) {
+    for (uint32_t c = 0; c < 3U; c++) {
+        bench_channels[c].running = 0;
+    }
+    HAL_Sim_Reset();
+    memset(&bench_htim2, 0, sizeof(bench_htim2));
+    bench_htim2.Instance = TIM2;
+    bench_htim2.Init.Prescaler = 72 - 1;
+    bench_htim2.Init.Period = 65535;
+    HAL_TIM_IC_Init(&bench_htim2);
+
+    memset(&bench_hdma_tim2_ch1, 0, sizeof(bench_hdma_tim2_ch1));
+    bench_hdma_tim2_ch1.Instance = DMA1_Channel5;
+    bench_hdma_tim2_ch1.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    bench_hdma_tim2_ch1.Init.MemInc = DMA_MINC_ENABLE;
+    bench_hdma_tim2_ch1.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+    bench_hdma_tim2_ch1.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+    bench_hdma_tim2_ch1.Init.Mode = DMA_CIRCULAR;
+    HAL_DMA_Init(&bench_hdma_tim2_ch1);
+    __HAL_LINKDMA(&bench_htim2, hdma[TIM_DMA_ID_CC1], bench_hdma_tim2_ch1);
+
+    ProximityCounterConfig_t cfg = { .ppr = 4, .diameter = 0.1f, .timeout_ms = 1000,
+                                     .averaging_samples = 4, .capture_mode = mode, .dma_ring = &bench_dma_ring,
+                                     .method = method, .gate_ms = 10 };
+    ProximityCounter_Init(&bench_counter, &cfg, &bench_htim2);
+    ProximityCounter_Start(&bench_counter);
+}
+
+static void Setup_Proximity(void) {
+    Setup_ProximityMode(PROXIMITY_CAPTURE_MODE_IT, PROXIMITY_METHOD_PERIOD);
+}
+
+static void Setup_ProximityDma(void) {
+    Setup_ProximityMode(PROXIMITY_CAPTURE_MODE_DMA, PROXIMITY_METHOD_PERIOD);
+}
+
+static void Setup_ProximityMt(void) {
+    Setup_ProximityMode(PROXIMITY_CAPTURE_MODE_IT, PROXIMITY_METHOD_MT);
+}
+
+static void Setup_ProximitySliding(void) {
+    Setup_ProximityMode(PROXIMITY_CAPTURE_MODE_IT, PROXIMITY_METHOD_PERIOD);
+    ProximityCounter_SetAveraging(&bench_counter, PROXIMITY_AVERAGING_SLIDING, 16, 0);
+}
+
+/* ISR body only: CCR1 pre-latched, callback called directly */
+static void Run_ProximityHandleCapture(uint64_t n) {
+    uint16_t ccr = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        ccr += 1250;                       // 1200 RPM at 4 PPR, 1 MHz
+        TIM2->CCR1 = ccr;
+        ProximityCounter_HandleCapture(&bench_counter, &bench_htim2);
+    }
+    bench_sink = bench_counter.period_sum;
+}
+
+/* Full path: capture flag -> HAL_TIM_IRQHandler -> callback, with overflows */
+static void Run_ProximityIrqDispatch(uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        if (HAL_Sim_TIM_Advance(&bench_htim2, 1250)) {
+            HAL_Sim_TIM_IRQ(&bench_htim2);
+        }
+        HAL_Sim_TIM_Capture(&bench_htim2, TIM_CHANNEL_1);
+        HAL_Sim_TIM_IRQ(&bench_htim2);
+    }
+    bench_sink = bench_counter.period_sum;
+}
+
+/* Per edge, interrupt mode: IRQ per edge, main loop polled every 64 edges */
+static void Run_ProximityItEdge(uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        if (HAL_Sim_TIM_Advance(&bench_htim2, 1250)) {
+            HAL_Sim_TIM_IRQ(&bench_htim2);
+        }
+        HAL_Sim_TIM_Capture(&bench_htim2, TIM_CHANNEL_1);
+        HAL_Sim_TIM_IRQ(&bench_htim2);
+        if ((i & 63U) == 63U) {
+            ProximityCounter_ProcessCapture(&bench_counter);
+        }
+    }
+    bench_sink = (uint32_t)bench_counter.rpm;
+}
+
+/* Per edge, M/T method: IRQ per edge only counts, 10 ms gate closed by the main loop */
+static void Run_ProximityMtEdge(uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        if (HAL_Sim_TIM_Advance(&bench_htim2, 1250)) {
+            HAL_Sim_TIM_IRQ(&bench_htim2);
+        }
+        HAL_Sim_TIM_Capture(&bench_htim2, TIM_CHANNEL_1);
+        HAL_Sim_TIM_IRQ(&bench_htim2);
+        if ((i & 7U) == 7U) {
+            HAL_Sim_AdvanceTick(10);
+        }
+        if ((i & 63U) == 63U) {
+            ProximityCounter_ProcessCapture(&bench_counter);
+        }
+    }
+    bench_sink = (uint32_t)bench_counter.rpm;
+}
+
+static void Setup_Proximity4Ch(void) {
+    static const uint32_t channels[3] = { TIM_CHANNEL_2, TIM_CHANNEL_3, TIM_CHANNEL_4 };
+    Setup_ProximityMode(PROXIMITY_CAPTURE_MODE_IT, PROXIMITY_METHOD_PERIOD);
+    for (uint32_t c = 0; c < 3U; c++) {
+        ProximityCounterConfig_t cfg = { .ppr = 4, .diameter = 0.1f, .timeout_ms = 1000,
+                                         .averaging_samples = 4, .channel = channels[c] };
+        ProximityCounter_Init(&bench_channels[c], &cfg, &bench_htim2);
+        ProximityCounter_Start(&bench_channels[c]);
+    }
+}
+
+/* Per edge, four channels on TIM2: edges rotate CH1..CH4 through the dispatch table */
+static void Run_Proximity4ChEdge(uint64_t n) {
+    static const uint32_t channels[4] = { TIM_CHANNEL_1, TIM_CHANNEL_2, TIM_CHANNEL_3, TIM_CHANNEL_4 };
+    for (uint64_t i = 0; i < n; i++) {
+        if (HAL_Sim_TIM_Advance(&bench_htim2, 1250)) {
+            HAL_Sim_TIM_IRQ(&bench_htim2);
+        }
+        HAL_Sim_TIM_Capture(&bench_htim2, channels[i & 3U]);
+        HAL_Sim_TIM_IRQ(&bench_htim2);
+        if ((i & 63U) == 63U) {
+            ProximityCounter_ProcessCapture(&bench_counter);
+            for (uint32_t c = 0; c < 3U; c++) {
+                ProximityCounter_ProcessCapture(&bench_channels[c]);
+            }
+        }
+    }
+    bench_sink = (uint32_t)bench_channels[2].rpm;
+}
+
+/* Per edge, DMA mode: HT/TC every 128 edges, main loop drains every 64 edges */
+static void Run_ProximityDmaEdge(uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        if (HAL_Sim_TIM_Advance(&bench_htim2, 1250)) {
+            HAL_Sim_TIM_IRQ(&bench_htim2);
+        }
+        HAL_Sim_TIM_Capture(&bench_htim2, TIM_CHANNEL_1);
+        HAL_Sim_DMA_IRQ(&bench_hdma_tim2_ch1);
+        if ((i & 63U) == 63U) {
+            ProximityCounter_ProcessCapture(&bench_counter);
+        }
+    }
+    bench_sink = (uint32_t)bench_counter.rpm;
+}
+
+/* Main-loop side: RPM conversion and hysteresis filter */
+static void Run_ProximityProcessCapture(uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        bench_counter.difference = (12000 + (uint32_t)(i & 0xFF)) * PROXIMITY_PRESCALAR;
+        bench_counter.new_capture_ready = 1;
+        ProximityCounter_ProcessCapture(&bench_counter);
+    }
+    bench_sink = (uint32_t)bench_counter.rpm;
+}
+
+/* Modbus slave --------------------------------------------------------------*/
+
+static void Setup_ModbusSlave(void) {
+    HAL_Sim_Reset();
+    memset(&bench_huart3, 0, sizeof(bench_huart3));
+    bench_huart3.Instance = USART3;
+    for (uint16_t i = 0; i < 10; i++) {
+        bench_holding_regs[i] = i * 100;
+    }
+    memset(&bench_slave_cfg, 0, sizeof(bench_slave_cfg));
+    bench_slave_cfg.id = 1;
+    bench_slave_cfg.holding_registers = bench_holding_regs;
+    bench_slave_cfg.holding_register_count = 10;
+    modbus_slave_init(&bench_huart3, &bench_slave_cfg);
+
+    const uint8_t fc03[] = { 0x01, 0x03, 0x00, 0x00, 0x00, 0x0A };
+    memcpy(bench_fc03_frame, fc03, sizeof(fc03));
+    Bench_AppendCrc(bench_fc03_frame, sizeof(fc03));
+
+    const uint8_t fc06[] = { 0x01, 0x06, 0x00, 0x05, 0x12, 0x34 };
+    memcpy(bench_fc06_frame, fc06, sizeof(fc06));
+    Bench_AppendCrc(bench_fc06_frame, sizeof(fc06));
+}
+
+static void Run_ModbusFc03(uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        modbus_slave_handle_frame(bench_fc03_frame, sizeof(bench_fc03_frame));
+    }
+    bench_sink = HAL_Sim_UART_LastTx()->len;
+}
+
+static void Run_ModbusFc06(uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        modbus_slave_handle_frame(bench_fc06_frame, sizeof(bench_fc06_frame));
+    }
+    bench_sink = HAL_Sim_UART_LastTx()->len;
+}
+
+/* RPM filter chains ---------------------------------------------------------*/
+
+static void Setup_RpmFilter(RpmFilterChain_t chain) {
+    uint32_t lcg = 12345U;
+    for (uint16_t i = 0; i < 256U; i++) {
+        lcg = lcg * 1103515245U + 12345U;
+        int32_t noise = (int32_t)((lcg >> 16) % 4096U) - 2048;   // +-8 RPM
+        int32_t spike = (i % 37U == 0U) ? (400 << RPM_FILTER_Q_SHIFT) : 0;
+        bench_rpm_samples[i] = (1500 << RPM_FILTER_Q_SHIFT) + noise + spike;
+    }
+    RpmFilter_Init(&bench_filter, chain);
+    ProximityCounter_InitDefaultHysteresis(&bench_counter);
+}
+
+static void Setup_RpmFilterHyst(void)        { Setup_RpmFilter(RPM_FILTER_CHAIN_HYSTERESIS); }
+static void Setup_RpmFilterEma(void)         { Setup_RpmFilter(RPM_FILTER_CHAIN_EMA); }
+static void Setup_RpmFilterMedian3Ema(void)  { Setup_RpmFilter(RPM_FILTER_CHAIN_MEDIAN3_EMA); }
+static void Setup_RpmFilterMedian5Hyst(void) { Setup_RpmFilter(RPM_FILTER_CHAIN_MEDIAN5_HYSTERESIS); }
+static void Setup_RpmFilterMedian3EmaSlew(void) { Setup_RpmFilter(RPM_FILTER_CHAIN_MEDIAN3_EMA_SLEW); }
+static void Setup_RpmFilterNone(void)        { Setup_RpmFilter(RPM_FILTER_CHAIN_NONE); }
+
+static void Run_RpmFilter(uint64_t n) {
+    int32_t acc = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        acc += RpmFilter_Process(&bench_filter, bench_rpm_samples[i & 255U],
+                                 bench_counter.hysteresis_table,
+                                 bench_counter.hysteresis_table_size);
+    }
+    bench_sink = (uint32_t)acc;
+}
+
+static void Setup_RpmTracker(void) {
+    Setup_RpmFilter(RPM_FILTER_CHAIN_NONE);
+    RpmTracker_Init(&bench_tracker, RPM_TRACKER_DEFAULT_ALPHA_Q8, RPM_TRACKER_DEFAULT_BETA_Q8);
+}
+
+static void Run_RpmTracker(uint64_t n) {
+    int32_t acc = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        acc += RpmTracker_Update(&bench_tracker, bench_rpm_samples[i & 255U], 40000U);  // 1500 RPM
+    }
+    bench_sink = (uint32_t)acc;
+}
+
+/* CRC16 ---------------------------------------------------------------------*/
+
+static void Setup_Crc(void) {
+    for (uint16_t i = 0; i < sizeof(bench_crc_buf); i++) {
+        bench_crc_buf[i] = (uint8_t)(i * 7 + 3);
+    }
+}
+
+static void Run_Crc8(uint64_t n) {
+    uint32_t acc = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        acc += modbus_crc16(bench_crc_buf, 8);
+    }
+    bench_sink = acc;
+}
+
+static void Run_Crc256(uint64_t n) {
+    uint32_t acc = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        acc += modbus_crc16(bench_crc_buf, 256);
+    }
+    bench_sink = acc;
+}
+
+/* Frame queue ---------------------------------------------------------------*/
+
+static void Setup_Queue(void) {
+    queue_init();
+}
+
+static void Run_QueuePushPop(uint64_t n) {
+    static queue_frame_t in = { .len = 8 };
+    static queue_frame_t out;
+    for (uint64_t i = 0; i < n; i++) {
+        in.data[0] = (uint8_t)i;
+        queue_push(&in);
+        queue_pop(&out);
+    }
+    bench_sink = out.data[0];
+}
+
+/* Case table ----------------------------------------------------------------*/
+static const BenchCase_t bench_cases[] = {
+    { "proximity_handle_capture",  Setup_Proximity,   Run_ProximityHandleCapture },
+    { "proximity_irq_dispatch",    Setup_Proximity,   Run_ProximityIrqDispatch },
+    { "proximity_process_capture", Setup_Proximity,   Run_ProximityProcessCapture },
+    { "proximity_it_edge",         Setup_Proximity,   Run_ProximityItEdge },
+    { "proximity_dma_edge",        Setup_ProximityDma, Run_ProximityDmaEdge },
+    { "proximity_mt_edge",         Setup_ProximityMt, Run_ProximityMtEdge },
+    { "proximity_sliding_edge",    Setup_ProximitySliding, Run_ProximityItEdge },
+    { "proximity_4ch_edge",        Setup_Proximity4Ch, Run_Proximity4ChEdge },
+    { "rpm_filter_hyst",           Setup_RpmFilterHyst, Run_RpmFilter },
+    { "rpm_filter_ema",            Setup_RpmFilterEma, Run_RpmFilter },
+    { "rpm_filter_median3_ema",    Setup_RpmFilterMedian3Ema, Run_RpmFilter },
+    { "rpm_filter_median5_hyst",   Setup_RpmFilterMedian5Hyst, Run_RpmFilter },
+    { "rpm_filter_median3_ema_slew", Setup_RpmFilterMedian3EmaSlew, Run_RpmFilter },
+    { "rpm_filter_none",           Setup_RpmFilterNone, Run_RpmFilter },
+    { "rpm_tracker_update",        Setup_RpmTracker, Run_RpmTracker },
+    { "modbus_slave_fc03_10regs",  Setup_ModbusSlave, Run_ModbusFc03 },
+    { "modbus_slave_fc06",         Setup_ModbusSlave, Run_ModbusFc06 },
+    { "modbus_crc16_8B",           Setup_Crc,         Run_Crc8 },
+    { "modbus_crc16_256B",         Setup_Crc,         Run_Crc256 },
+    { "queue_push_pop",            Setup_Queue,       Run_QueuePushPop },
+};
+
+static void Bench_Run(const BenchCase_t *bc) {
+    uint64_t iterations = 1;
+    uint64_t elapsed = 0;
+    uint64_t cycles = 0;
+
+    for (;;) {
+        bc->setup();
+        uint64_t start = Bench_NowNs();
+        uint64_t start_cycles = Bench_NowCycles();
+        bc->run(iterations);
+        cycles = Bench_NowCycles() - start_cycles;
+        elapsed = Bench_NowNs() - start;
+        if (elapsed >= BENCH_MIN_NS || iterations >= BENCH_MAX_ITER) {
+            break;
+        }
+        iterations *= 2;
+    }
+
+    double ns_per_op = (double)elapsed / (double)iterations;
+    if (BENCH_HAS_TSC) {
+        printf("%-28s %12llu %10.2f %10.1f %14.0f\n", bc->name, (unsigned long long)iterations,
+               ns_per_op, (double)cycles / (double)iterations, 1e9 / ns_per_op);
+    } else {
+        printf("%-28s %12llu %10.2f %10s %14.0f\n", bc->name, (unsigned long long)iterations,
+               ns_per_op, "-", 1e9 / ns_per_op);
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *filter = (argc > 1) ? argv[1] : NULL;
+
+    printf("%-28s %12s %10s %10s %14s\n", "case", "iterations", "ns/op", "cycles/op", "ops/s");
+    for (size_t i = 0; i < sizeof(bench_cases) / sizeof(bench_cases[0]); i++) {
+        if (filter && !strstr(bench_cases[i].name, filter)) {
+            continue;
+        }
+        Bench_Run(&bench_cases[i]);
+    }
+    return 0;
+}
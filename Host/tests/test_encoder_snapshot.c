@@ -0,0 +1,260 @@
+/**
+ ******************************************************************************
+ * @file    test_encoder_snapshot.c
+ * @brief   Overflow-vs-read interleavings for the quadrature encoder position
+ * @date    October 2026
+ ******************************************************************************
+ * @attention
+ *
+ * A POSIX interval timer plays the encoder and its update interrupt: each
+ * signal moves the counter forwards or backwards, across the wrap point on
+ * most steps, and services UIF either at once or on the next signal. The
+ * signal preempts Encoder_GetPulse() at arbitrary instructions, the way
+ * TIMx_IRQHandler preempts the main loop. Every position read must equal the
+ * true count at some instant during the read; a torn total_pulse or a wrap
+ * between the flag and CNT reads shows up as a jump of 65536. Fixed cases
+ * reverse the shaft right at the wrap, where DIR alone gets the wrap wrong.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+#include "hal_sim.h"
+#include "myEncoder/myEncoder.h"
+
+/* Private define ------------------------------------------------------------*/
+#define TEST_INTERRUPTS  20000U   // Simulated update events per run
+#define TEST_MAX_STEP    30000U   // Counts per event, below half a wrap
+#define TEST_FLIP_EVERY  64U      // Events between direction changes
+#define TEST_LOG_SIZE    1024U    // Positions kept to check a read against
+
+/* Private macro -------------------------------------------------------------*/
+#define CHECK(cond, ...)                                                   \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__);                    \
+            printf(__VA_ARGS__);                                           \
+            printf("\n");                                                  \
+            test_failures++;                                               \
+        }                                                                  \
+    } while (0)
+
+/* Private variables ---------------------------------------------------------*/
+static int test_failures;
+static TIM_HandleTypeDef test_htim;
+static Encoder_t test_encoder;
+
+// Written by the signal handler only
+static volatile uint32_t test_events;
+static volatile int64_t test_truth;
+static volatile int64_t test_log[TEST_LOG_SIZE];   // Position after event n at [n % size]
+static volatile uint32_t test_overflows;
+static uint32_t test_rand = 12345U;
+
+/* HAL callbacks -------------------------------------------------------------*/
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim) {
+    if (htim == test_encoder.htim) {
+        Encoder_HandleOverflow(&test_encoder);
+        test_overflows++;
+    }
+}
+
+SpeedDisplayUnit_t CommandHandler_GetSpeedDisplayUnit(void) {
+    return SPEED_UNIT_RPM;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+static uint32_t Test_Rand(void) {
+    test_rand = test_rand * 1103515245U + 12345U;
+    return test_rand >> 8;
+}
+
+/**
+ * @brief One event: the shaft moves, the update IRQ runs now or stays pending
+ */
+static void Test_Interrupt(int sig) {
+    (void)sig;
+    if (test_events >= TEST_INTERRUPTS) {
+        return;
+    }
+
+    // The IRQ is always taken before the counter travels another half period
+    if (__HAL_TIM_GET_FLAG(&test_htim, TIM_FLAG_UPDATE)) {
+        HAL_Sim_TIM_IRQ(&test_htim);
+    }
+
+    uint32_t step = 1U + Test_Rand() % TEST_MAX_STEP;
+    if ((test_events / TEST_FLIP_EVERY) % 2U == 0U) {
+        HAL_Sim_TIM_Advance(&test_htim, step);
+        test_truth += step;
+    } else {
+        HAL_Sim_TIM_Retreat(&test_htim, step);
+        test_truth -= step;
+    }
+    if (Test_Rand() & 1U) {
+        HAL_Sim_TIM_IRQ(&test_htim);
+    }
+
+    test_log[(test_events + 1U) % TEST_LOG_SIZE] = test_truth;
+    test_events = test_events + 1U;
+}
+
+static void Test_Setup(void) {
+    HAL_Sim_Reset();
+    memset(&test_htim, 0, sizeof(test_htim));
+    test_htim.Instance = TIM3;
+    Encoder_InitFull(&test_encoder, &test_htim, 1000, 0.1f, 100);
+
+    test_events = 0;
+    test_truth = 0;
+    test_log[0] = 0;
+    test_overflows = 0;
+}
+
+static void Test_SetTimer(long interval_us) {
+    struct itimerval timer = { { 0, interval_us }, { 0, interval_us } };
+    setitimer(ITIMER_REAL, &timer, NULL);
+}
+
+/**
+ * @brief Read continuously while the events preempt the reader
+ */
+static void Test_ReadUnderInterrupts(void) {
+    uint32_t reads = 0;
+    uint32_t torn = 0;
+
+    Test_Setup();
+    signal(SIGALRM, Test_Interrupt);
+    Test_SetTimer(20);
+
+    while (test_events < TEST_INTERRUPTS) {
+        uint32_t first = test_events;
+        int64_t position = Encoder_GetPulse(&test_encoder);
+        uint32_t last = test_events;
+
+        if (last - first >= TEST_LOG_SIZE - 1U) {
+            continue;  // Log already overwritten
+        }
+        // The read must match the true count at some instant during it
+        bool found = false;
+        for (uint32_t n = first; n <= last && !found; n++) {
+            found = (test_log[n % TEST_LOG_SIZE] == position);
+        }
+        if (!found) {
+            torn++;
+        }
+        reads++;
+    }
+    Test_SetTimer(0);
+    signal(SIGALRM, SIG_DFL);
+
+    CHECK(torn == 0U, "%u of %u reads matched no true position", (unsigned)torn, (unsigned)reads);
+    CHECK(reads > TEST_INTERRUPTS, "only %u reads", (unsigned)reads);
+    CHECK(test_overflows > TEST_INTERRUPTS / 8U, "only %u overflows", (unsigned)test_overflows);
+    CHECK(Encoder_GetPulse(&test_encoder) == test_truth, "final %lld, expected %lld",
+          (long long)Encoder_GetPulse(&test_encoder), (long long)test_truth);
+}
+
+/**
+ * @brief Wrap pending at the read, in both directions
+ */
+static void Test_PendingWrap(void) {
+    Test_Setup();
+    HAL_Sim_TIM_Advance(&test_htim, 65530U);
+    HAL_Sim_TIM_Advance(&test_htim, 10U);
+    CHECK(__HAL_TIM_GET_FLAG(&test_htim, TIM_FLAG_UPDATE), "UIF should be pending");
+    CHECK(Encoder_GetPulse(&test_encoder) == 65540, "forward: got %lld", (long long)Encoder_GetPulse(&test_encoder));
+    HAL_Sim_TIM_IRQ(&test_htim);
+    CHECK(Encoder_GetPulse(&test_encoder) == 65540, "forward serviced: got %lld",
+          (long long)Encoder_GetPulse(&test_encoder));
+
+    HAL_Sim_TIM_Retreat(&test_htim, 20U);
+    CHECK(__HAL_TIM_GET_FLAG(&test_htim, TIM_FLAG_UPDATE), "UIF should be pending");
+    CHECK(Encoder_GetPulse(&test_encoder) == 65520, "reverse: got %lld", (long long)Encoder_GetPulse(&test_encoder));
+    HAL_Sim_TIM_IRQ(&test_htim);
+    CHECK(Encoder_GetPulse(&test_encoder) == 65520, "reverse serviced: got %lld",
+          (long long)Encoder_GetPulse(&test_encoder));
+}
+
+/**
+ * @brief Reset zeroes the position without touching CNT or the ISR total
+ */
+static void Test_Reset(void) {
+    Test_Setup();
+    HAL_Sim_TIM_Advance(&test_htim, 100000U);
+    HAL_Sim_TIM_IRQ(&test_htim);
+    Encoder_Reset(&test_encoder);
+    CHECK(Encoder_GetPulse(&test_encoder) == 0, "after reset: got %lld", (long long)Encoder_GetPulse(&test_encoder));
+    for (uint32_t i = 0; i < 7U; i++) {
+        HAL_Sim_TIM_Retreat(&test_htim, 10000U);
+        HAL_Sim_TIM_IRQ(&test_htim);
+    }
+    CHECK(Encoder_GetPulse(&test_encoder) == -70000, "backwards: got %lld",
+          (long long)Encoder_GetPulse(&test_encoder));
+}
+
+/**
+ * @brief Wrap direction when DIR and the counter side disagree
+ */
+static void Test_DirectionCrossCheck(void) {
+    // Forward through the wrap, reversed before the ISR: DIR now reads down
+    Test_Setup();
+    HAL_Sim_TIM_Advance(&test_htim, 65530U);
+    (void)Encoder_GetPulse(&test_encoder);
+    HAL_Sim_TIM_Advance(&test_htim, 8U);
+    HAL_Sim_TIM_Retreat(&test_htim, 1U);
+    CHECK(__HAL_TIM_IS_TIM_COUNTING_DOWN(&test_htim), "DIR should read down");
+    CHECK(Encoder_GetPulse(&test_encoder) == 65537, "reversed, pending: got %lld",
+          (long long)Encoder_GetPulse(&test_encoder));
+    HAL_Sim_TIM_IRQ(&test_htim);
+    CHECK(Encoder_GetPulse(&test_encoder) == 65537, "reversed forward: got %lld",
+          (long long)Encoder_GetPulse(&test_encoder));
+    CHECK(test_encoder.dir_mismatches == 1U, "mismatches %lu", (unsigned long)test_encoder.dir_mismatches);
+
+    // Back through the wrap, reversed before the ISR: DIR now reads up
+    HAL_Sim_TIM_Retreat(&test_htim, 5U);
+    HAL_Sim_TIM_Advance(&test_htim, 2U);
+    HAL_Sim_TIM_IRQ(&test_htim);
+    CHECK(Encoder_GetPulse(&test_encoder) == 65534, "reversed backward: got %lld",
+          (long long)Encoder_GetPulse(&test_encoder));
+    CHECK(test_encoder.dir_mismatches == 2U, "mismatches %lu", (unsigned long)test_encoder.dir_mismatches);
+
+    // ISR late by more than half a wrap: DIR and the last read outvote the side
+    Test_Setup();
+    HAL_Sim_TIM_Advance(&test_htim, 65000U);
+    (void)Encoder_GetPulse(&test_encoder);
+    HAL_Sim_TIM_Advance(&test_htim, 40536U);
+    HAL_Sim_TIM_IRQ(&test_htim);
+    CHECK(Encoder_GetPulse(&test_encoder) == 105536, "late ISR: got %lld",
+          (long long)Encoder_GetPulse(&test_encoder));
+    CHECK(test_encoder.dir_mismatches == 1U, "mismatches %lu", (unsigned long)test_encoder.dir_mismatches);
+
+    // No agreement needed when nothing disagrees
+    Test_Setup();
+    for (uint32_t i = 0; i < 8U; i++) {
+        HAL_Sim_TIM_Advance(&test_htim, 30000U);
+        HAL_Sim_TIM_IRQ(&test_htim);
+    }
+    CHECK(Encoder_GetPulse(&test_encoder) == 240000, "forward run: got %lld",
+          (long long)Encoder_GetPulse(&test_encoder));
+    CHECK(test_encoder.dir_mismatches == 0U, "mismatches %lu", (unsigned long)test_encoder.dir_mismatches);
+}
+
+int main(void) {
+    Test_PendingWrap();
+    Test_Reset();
+    Test_DirectionCrossCheck();
+    Test_ReadUnderInterrupts();
+
+    if (test_failures) {
+        printf("%d failure(s)\n", test_failures);
+        return 1;
+    }
+    printf("encoder snapshot: all passed\n");
+    return 0;
+}
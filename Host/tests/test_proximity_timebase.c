@@ -0,0 +1,489 @@
+/**
+ ******************************************************************************
+ * @file    test_proximity_timebase.c
+ * @brief   Capture-at-wrap interleavings for the proximity counter timebase
+ * @date    October 2026
+ ******************************************************************************
+ * @attention
+ *
+ * Edges are swept across the TIM2 wrap point while the update interrupt is
+ * either serviced immediately or held pending until after the capture, so
+ * HAL_TIM_IRQHandler sees CC1 and UPDATE together in both orders. Every
+ * measured period must come out exact, in interrupt and in DMA mode. With
+ * auto-ranging the prescaler changes at wraps while the speed sweeps, and no
+ * period may be off by more than one counter tick, including a DMA-mode start
+ * at 5 RPM from the boot prescaler. In DMA mode a slow shaft,
+ * with the main loop polling between edges, must not lose its periods to the
+ * wrap bookkeeping. The default hysteresis chain keeps reporting whole RPM,
+ * and a missing-tooth wheel slowing through its gap must not read a fraction
+ * of its speed while the gap is still open. Direction sensing and pulse
+ * width must not take a channel another instance still owns.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include "hal_sim.h"
+#include "myEncoder/proximity_counter.h"
+
+/* Private define ------------------------------------------------------------*/
+#define TEST_PSC 72U   // Fixed division: periods are counter ticks * TEST_PSC clocks
+
+/* Private macro -------------------------------------------------------------*/
+#define CHECK(cond, ...)                                                   \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__);                    \
+            printf(__VA_ARGS__);                                           \
+            printf("\n");                                                  \
+            test_failures++;                                               \
+        }                                                                  \
+    } while (0)
+
+/* Private variables ---------------------------------------------------------*/
+static int test_failures;
+static TIM_HandleTypeDef test_htim;
+static DMA_HandleTypeDef test_hdma;
+static ProximityCounter_t test_counter;
+static ProximityDmaRing_t test_dma_ring;
+static ProximityCounter_t test_neighbour;   // Second instance on TIM2 CH2
+
+/* HAL callbacks -------------------------------------------------------------*/
+void HAL_TIM_IC_CaptureCallback(TIM_HandleTypeDef *htim) {
+    ProximityCounter_HandleCapture(&test_counter, htim);
+}
+
+void HAL_TIM_IC_CaptureHalfCpltCallback(TIM_HandleTypeDef *htim) {
+    ProximityCounter_HandleCaptureHalf(&test_counter, htim);
+}
+
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim) {
+    ProximityCounter_HandleOverflow(&test_counter, htim);
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+static void Test_SetupRange(ProximityCaptureMode_t mode, uint8_t auto_range) {
+    HAL_Sim_Reset();
+    memset(&test_htim, 0, sizeof(test_htim));
+    test_htim.Instance = TIM2;
+    test_htim.Init.Prescaler = TEST_PSC - 1U;
+    test_htim.Init.Period = 65535;
+    HAL_TIM_IC_Init(&test_htim);
+
+    memset(&test_hdma, 0, sizeof(test_hdma));
+    test_hdma.Instance = DMA1_Channel5;
+    test_hdma.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+    test_hdma.Init.Mode = DMA_CIRCULAR;
+    __HAL_LINKDMA(&test_htim, hdma[TIM_DMA_ID_CC1], test_hdma);
+
+    ProximityCounterConfig_t cfg = { .ppr = 1, .diameter = 0.1f, .timeout_ms = 100000,
+                                     .averaging_samples = 1, .capture_mode = mode, .dma_ring = &test_dma_ring,
+                                     .auto_range = auto_range };
+    ProximityCounter_Init(&test_counter, &cfg, &test_htim);
+    ProximityCounter_Start(&test_counter);
+}
+
+static void Test_Setup(ProximityCaptureMode_t mode) {
+    Test_SetupRange(mode, 0);
+}
+
+/**
+ * @brief Run the counter by some ticks, servicing each wrap unless held
+ * @retval true if a wrap is left pending
+ */
+static bool Test_Advance(uint32_t ticks, bool hold_last_wrap) {
+    bool pending = false;
+    while (ticks > 0U) {
+        uint32_t step = (ticks > 30000U) ? 30000U : ticks;
+        ticks -= step;
+        if (HAL_Sim_TIM_Advance(&test_htim, step)) {
+            if (ticks == 0U && hold_last_wrap) {
+                pending = true;
+            } else {
+                HAL_Sim_TIM_IRQ(&test_htim);
+            }
+        }
+    }
+    return pending;
+}
+
+/**
+ * @brief Drive edges with a fixed period and check every measured period
+ * @param period: Ticks between edges
+ * @param first_edge: Tick of the first edge
+ * @param latency: Ticks the ISR is held off after each edge (wraps stay pending)
+ * @param hold_wrap: Leave a wrap just before the edge pending as well
+ */
+static void Test_Sweep(ProximityCaptureMode_t mode, uint32_t period, uint32_t first_edge,
+                       uint32_t latency, bool hold_wrap, uint32_t edges) {
+    Test_Setup(mode);
+    Test_Advance(first_edge, hold_wrap);
+
+    uint32_t checked = 0;
+    for (uint32_t k = 0; k < edges; k++) {
+        HAL_Sim_TIM_Capture(&test_htim, TIM_CHANNEL_1);
+        Test_Advance(latency, true);
+        HAL_Sim_TIM_IRQ(&test_htim);
+        HAL_Sim_DMA_IRQ(&test_hdma);
+        ProximityCounter_ProcessCapture(&test_counter);
+
+        if (k > 0) {
+            CHECK(test_counter.difference == period * TEST_PSC,
+                  "mode %d period %u latency %u hold %d edge %u: got %u",
+                  (int)mode, (unsigned)period, (unsigned)latency, (int)hold_wrap,
+                  (unsigned)k, (unsigned)(test_counter.difference / TEST_PSC));
+            checked++;
+        }
+        Test_Advance(period - latency, hold_wrap);
+    }
+    CHECK(checked == edges - 1U, "only %u periods checked", (unsigned)checked);
+}
+
+/* Tests ---------------------------------------------------------------------*/
+
+static void Test_WrapPendingBeforeCapture(void) {
+    // Wrap then edge 3 ticks later, both seen by one IRQ: CC1 is serviced first
+    Test_Setup(PROXIMITY_CAPTURE_MODE_IT);
+    Test_Advance(65000, false);
+    HAL_Sim_TIM_Capture(&test_htim, TIM_CHANNEL_1);
+    HAL_Sim_TIM_IRQ(&test_htim);
+
+    Test_Advance(539, true);                  // CNT 65539 -> wraps to 3, UIF pending
+    CHECK(__HAL_TIM_GET_FLAG(&test_htim, TIM_FLAG_UPDATE), "UIF should be pending");
+    HAL_Sim_TIM_Capture(&test_htim, TIM_CHANNEL_1);
+    HAL_Sim_TIM_IRQ(&test_htim);
+    CHECK(test_counter.difference == 539U * TEST_PSC, "got %u", (unsigned)test_counter.difference);
+
+    // Next period must not inherit the wrap a second time
+    Test_Advance(1000, false);
+    HAL_Sim_TIM_Capture(&test_htim, TIM_CHANNEL_1);
+    HAL_Sim_TIM_IRQ(&test_htim);
+    CHECK(test_counter.difference == 1000U * TEST_PSC, "got %u", (unsigned)test_counter.difference);
+}
+
+static void Test_CaptureBeforePendingWrap(void) {
+    // Edge at 0xFFFE, wrap 2 ticks later, ISR sees both
+    Test_Setup(PROXIMITY_CAPTURE_MODE_IT);
+    Test_Advance(60000, false);
+    HAL_Sim_TIM_Capture(&test_htim, TIM_CHANNEL_1);
+    HAL_Sim_TIM_IRQ(&test_htim);
+
+    Test_Advance(5534, false);                // CNT 65534
+    HAL_Sim_TIM_Capture(&test_htim, TIM_CHANNEL_1);
+    Test_Advance(4, true);
+    HAL_Sim_TIM_IRQ(&test_htim);
+    CHECK(test_counter.difference == 5534U * TEST_PSC, "got %u", (unsigned)test_counter.difference);
+
+    Test_Advance(2000 - 4, false);
+    HAL_Sim_TIM_Capture(&test_htim, TIM_CHANNEL_1);
+    HAL_Sim_TIM_IRQ(&test_htim);
+    CHECK(test_counter.difference == 2000U * TEST_PSC, "got %u", (unsigned)test_counter.difference);
+}
+
+static void Test_CaptureExactlyAtWrap(void) {
+    Test_Setup(PROXIMITY_CAPTURE_MODE_IT);
+    Test_Advance(65535, false);               // CNT 0xFFFF
+    HAL_Sim_TIM_Capture(&test_htim, TIM_CHANNEL_1);
+    HAL_Sim_TIM_IRQ(&test_htim);
+
+    Test_Advance(1, true);                    // CNT 0, UIF pending
+    HAL_Sim_TIM_Capture(&test_htim, TIM_CHANNEL_1);
+    HAL_Sim_TIM_IRQ(&test_htim);
+    CHECK(test_counter.difference == TEST_PSC, "got %u", (unsigned)test_counter.difference);
+}
+
+static void Test_LowRpmMultipleWraps(void) {
+    // 3.2 s per revolution: 48 wraps per period, last one pending at the edge
+    Test_Sweep(PROXIMITY_CAPTURE_MODE_IT, 3200000U, 100U, 0U, true, 6U);
+    Test_Sweep(PROXIMITY_CAPTURE_MODE_IT, 3200000U, 100U, 20U, false, 6U);
+}
+
+/**
+ * @brief Run the counter by some ticks with the main loop polling every 10 ms
+ */
+static void Test_AdvancePolling(uint32_t ticks) {
+    while (ticks > 0U) {
+        uint32_t step = (ticks > 10000U) ? 10000U : ticks;
+        ticks -= step;
+        if (HAL_Sim_TIM_Advance(&test_htim, step)) {
+            HAL_Sim_TIM_IRQ(&test_htim);
+        }
+        ProximityCounter_ProcessCapture(&test_counter);
+    }
+}
+
+static void Test_DmaSlowShaft(void) {
+    // 3 s and 12 s per revolution: 45 and 183 wraps between edges, more than the mark ring holds
+    static const uint32_t periods[] = { 3000000U, 12000000U };
+
+    for (size_t p = 0; p < sizeof(periods) / sizeof(periods[0]); p++) {
+        Test_Setup(PROXIMITY_CAPTURE_MODE_DMA);
+        Test_AdvancePolling(1234U);
+        for (uint32_t k = 0; k < 5U; k++) {
+            HAL_Sim_TIM_Capture(&test_htim, TIM_CHANNEL_1);
+            HAL_Sim_DMA_IRQ(&test_hdma);
+            ProximityCounter_ProcessCapture(&test_counter);
+            if (k > 0) {
+                CHECK(test_counter.difference == periods[p] * TEST_PSC, "period %u edge %u: got %u",
+                      (unsigned)periods[p], (unsigned)k, (unsigned)(test_counter.difference / TEST_PSC));
+            }
+            Test_AdvancePolling(periods[p]);
+        }
+        // 5 RPM from standstill stays inside the default hysteresis band; the period says it all
+        float expected = 60000000.0f / (float)periods[p];
+        float rpm = ProximityCounter_GetRPM(&test_counter);
+        CHECK(expected < 10.0f || (rpm > expected * 0.99f && rpm < expected * 1.01f),
+              "period %u: %.2f RPM, expected %.2f", (unsigned)periods[p], (double)rpm, (double)expected);
+        CHECK(test_counter.dma_overruns == 0U, "period %u: %u overruns", (unsigned)periods[p],
+              (unsigned)test_counter.dma_overruns);
+    }
+
+    // Standstill: wraps keep coming, nothing is lost
+    Test_Setup(PROXIMITY_CAPTURE_MODE_DMA);
+    Test_AdvancePolling(60000000U);
+    CHECK(test_counter.dma_overruns == 0U, "standstill: %u overruns", (unsigned)test_counter.dma_overruns);
+}
+
+static void Test_SweepAcrossWrap(void) {
+    static const uint32_t periods[] = { 65536U + 7U, 65536U - 5U, 131072U + 3U, 500U, 40000U };
+    static const uint32_t latencies[] = { 0U, 1U, 5U, 37U, 1000U };
+
+    for (int mode = PROXIMITY_CAPTURE_MODE_IT; mode <= PROXIMITY_CAPTURE_MODE_DMA; mode++) {
+        for (size_t p = 0; p < sizeof(periods) / sizeof(periods[0]); p++) {
+            for (size_t l = 0; l < sizeof(latencies) / sizeof(latencies[0]); l++) {
+                if (latencies[l] >= periods[p]) {
+                    continue;
+                }
+                for (int hold = 0; hold <= 1; hold++) {
+                    // First edge a little before a wrap so the drift walks across it
+                    Test_Sweep((ProximityCaptureMode_t)mode, periods[p], 65536U - 300U,
+                               latencies[l], hold != 0, 120U);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Run the timer by some clock cycles, servicing each wrap unless held
+ * @note Chunks stay below one wrap at the smaller of the running and the
+ *       preloaded division, so no update is missed.
+ */
+static void Test_AdvanceClocks(uint32_t clocks, bool hold_last_wrap) {
+    while (clocks > 0U) {
+        uint32_t psc = test_htim.Instance->PSC + 1U;
+        uint32_t active = ProximityCounter_GetPrescaler(&test_counter);
+        uint32_t chunk = 30000U * ((active < psc) ? active : psc);
+        uint32_t step = (clocks > chunk) ? chunk : clocks;
+        clocks -= step;
+        if (HAL_Sim_TIM_AdvanceClocks(&test_htim, step) && !(clocks == 0U && hold_last_wrap)) {
+            HAL_Sim_TIM_IRQ(&test_htim);
+        }
+    }
+}
+
+static void Test_AutoRangeSweep(void) {
+    // 10000 RPM down to 5 RPM and back at one pulse per revolution
+    for (int mode = PROXIMITY_CAPTURE_MODE_IT; mode <= PROXIMITY_CAPTURE_MODE_DMA; mode++) {
+        Test_SetupRange((ProximityCaptureMode_t)mode, 1);
+        Test_AdvanceClocks(1234567U, false);
+
+        uint32_t period = PROXIMITY_TIMCLOCK / (10000U / 60U);
+        uint32_t switches = 0;
+        uint32_t seen_psc = ProximityCounter_GetPrescaler(&test_counter);
+        uint32_t prev_edge_psc = seen_psc;
+        uint32_t max_psc = seen_psc;
+        for (uint32_t k = 0; k < 400U; k++) {
+            uint32_t edge_psc = (__HAL_TIM_GET_FLAG(&test_htim, TIM_FLAG_UPDATE))
+                                ? test_htim.Instance->PSC + 1U
+                                : ProximityCounter_GetPrescaler(&test_counter);
+            HAL_Sim_TIM_Capture(&test_htim, TIM_CHANNEL_1);
+            HAL_Sim_TIM_IRQ(&test_htim);
+            HAL_Sim_DMA_IRQ(&test_hdma);
+            ProximityCounter_ProcessCapture(&test_counter);
+
+            // Each edge is quantised to one counter tick of the division it hit
+            if (k > 0) {
+                uint32_t tolerance = (edge_psc > prev_edge_psc) ? edge_psc : prev_edge_psc;
+                uint32_t diff = test_counter.difference;
+                uint32_t error = (diff > period) ? diff - period : period - diff;
+                CHECK(error < tolerance, "mode %d edge %u period %u psc %u: got %u",
+                      mode, (unsigned)k, (unsigned)period, (unsigned)edge_psc, (unsigned)diff);
+            }
+            prev_edge_psc = edge_psc;
+            if (edge_psc != seen_psc) {
+                switches++;
+                seen_psc = edge_psc;
+            }
+            max_psc = (edge_psc > max_psc) ? edge_psc : max_psc;
+
+            // Decelerate for 200 edges, then accelerate back; every other
+            // edge finds a wrap from its last stretch still pending
+            period = (k < 200U) ? period + period / 26U : period - period / 27U;
+            Test_AdvanceClocks(period, (k & 1U) != 0U);
+        }
+        CHECK(switches >= 10U, "mode %d: only %u range switches", mode, (unsigned)switches);
+        CHECK(max_psc >= 8192U, "mode %d: never reached a slow range (%u)", mode, (unsigned)max_psc);
+    }
+}
+
+static void Test_AutoRangeDmaSlowStart(void) {
+    // 5 RPM at one pulse per revolution from the boot prescaler: the first
+    // period spans 183 wraps and has to bring the range up on its own
+    const uint32_t period = PROXIMITY_TIMCLOCK * 12U;
+    Test_SetupRange(PROXIMITY_CAPTURE_MODE_DMA, 1);
+    ProximityCounter_SetFilterChain(&test_counter, RPM_FILTER_CHAIN_NONE);
+    Test_AdvanceClocks(1234567U, false);
+
+    for (uint32_t k = 0; k < 6U; k++) {
+        uint32_t edge_psc = ProximityCounter_GetPrescaler(&test_counter);
+        HAL_Sim_TIM_Capture(&test_htim, TIM_CHANNEL_1);
+        HAL_Sim_DMA_IRQ(&test_hdma);
+        ProximityCounter_ProcessCapture(&test_counter);
+        if (k > 0) {
+            uint32_t diff = test_counter.difference;
+            uint32_t error = (diff > period) ? diff - period : period - diff;
+            CHECK(error < edge_psc, "edge %u psc %u: got %u", (unsigned)k, (unsigned)edge_psc, (unsigned)diff);
+        }
+
+        // Main loop polling every 10 ms while the shaft turns
+        for (uint32_t t = 0; t < 1200U; t++) {
+            Test_AdvanceClocks(PROXIMITY_TIMCLOCK / 100U, false);
+            ProximityCounter_ProcessCapture(&test_counter);
+        }
+    }
+    float rpm = ProximityCounter_GetRPM(&test_counter);
+    CHECK(rpm > 4.99f && rpm < 5.01f, "got %.3f RPM, expected 5", (double)rpm);
+    CHECK(ProximityCounter_GetPrescaler(&test_counter) >= 8192U, "range stuck at %u",
+          (unsigned)ProximityCounter_GetPrescaler(&test_counter));
+    CHECK(test_counter.dma_overruns == 0U, "%u overruns", (unsigned)test_counter.dma_overruns);
+}
+
+static void Test_LegacyChainWholeRpm(void) {
+    // 7001 us per turn = 8570.2 RPM; the default hysteresis chain reports 8570
+    Test_Setup(PROXIMITY_CAPTURE_MODE_IT);
+    for (uint32_t k = 0; k < 20; k++) {
+        HAL_Sim_TIM_Capture(&test_htim, TIM_CHANNEL_1);
+        HAL_Sim_TIM_IRQ(&test_htim);
+        ProximityCounter_ProcessCapture(&test_counter);
+        if (k > 0) {
+            float rpm = ProximityCounter_GetRPM(&test_counter);
+            CHECK(rpm == 8570.0f, "edge %u: got %.3f RPM, expected 8570", (unsigned)k, (double)rpm);
+        }
+        Test_Advance(7001, false);
+    }
+}
+
+/**
+ * @brief Run timer and timebase together (one tick = 1 us), checking the timeout every 100 us
+ * @retval Lowest RPM reported meanwhile
+ */
+static float Test_AdvanceChecking(uint32_t ticks) {
+    float lowest = ProximityCounter_GetRPM(&test_counter);
+    while (ticks > 0U) {
+        uint32_t step = (ticks > 100U) ? 100U : ticks;
+        ticks -= step;
+        HAL_Sim_AdvanceMicros(step);
+        if (HAL_Sim_TIM_Advance(&test_htim, step)) {
+            HAL_Sim_TIM_IRQ(&test_htim);
+        }
+        ProximityCounter_CheckTimeout(&test_counter);
+        float rpm = ProximityCounter_GetRPM(&test_counter);
+        lowest = (rpm < lowest) ? rpm : lowest;
+    }
+    return lowest;
+}
+
+static void Test_GapWheelSlowdown(void) {
+    // 12-2 wheel at 1 ms per pitch (5000 RPM); the last gap is 10% slow
+    Test_Setup(PROXIMITY_CAPTURE_MODE_IT);
+    ProximityCounter_SetPPR(&test_counter, 12U);
+    CHECK(ProximityCounter_SetMissingTeeth(&test_counter, 2U), "12-2 wheel refused");
+    ProximityCounter_SetFilterChain(&test_counter, RPM_FILTER_CHAIN_NONE);
+
+    float lowest = 0.0f;
+    for (uint32_t rev = 0; rev < 5U; rev++) {
+        for (uint32_t t = 0; t < 10U; t++) {
+            HAL_Sim_TIM_Capture(&test_htim, TIM_CHANNEL_1);
+            HAL_Sim_TIM_IRQ(&test_htim);
+            ProximityCounter_ProcessCapture(&test_counter);
+            if (t < 9U) {
+                float rpm = Test_AdvanceChecking(1000U);
+                CHECK(rev == 0U || rpm > 4999.0f, "rev %u tooth %u: %.1f RPM", (unsigned)rev, (unsigned)t,
+                      (double)rpm);
+            } else if (rev < 4U) {
+                Test_AdvanceChecking(3000U);
+            } else {
+                CHECK(ProximityCounter_GetSyncState(&test_counter) == PROXIMITY_SYNC_SYNCED, "not synced");
+                lowest = Test_AdvanceChecking(3300U);
+            }
+        }
+    }
+    // Slowing by 10% may decay the speed by as much, not to a third
+    CHECK(lowest > 4500.0f, "gap slowdown: %.1f RPM, expected >= 4545", (double)lowest);
+}
+
+static void Test_ChannelOwnership(void) {
+    Test_Setup(PROXIMITY_CAPTURE_MODE_IT);
+    ProximityCounterConfig_t cfg = { .ppr = 1, .diameter = 0.1f, .timeout_ms = 100000,
+                                     .averaging_samples = 1, .channel = TIM_CHANNEL_2 };
+    ProximityCounter_Init(&test_neighbour, &cfg, &test_htim);
+    ProximityCounter_Start(&test_neighbour);
+
+    CHECK(!ProximityCounter_SetDirectionSensor(&test_counter, true, TIM_CHANNEL_2),
+          "direction sensor took CH2 from a running instance");
+    uint32_t ccmr1 = test_htim.Instance->CCMR1;
+    CHECK(!ProximityCounter_SetPulseWidth(&test_counter, true, false),
+          "pulse width took CH2 from a running instance");
+    CHECK(test_neighbour.running && !test_counter.direction_sensing && !test_counter.pulse_width,
+          "CH2 instance disturbed");
+    CHECK(test_htim.Instance->CCMR1 == ccmr1, "CH2 input reconfigured");
+
+    ProximityCounter_DeInit(&test_neighbour);
+    CHECK(!test_neighbour.running, "CH2 instance still running");
+    CHECK(ProximityCounter_SetDirectionSensor(&test_counter, true, TIM_CHANNEL_2), "released CH2 refused");
+    CHECK(ProximityCounter_SetDirectionSensor(&test_counter, false, TIM_CHANNEL_2), "direction sensor stuck");
+    CHECK(ProximityCounter_SetPulseWidth(&test_counter, true, false), "released CH2 refused for pulse width");
+    CHECK(ProximityCounter_SetPulseWidth(&test_counter, false, false), "pulse width stuck");
+}
+
+static void Test_TimestampMonotonic(void) {
+    Test_Setup(PROXIMITY_CAPTURE_MODE_IT);
+    uint64_t previous = ProximityCounter_GetTimestamp(&test_counter);
+    for (uint32_t i = 0; i < 5000; i++) {
+        bool pending = Test_Advance(97, true);
+        uint64_t now = ProximityCounter_GetTimestamp(&test_counter);
+        CHECK(now - previous == 97U * TEST_PSC, "step %u: %llu -> %llu", (unsigned)i,
+              (unsigned long long)previous, (unsigned long long)now);
+        previous = now;
+        if (pending) {
+            HAL_Sim_TIM_IRQ(&test_htim);
+            CHECK(ProximityCounter_GetTimestamp(&test_counter) == now, "service changed time");
+        }
+    }
+}
+
+int main(void) {
+    Test_WrapPendingBeforeCapture();
+    Test_CaptureBeforePendingWrap();
+    Test_CaptureExactlyAtWrap();
+    Test_LowRpmMultipleWraps();
+    Test_SweepAcrossWrap();
+    Test_DmaSlowShaft();
+    Test_LegacyChainWholeRpm();
+    Test_GapWheelSlowdown();
+    Test_TimestampMonotonic();
+    Test_AutoRangeSweep();
+    Test_AutoRangeDmaSlowStart();
+    Test_ChannelOwnership();
+
+    if (test_failures) {
+        printf("%d check(s) failed\n", test_failures);
+        return 1;
+    }
+    printf("test_proximity_timebase: all checks passed\n");
+    return 0;
+}
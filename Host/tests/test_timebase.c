@@ -0,0 +1,219 @@
+/**
+ ******************************************************************************
+ * @file    test_timebase.c
+ * @brief   64-bit extension and resolution of the shared DWT timebase
+ * @date    October 2026
+ ******************************************************************************
+ * @attention
+ *
+ * The 32-bit CYCCNT wraps every ~59.6 s at 72 MHz and the HAL tick every
+ * ~49.7 days. Time is stepped past both without the SysTick hook where the
+ * readers must not need it, and every reading must equal the simulated time
+ * to the microsecond. The encoder RPM window is checked at a length the
+ * millisecond tick could not resolve, and at crawl speed, where the window
+ * holds a few counts, against the edge-timed (1/T) estimate.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include "hal_sim.h"
+#include "timebase/timebase.h"
+#include "myEncoder/myEncoder.h"
+
+/* Private macro -------------------------------------------------------------*/
+#define CHECK(cond, ...)                                                   \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__);                    \
+            printf(__VA_ARGS__);                                           \
+            printf("\n");                                                  \
+            test_failures++;                                               \
+        }                                                                  \
+    } while (0)
+
+/* Private variables ---------------------------------------------------------*/
+static int test_failures;
+static EncoderRegistry_t test_registry;
+
+/* HAL callbacks -------------------------------------------------------------*/
+void HAL_TIM_IC_CaptureCallback(TIM_HandleTypeDef *htim) {
+    EncoderRegistry_HandleCapture(&test_registry, htim);
+}
+
+SpeedDisplayUnit_t CommandHandler_GetSpeedDisplayUnit(void) {
+    return SPEED_UNIT_RPM;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief Sub-millisecond steps come out exact across tick boundaries
+ */
+static void Test_Resolution(void) {
+    HAL_Sim_Reset();
+    Timebase_Init();
+
+    uint64_t expected = 0;
+    for (uint32_t i = 0; i < 1000U; i++) {
+        HAL_Sim_AdvanceMicros(37U);
+        expected += 37U;
+        CHECK(Timebase_GetMicros() == expected, "step %u: %llu, expected %llu", (unsigned)i,
+              (unsigned long long)Timebase_GetMicros(), (unsigned long long)expected);
+    }
+    CHECK(Timebase_GetCycles() == expected * 72U, "cycles %llu", (unsigned long long)Timebase_GetCycles());
+}
+
+/**
+ * @brief Many CYCCNT wraps between reads, no SysTick hook
+ */
+static void Test_CycleCounterWrap(void) {
+    HAL_Sim_Reset();
+    HAL_Sim_AdvanceMicros(250U);
+    Timebase_Init();
+
+    uint64_t expected = 0;
+    for (uint32_t i = 0; i < 130U; i++) {
+        HAL_Sim_AdvanceTick(60000U);
+        HAL_Sim_AdvanceMicros(123U);
+        expected += 60000123U;
+        CHECK(Timebase_GetMicros() == expected, "minute %u: %llu, expected %llu", (unsigned)i,
+              (unsigned long long)Timebase_GetMicros(), (unsigned long long)expected);
+    }
+}
+
+/**
+ * @brief HAL tick wrap, with the hook late by up to half a tick period
+ */
+static void Test_TickWrap(void) {
+    HAL_Sim_Reset();
+    HAL_Sim_SetTick(0x7FFFF000U);
+    Timebase_Init();
+
+    // Past bit 31 of the tick, hook not run yet
+    HAL_Sim_AdvanceTick(0x2000U);
+    CHECK(Timebase_GetMicros() == 0x2000ULL * 1000U, "half wrap: %llu", (unsigned long long)Timebase_GetMicros());
+    Timebase_Tick();
+
+    // Through the wrap in 12 h steps, hook once per step
+    uint64_t expected_ms = 0x2000U;
+    for (uint32_t i = 0; i < 100U; i++) {
+        HAL_Sim_AdvanceTick(43200000U);
+        expected_ms += 43200000U;
+        CHECK(Timebase_GetMicros() == expected_ms * 1000U, "step %u: %llu, expected %llu", (unsigned)i,
+              (unsigned long long)Timebase_GetMicros(), (unsigned long long)(expected_ms * 1000U));
+        Timebase_Tick();
+    }
+}
+
+/**
+ * @brief A 2.5 ms RPM window is measured as 2.5 ms
+ */
+static void Test_EncoderShortWindow(void) {
+    TIM_HandleTypeDef htim;
+    Encoder_t enc;
+
+    HAL_Sim_Reset();
+    memset(&htim, 0, sizeof(htim));
+    htim.Instance = TIM3;
+    Encoder_InitFull(&enc, &htim, 1000, 0.1f, 2);
+
+    // 250 counts of 4000 per revolution in 2.5 ms = 1500 RPM
+    HAL_Sim_AdvanceMicros(2500U);
+    HAL_Sim_TIM_Advance(&htim, 250U);
+    float rpm = Encoder_GetRPM(&enc);
+    CHECK(rpm > 451.17f && rpm < 451.18f, "first window: %.4f RPM (77/256 x 1500 expected)", (double)rpm);
+
+    // Below update_ms: cached value
+    HAL_Sim_AdvanceMicros(1999U);
+    HAL_Sim_TIM_Advance(&htim, 100U);
+    CHECK(Encoder_GetRPM(&enc) == rpm, "window not closed yet");
+
+    // Unfiltered chain: the next 2.5 ms window reads 1500 RPM as is
+    CHECK(Encoder_SetFilterChain(&enc, RPM_FILTER_CHAIN_NONE), "chain not accepted");
+    HAL_Sim_AdvanceMicros(501U);
+    HAL_Sim_TIM_Advance(&htim, 150U);
+    rpm = Encoder_GetRPM(&enc);
+    CHECK(rpm > 1499.99f && rpm < 1500.01f, "no filter: %.4f RPM, expected 1500", (double)rpm);
+}
+
+/**
+ * @brief Crawl at a constant speed for a time, one GetRPM per millisecond
+ * @param count_ms: Milliseconds per encoder count
+ * @param lo, hi: Receive the RPM range over the last second
+ */
+static void Test_Crawl(TIM_HandleTypeDef *htim, Encoder_t *enc, uint32_t count_ms, uint32_t duration_ms,
+                       float *lo, float *hi) {
+    static uint32_t count;
+    *lo = 1e9f;
+    *hi = -1e9f;
+    for (uint32_t t = 1; t <= duration_ms; t++) {
+        HAL_Sim_AdvanceTick(1U);
+        if (count_ms && t % count_ms == 0U) {
+            HAL_Sim_TIM_Advance(htim, 1U);
+            if (++count % 4U == 0U) {
+                // Rising edge of A once per quadrature cycle
+                HAL_Sim_TIM_Capture(htim, TIM_CHANNEL_1);
+                HAL_Sim_TIM_IRQ(htim);
+            }
+        }
+        float rpm = Encoder_GetRPM(enc);
+        if (t + 1000U > duration_ms) {
+            *lo = (rpm < *lo) ? rpm : *lo;
+            *hi = (rpm > *hi) ? rpm : *hi;
+        }
+    }
+}
+
+/**
+ * @brief 1/T below the count threshold, window above it, zero at standstill
+ */
+static void Test_EncoderLowSpeed(void) {
+    TIM_HandleTypeDef htim;
+    Encoder_t enc;
+    float lo, hi;
+
+    // 1000 PPR x4, 100 ms window, one count per 30 ms = 0.5 RPM, 3..4 counts per window
+    HAL_Sim_Reset();
+    memset(&htim, 0, sizeof(htim));
+    htim.Instance = TIM3;
+    Encoder_InitFull(&enc, &htim, 1000, 0.1f, 100);
+    EncoderRegistry_Init(&test_registry);
+    EncoderRegistry_Add(&test_registry, &enc);
+
+    Test_Crawl(&htim, &enc, 30U, 4000U, &lo, &hi);
+    CHECK(hi - lo > 0.02f, "window only should be quantized: %.4f..%.4f", (double)lo, (double)hi);
+
+    Encoder_SetLowSpeed(&enc, ENCODER_LOWSPEED_DEFAULT);
+    Test_Crawl(&htim, &enc, 30U, 4000U, &lo, &hi);
+    CHECK(enc.edge_irq, "edge interrupt should be on");
+    CHECK(lo > 0.495f && hi < 0.505f, "1/T: %.4f..%.4f RPM, expected 0.5", (double)lo, (double)hi);
+
+    // One count per ms (15 RPM): 100 counts per window, the edges stop interrupting
+    Test_Crawl(&htim, &enc, 1U, 4000U, &lo, &hi);
+    CHECK(!enc.edge_irq, "edge interrupt should be off above the threshold");
+    CHECK(lo > 14.9f && hi < 15.1f, "window: %.4f..%.4f RPM, expected 15", (double)lo, (double)hi);
+
+    // Back to a crawl, then stop
+    Test_Crawl(&htim, &enc, 30U, 4000U, &lo, &hi);
+    CHECK(lo > 0.495f && hi < 0.505f, "1/T again: %.4f..%.4f RPM", (double)lo, (double)hi);
+    Test_Crawl(&htim, &enc, 0U, 5000U, &lo, &hi);
+    CHECK(hi < 0.001f, "standstill: %.4f RPM", (double)hi);
+}
+
+int main(void) {
+    Test_Resolution();
+    Test_CycleCounterWrap();
+    Test_EncoderShortWindow();
+    Test_EncoderLowSpeed();
+    Test_TickWrap();
+
+    if (test_failures) {
+        printf("%d failure(s)\n", test_failures);
+        return 1;
+    }
+    printf("timebase: all passed\n");
+    return 0;
+}